@@ -68,6 +68,7 @@ public final class UMLRTRuntime {
 	private static final ExternalHeaderFile umlrtobjectclassgeneric_hh = new ExternalHeaderFile("umlrtobjectclassgeneric.hh");
 	private static final ExternalHeaderFile umlrtoutsignal_hh = new ExternalHeaderFile("umlrtoutsignal.hh");
 	private static final ExternalHeaderFile umlrtprotocol_hh = new ExternalHeaderFile("umlrtprotocol.hh");
+	private static final ExternalHeaderFile umlrtproxycapsule_hh = new ExternalHeaderFile("umlrtproxycapsule.hh");
 	private static final ExternalHeaderFile umlrtrtsinterface_hh = new ExternalHeaderFile("umlrtrtsinterface.hh");
 	private static final ExternalHeaderFile umlrtsignal_hh = new ExternalHeaderFile("umlrtsignal.hh");
 	private static final ExternalHeaderFile umlrtslot_hh = new ExternalHeaderFile("umlrtslot.hh");
@@ -434,6 +435,23 @@ public final class UMLRTRuntime {
 		}
 	}
 
+	public static class UMLRTProxyCapsule {
+		public static final ExternalElement Element = new ExternalFwdDeclarable(umlrtproxycapsule_hh, "UMLRTProxyCapsule", "class UMLRTProxyCapsule");
+
+		public static Type getType() {
+			return Element.getType();
+		}
+
+		public static final ExternalConstructorCall Ctor(Expression capsuleClass, Expression slot, Expression borderPorts, Expression internalPorts) {
+			ExternalConstructorCall call = new ExternalConstructorCall(Element);
+			call.addArgument(capsuleClass);
+			call.addArgument(slot);
+			call.addArgument(borderPorts);
+			call.addArgument(internalPorts);
+			return call;
+		}
+	}
+
 	public static class UMLRTRtsInterface {
 		public static final ExternalElement Element = new ExternalFwdDeclarable(umlrtrtsinterface_hh, "UMLRTRtsInterface", "class UMLRTRtsInterface");
 
@@ -827,6 +845,7 @@ public final class UMLRTRuntime {
 		public static final MemberField capsule = new MemberField(UMLRTCapsule.getType().ptr().const_(), "capsule");
 		public static final MemberField parts = new MemberField(UMLRTCapsulePart.getType().ptr(), "parts");
 		public static final MemberField ports = new MemberField(UMLRTCommsPort.getType().ptr(), "ports");
+		public static final MemberField remote = new MemberField(PrimitiveType.BOOL, "remote");
 	}
 
 	public static class UMLRTTimerId {
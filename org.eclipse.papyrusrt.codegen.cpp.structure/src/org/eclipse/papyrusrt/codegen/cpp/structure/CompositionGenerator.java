@@ -501,7 +501,7 @@ public final class CompositionGenerator extends AbstractElementGenerator {
 			portInit.addExpression(farEndCount <= 0 ? StandardLibrary.NULL() : farEndAccess);
 
 			// TODO some fields need the actual values
-			portInit.addExpression(StandardLibrary.NULL()); // mutable UMLRTMessageQueue * deferQueue; // Deferred messages on this port.
+			portInit.addExpression(StandardLibrary.NULL()); // mutable UMLRTDeferQueue * deferQueue; // Deferred messages on this port.
 			portInit.addExpression(StandardLibrary.NULL()); // mutable char * registeredName;
 			portInit.addExpression(new StringLiteral(XTUMLRTUtil.getRegistrationOverride(port.getType()))); // mutable char * registrationOverride;
 			portInit.addExpression(BooleanLiteral.from(XTUMLRTUtil.isAutomatic(port.getType())));
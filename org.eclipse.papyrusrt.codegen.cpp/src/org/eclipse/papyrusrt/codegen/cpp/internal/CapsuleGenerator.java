@@ -48,6 +48,7 @@ import org.eclipse.papyrusrt.codegen.lang.cpp.expr.MemberAccess;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.MemberFunctionCall;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.NewExpr;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.StringLiteral;
+import org.eclipse.papyrusrt.codegen.lang.cpp.external.ExternalConstructorCall;
 import org.eclipse.papyrusrt.codegen.lang.cpp.external.StandardLibrary;
 import org.eclipse.papyrusrt.codegen.lang.cpp.stmt.CodeBlock;
 import org.eclipse.papyrusrt.codegen.lang.cpp.stmt.ConditionalStatement;
@@ -676,11 +677,26 @@ public class CapsuleGenerator extends SerializableClassGenerator {
 		// create produces only static instances
 		ctorCall.addArgument(BooleanLiteral.TRUE());
 
-		create.add(
+		// A slot deployed on another host only gets a proxy holding its (connected) ports.
+		ExternalConstructorCall proxyCtorCall = UMLRTRuntime.UMLRTProxyCapsule.Ctor(
+				new AddressOfExpr(
+						new ElementAccess(cpp.getVariable(CppCodePattern.Output.UMLRTCapsuleClass, capsule))),
+				new ElementAccess(slot),
+				borderPortsPtr == null ? StandardLibrary.NULL() : new ElementAccess(borderPortsPtr),
+				internalPorts == null ? StandardLibrary.NULL() : new ElementAccess(internalPorts));
+
+		ConditionalStatement isRemoteCond = new ConditionalStatement();
+		isRemoteCond.add(new MemberAccess(new ElementAccess(slot), UMLRTRuntime.UMLRTSlot.remote)).add(
+				new BinaryOperation(
+						new MemberAccess(new ElementAccess(slot), UMLRTRuntime.UMLRTSlot.capsule),
+						BinaryOperation.Operator.ASSIGN,
+						new NewExpr(proxyCtorCall)));
+		isRemoteCond.defaultBlock().add(
 				new BinaryOperation(
 						new MemberAccess(new ElementAccess(slot), UMLRTRuntime.UMLRTSlot.capsule),
 						BinaryOperation.Operator.ASSIGN,
 						new NewExpr(ctorCall)));
+		create.add(isRemoteCond);
 
 		elementList.addElement(create);
 
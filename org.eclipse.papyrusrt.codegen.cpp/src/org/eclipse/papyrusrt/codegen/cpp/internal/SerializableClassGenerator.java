@@ -7,23 +7,43 @@
  *******************************************************************************/
 package org.eclipse.papyrusrt.codegen.cpp.internal;
 
+import java.util.ArrayList;
+import java.util.List;
+
 import org.eclipse.papyrusrt.codegen.cpp.CppCodePattern;
 import org.eclipse.papyrusrt.codegen.cpp.TypesUtil;
+import org.eclipse.papyrusrt.codegen.cpp.profile.RTCppProperties.ClassKind;
 import org.eclipse.papyrusrt.codegen.cpp.profile.facade.RTCppGenerationProperties;
 import org.eclipse.papyrusrt.codegen.cpp.rts.UMLRTRuntime;
 import org.eclipse.papyrusrt.codegen.lang.cpp.Expression;
+import org.eclipse.papyrusrt.codegen.lang.cpp.Type;
+import org.eclipse.papyrusrt.codegen.lang.cpp.element.BitField;
 import org.eclipse.papyrusrt.codegen.lang.cpp.element.CppClass;
 import org.eclipse.papyrusrt.codegen.lang.cpp.element.ElementList;
+import org.eclipse.papyrusrt.codegen.lang.cpp.element.Function;
+import org.eclipse.papyrusrt.codegen.lang.cpp.element.LinkageSpec;
 import org.eclipse.papyrusrt.codegen.lang.cpp.element.MemberField;
 import org.eclipse.papyrusrt.codegen.lang.cpp.element.OffsetOf;
+import org.eclipse.papyrusrt.codegen.lang.cpp.element.Parameter;
+import org.eclipse.papyrusrt.codegen.lang.cpp.element.PrimitiveType;
 import org.eclipse.papyrusrt.codegen.lang.cpp.element.Variable;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.AddressOfExpr;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.BinaryOperation;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.BlockInitializer;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.CastExpr;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.ElementAccess;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.ExpressionBlob;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.FunctionAddress;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.IntegralLiteral;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.LogicalComparison;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.MemberAccess;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.Sizeof;
 import org.eclipse.papyrusrt.codegen.lang.cpp.expr.StringLiteral;
+import org.eclipse.papyrusrt.codegen.lang.cpp.expr.UnaryOperation;
 import org.eclipse.papyrusrt.codegen.lang.cpp.external.StandardLibrary;
+import org.eclipse.papyrusrt.codegen.lang.cpp.stmt.ExpressionStatement;
+import org.eclipse.papyrusrt.codegen.lang.cpp.stmt.ForStatement;
+import org.eclipse.papyrusrt.codegen.lang.cpp.stmt.ReturnStatement;
 import org.eclipse.papyrusrt.xtumlrt.common.Attribute;
 import org.eclipse.papyrusrt.xtumlrt.common.StructuredType;
 import org.eclipse.papyrusrt.xtumlrt.util.XTUMLRTExtensions;
@@ -35,6 +55,12 @@ import org.eclipse.papyrusrt.xtumlrt.util.XTUMLRTExtensions;
  */
 public class SerializableClassGenerator extends BasicClassGenerator {
 
+	/**
+	 * When this system property is "true", each serializable class gets type-specialized encode and
+	 * decode functions in its descriptor instead of the generic field-table walk.
+	 */
+	public static final String SPECIALIZED_SERIALIZERS_PROPERTY = "org.eclipse.papyrusrt.codegen.cpp.specializedSerializers";
+
 	/** The {@link StructuredType} (struct or class). */
 	private final StructuredType data;
 
@@ -60,6 +86,7 @@ public class SerializableClassGenerator extends BasicClassGenerator {
 		ElementList elements = cpp.getElementList(CppCodePattern.Output.BasicClass, data);
 
 		BlockInitializer fieldsInit = new BlockInitializer(UMLRTRuntime.UMLRTObject.getFieldType().const_().arrayOf(null));
+		List<Attribute> serialized = new ArrayList<>();
 		for (Attribute attr : XTUMLRTExtensions.getAllAttributes(data)) {
 			// Bug 470881: Static fields should not be serialized.
 			if (!attr.isStatic()) {
@@ -69,6 +96,7 @@ public class SerializableClassGenerator extends BasicClassGenerator {
 				}
 
 				Expression arraySize = GeneratorUtils.generateBoundExpression(attr);
+				serialized.add(attr);
 
 				fieldsInit.addExpression(
 						new BlockInitializer(
@@ -87,8 +115,17 @@ public class SerializableClassGenerator extends BasicClassGenerator {
 		BlockInitializer descInit = new BlockInitializer(UMLRTRuntime.UMLRTObject.getType().const_());
 		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObjectGeneric_initialize(cls.getName()));
 		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObjectGeneric_copy(cls.getName()));
-		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObject_decode());
-		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObject_encode());
+		if (Boolean.getBoolean(SPECIALIZED_SERIALIZERS_PROPERTY) && canSpecialize(serialized)) {
+			Function decode = generateSerializer(cls, serialized, false);
+			Function encode = generateSerializer(cls, serialized, true);
+			elements.addElement(decode);
+			elements.addElement(encode);
+			descInit.addExpression(new FunctionAddress(decode));
+			descInit.addExpression(new FunctionAddress(encode));
+		} else {
+			descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObject_decode());
+			descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObject_encode());
+		}
 		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObjectGeneric_destroy(cls.getName()));
 		// descInit.addExpression( UMLRTRuntime.UMLRTObject.UMLRTObject_getSize() );
 		descInit.addExpression(UMLRTRuntime.UMLRTObject.UMLRTObject_fprintf());
@@ -116,4 +153,162 @@ public class SerializableClassGenerator extends BasicClassGenerator {
 		return true;
 	}
 
+	/**
+	 * Specialized serializers address every field with offsetof, so they are only generated when each
+	 * serialized attribute became an ordinary (non bit-field) member of this class.
+	 *
+	 * @param serialized
+	 *            - The attributes listed in the descriptor's field table.
+	 * @return {@code true} if encode and decode functions can be generated.
+	 */
+	private boolean canSpecialize(List<Attribute> serialized) {
+		for (Attribute attr : serialized) {
+			MemberField field = fields.get(attr);
+			if (field == null || field instanceof BitField) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Adjacent fields can be copied with a single memcpy only if the compiler must lay them out one
+	 * after the other: both are declared in the same access section, nothing the user declared can sit
+	 * between them and the class is not a union.
+	 *
+	 * @return {@code true} if runs of primitive fields may be merged.
+	 */
+	private boolean canMergeRuns() {
+		if (RTCppGenerationProperties.getPassiveClassPropKind(data) == ClassKind.UNION) {
+			return false;
+		}
+		return isBlank(RTCppGenerationProperties.getClassPropPrivateDeclarations(data))
+				&& isBlank(RTCppGenerationProperties.getClassPropProtectedDeclarations(data))
+				&& isBlank(RTCppGenerationProperties.getClassPropPublicDeclarations(data));
+	}
+
+	private static boolean isBlank(String str) {
+		return str == null || str.trim().isEmpty();
+	}
+
+	/**
+	 * An attribute whose descriptor is one of the RTS primitives is encoded as a byte copy of its
+	 * storage, so it (and any array of it) can be handled with memcpy.
+	 */
+	private boolean isPrimitive(Attribute attr) {
+		return UMLRTRuntime.UMLRTObject.UMLRTType(TypesUtil.createCppType(cpp, attr, attr.getType())) != null;
+	}
+
+	/** sizeof a member, including all elements when it is an array. */
+	private static Expression memberSize(CppClass cls, Attribute attr) {
+		return new ExpressionBlob("sizeof( ((" + cls.getName() + " *)0)->" + attr.getName() + " )");
+	}
+
+	/**
+	 * Generate a type-specialized encode or decode function. The encoded layout is the in-memory layout
+	 * (see UMLRTObject_encode), so primitive fields become fixed-size memcpys - merged into one copy for
+	 * each run of adjacent primitive fields - and nested types call their own descriptor once per element.
+	 *
+	 * @param cls
+	 *            - The {@link CppClass}.
+	 * @param serialized
+	 *            - The attributes listed in the descriptor's field table, in table order.
+	 * @param encode
+	 *            - {@code true} for the encode function, {@code false} for decode.
+	 * @return The generated {@link Function}.
+	 */
+	private Function generateSerializer(CppClass cls, List<Attribute> serialized, boolean encode) {
+		Type returnType = encode ? PrimitiveType.VOID.ptr() : PrimitiveType.VOID.const_().ptr();
+		Function fn = new Function(LinkageSpec.STATIC, returnType, (encode ? "encode_" : "decode_") + cls.getName());
+
+		Parameter desc = new Parameter(UMLRTRuntime.UMLRTObject.getType().const_().ptr(), "desc");
+		Parameter src = new Parameter(PrimitiveType.VOID.const_().ptr(), "src");
+		Parameter dst = new Parameter(PrimitiveType.VOID.ptr(), "dst");
+		Parameter nest = new Parameter(PrimitiveType.INT, "nest");
+		fn.add(desc);
+		fn.add(src);
+		fn.add(dst);
+		fn.add(nest);
+
+		Type srcType = StandardLibrary.uint8_t.const_().ptr();
+		Type dstType = StandardLibrary.uint8_t.ptr();
+		Variable s = new Variable(srcType, "s", new CastExpr(srcType, new ElementAccess(src)));
+		Variable d = new Variable(dstType, "d", new CastExpr(dstType, new ElementAccess(dst)));
+		fn.add(s);
+		fn.add(d);
+
+		boolean mergeRuns = canMergeRuns();
+		int i = 0;
+		while (i < serialized.size()) {
+			Attribute first = serialized.get(i);
+			Expression offset = new OffsetOf(cls, first.getName());
+
+			if (isPrimitive(first)) {
+				// Extend the run while the next field is also primitive and declared in the same section.
+				Attribute last = first;
+				CppClass.Visibility visibility = getVisibility(first.getVisibility());
+				while (mergeRuns
+						&& i + 1 < serialized.size()
+						&& isPrimitive(serialized.get(i + 1))
+						&& getVisibility(serialized.get(i + 1).getVisibility()) == visibility
+						&& isAdjacent(last, serialized.get(i + 1))) {
+					last = serialized.get(++i);
+				}
+
+				Expression size = memberSize(cls, last);
+				if (last != first) {
+					size = new BinaryOperation(
+							new BinaryOperation(new OffsetOf(cls, last.getName()), BinaryOperation.Operator.SUBTRACT, offset),
+							BinaryOperation.Operator.ADD,
+							size);
+				}
+				fn.add(StandardLibrary.memcpy(
+						new BinaryOperation(new ElementAccess(d), BinaryOperation.Operator.ADD, new OffsetOf(cls, first.getName())),
+						new BinaryOperation(new ElementAccess(s), BinaryOperation.Operator.ADD, new OffsetOf(cls, first.getName())),
+						size));
+			} else {
+				// Nested types go through the same descriptor the field table uses.
+				String fieldDesc = cls.getName() + "::fields[" + i + "].desc";
+				Variable j = new Variable(PrimitiveType.INT, "j", new IntegralLiteral(0));
+				ForStatement forStmt = new ForStatement(
+						j,
+						new LogicalComparison(
+								new ElementAccess(j),
+								LogicalComparison.Operator.LESS_THAN,
+								GeneratorUtils.generateBoundExpression(first)),
+						new UnaryOperation(UnaryOperation.Operator.PRE_INCREMENT, new ElementAccess(j)));
+				String elem = " + offsetof( " + cls.getName() + ", " + first.getName() + " ) + j * " + fieldDesc + "->object.sizeOf";
+				forStmt.add(new ExpressionStatement(new ExpressionBlob(
+						fieldDesc + (encode ? "->encode( " : "->decode( ") + fieldDesc + ", s" + elem + ", d" + elem + ", nest + 1 )")));
+				fn.add(forStmt);
+			}
+			++i;
+		}
+
+		fn.add(new ReturnStatement(new BinaryOperation(
+				new ElementAccess(encode ? d : s),
+				BinaryOperation.Operator.ADD,
+				new Sizeof(TypesUtil.createCppType(cpp, data, data)))));
+		return fn;
+	}
+
+	/**
+	 * Two serialized attributes are adjacent members if they are owned by the same classifier (inherited
+	 * attributes live in a different subobject) and no other member attribute is declared between them.
+	 */
+	private boolean isAdjacent(Attribute prev, Attribute next) {
+		if (prev.eContainer() != next.eContainer()) {
+			return false;
+		}
+		boolean afterPrev = false;
+		for (Attribute attr : XTUMLRTExtensions.getAllAttributes(data)) {
+			if (attr == prev) {
+				afterPrev = true;
+			} else if (afterPrev && !attr.isStatic()) {
+				return attr == next;
+			}
+		}
+		return false;
+	}
+
 }
@@ -10,17 +10,31 @@ package org.eclipse.papyrusrt.codegen.lang.cpp.expr;
 import org.eclipse.papyrusrt.codegen.lang.cpp.Expression;
 import org.eclipse.papyrusrt.codegen.lang.cpp.Type;
 import org.eclipse.papyrusrt.codegen.lang.cpp.dep.DependencyList;
+import org.eclipse.papyrusrt.codegen.lang.cpp.external.ExternalConstructorCall;
 import org.eclipse.papyrusrt.codegen.lang.cpp.internal.CppFormatter;
 
 public class NewExpr extends Expression
 {
-    private final ConstructorCall call;
+    private final AbstractFunctionCall call;
 
     public NewExpr( ConstructorCall call ) { this.call = call; }
 
-    @Override protected Type createType() { return call.createType().ptr(); }
+    /** Allocates an instance of a type defined outside of the generated code, e.g. in the RTS. */
+    public NewExpr( ExternalConstructorCall call ) { this.call = call; }
+
+    @Override protected Type createType() { return call.getType().ptr(); }
     @Override public Precedence getPrecedence() { return Precedence.Precedence03; }
-    @Override public boolean addDependencies( DependencyList deps ) { return call.addDependencies( deps ); }
+
+    @Override
+    public boolean addDependencies( DependencyList deps )
+    {
+        // The allocated type must be complete.  Generated classes are already included by the
+        // type that is being initialized (see ConstructorCall), external ones are not.
+        if( call instanceof ExternalConstructorCall
+         && ! call.getType().addDependencies( deps ) )
+            return false;
+        return call.addDependencies( deps );
+    }
 
     @Override
     public boolean write( CppFormatter fmt )
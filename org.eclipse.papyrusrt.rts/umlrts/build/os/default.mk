@@ -19,21 +19,31 @@ CC_OBJS=\
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtbasicthread$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcapsule$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcapsuleid$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcapsulemessagequeue$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcommsport$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcommunicator$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcompressor$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcontroller$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcontrollerbalancer$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtcontrollerpool$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtdeferqueue$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtdeploymentmap$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtexecutiondirector$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtframeprotocol$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtframeservice$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtfreeslots$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrthashmap$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtinoutsignal$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtinsignal$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtinvoke$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtjsonreader$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtlogprotocol$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtlogwriter$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmain$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmainloop$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmaintargetshutdown$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmaintargetstartup$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmemoryregion$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmessage$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmessagepool$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtmessagequeue$(OBJ_EXT) \
@@ -42,12 +52,15 @@ CC_OBJS=\
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtpool$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtprioritymessagequeue$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtprotocol$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtproxycapsule$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtqueue$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtrtsinterfaceumlrt$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtsignal$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtsignalelement$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtsignalelementpool$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrtsignalregistry$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtsubstructure$(OBJ_EXT) \
+    $(BUILDROOT)/$(CONFIG)/umlrt/umlrtthreadattributes$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrttimerid$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrttimerpool$(OBJ_EXT) \
     $(BUILDROOT)/$(CONFIG)/umlrt/umlrttimerprotocol$(OBJ_EXT) \
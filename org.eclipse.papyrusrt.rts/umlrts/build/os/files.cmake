@@ -16,21 +16,31 @@ set(SRCS
   ${UMLRTS_ROOT}/umlrt/umlrtbasicthread.cc
   ${UMLRTS_ROOT}/umlrt/umlrtcapsule.cc
   ${UMLRTS_ROOT}/umlrt/umlrtcapsuleid.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtcapsulemessagequeue.cc
   ${UMLRTS_ROOT}/umlrt/umlrtcommsport.cc
   ${UMLRTS_ROOT}/umlrt/umlrtcommunicator.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtcompressor.cc
   ${UMLRTS_ROOT}/umlrt/umlrtcontroller.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtcontrollerbalancer.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtcontrollerpool.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtdeferqueue.cc
   ${UMLRTS_ROOT}/umlrt/umlrtdeploymentmap.cc
   ${UMLRTS_ROOT}/umlrt/umlrtexecutiondirector.cc
   ${UMLRTS_ROOT}/umlrt/umlrtframeprotocol.cc
   ${UMLRTS_ROOT}/umlrt/umlrtframeservice.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtfreeslots.cc
   ${UMLRTS_ROOT}/umlrt/umlrthashmap.cc
   ${UMLRTS_ROOT}/umlrt/umlrtinsignal.cc
   ${UMLRTS_ROOT}/umlrt/umlrtinoutsignal.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtinvoke.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtjsonreader.cc
   ${UMLRTS_ROOT}/umlrt/umlrtlogprotocol.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtlogwriter.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmain.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmainloop.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmaintargetshutdown.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmaintargetstartup.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtmemoryregion.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmessage.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmessagepool.cc
   ${UMLRTS_ROOT}/umlrt/umlrtmessagequeue.cc
@@ -39,12 +49,15 @@ set(SRCS
   ${UMLRTS_ROOT}/umlrt/umlrtpool.cc
   ${UMLRTS_ROOT}/umlrt/umlrtprioritymessagequeue.cc
   ${UMLRTS_ROOT}/umlrt/umlrtprotocol.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtproxycapsule.cc
   ${UMLRTS_ROOT}/umlrt/umlrtqueue.cc
   ${UMLRTS_ROOT}/umlrt/umlrtrtsinterfaceumlrt.cc
   ${UMLRTS_ROOT}/umlrt/umlrtsignal.cc
   ${UMLRTS_ROOT}/umlrt/umlrtsignalelement.cc
   ${UMLRTS_ROOT}/umlrt/umlrtsignalelementpool.cc
   ${UMLRTS_ROOT}/umlrt/umlrtsignalregistry.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtsubstructure.cc
+  ${UMLRTS_ROOT}/umlrt/umlrtthreadattributes.cc
   ${UMLRTS_ROOT}/umlrt/umlrttimerid.cc
   ${UMLRTS_ROOT}/umlrt/umlrttimerpool.cc
   ${UMLRTS_ROOT}/umlrt/umlrttimerprotocol.cc
@@ -14,10 +14,13 @@ CC_OBJS+= \
    $(BUILDROOT)/$(CONFIG)/util/basedebug$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/util/basefatal$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/osbasicthread$(OBJ_EXT) \
+   $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/osmappedfile$(OBJ_EXT) \
+   $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/osmemoryregion$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/osmutex$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/osnotify$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/ossemaphore$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/ostime$(OBJ_EXT) \
+   $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/ostimerfd$(OBJ_EXT) \
    $(BUILDROOT)/$(CONFIG)/os/$(TARGETOS)/ostimespec$(OBJ_EXT)
 
 
@@ -11,6 +11,8 @@
 #ifndef UMLRTBASICTHREAD_HH
 #define UMLRTBASICTHREAD_HH
 
+#include "umlrtthreadattributes.hh"
+
 typedef void * osthreadid_t;
 
 class UMLRTBasicThread
@@ -24,6 +26,7 @@ class UMLRTBasicThread
     // - 'join()' to wait for thread to exit and get return value.
     // - 'isMyThread()' returns true if this is currently running thread.
     // - 'getName()' to get the thread's name (defined at instantiation).
+    // - 'setAttributes()' to define CPU affinity, scheduling, stack size and NUMA placement before 'start()'.
 
 private:
     osthreadid_t tid;
@@ -42,6 +45,12 @@ private:
 
     threadargs_t threadargs;
 
+    // Applied when the thread is started.
+    UMLRTThreadAttributes attributes;
+
+    // Apply the attributes that can only be set from the new thread itself (called by 'static_entrypoint').
+    void applyAttributes();
+
     // Static entry point for pthread. Needs both sub-class
     // instance and argument passed to 'start()'.
 
@@ -67,6 +76,10 @@ public:
 
     bool isMyThread();
 
+    // Set the attributes applied when the thread is started.
+
+    void setAttributes( const UMLRTThreadAttributes & attributes_ );
+
     // Return my name
 
     const char * getName() const;
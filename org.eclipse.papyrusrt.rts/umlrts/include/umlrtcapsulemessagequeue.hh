@@ -0,0 +1,126 @@
+// umlrtcapsulemessagequeue.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTCAPSULEMESSAGEQUEUE_HH
+#define UMLRTCAPSULEMESSAGEQUEUE_HH
+
+#include <stddef.h>
+#include <stdint.h>
+#include "umlrtqueue.hh"
+#include "umlrtpriority.hh"
+#include "umlrtuserconfig.hh"
+
+class UMLRTMessage;
+class UMLRTPriorityMessageQueue;
+class UMLRTClockCache;
+class UMLRTTimerQueue;
+struct UMLRTSlot;
+
+// UMLRTCapsuleMessageQueue - the controller's queue of messages ready for injection.
+
+// Like UMLRTPriorityMessageQueue, there is one FIFO per priority level, but this queue
+// is only ever accessed by its owning controller thread, so it has no locking and no
+// notification. A bitmap of non-empty priority levels makes finding the highest priority
+// message (and isEmpty) constant-time and a running total makes count() constant-time.
+
+// Messages from other threads arrive via UMLRTPriorityMessageQueue (the controller's
+// 'incomingQueue') and are transferred in bulk with #moveAll.
+
+// Batches:
+// #dequeueBatch moves up to USER_CONFIG_CONTROLLER_BATCH_SIZE messages from the head of the
+// highest priority level into a batch and #nextInBatch hands them out in order. Messages
+// in the batch remain visible to #remove and #count. A batch ends early (the remainder is
+// returned to the front of its level) if a message of higher priority is enqueued or a
+// message is enqueued to the front of the batch's level, so the injection order is exactly
+// that of repeated #dequeueHighestPriority calls.
+
+// #nextInBatchFor continues the batch only while the next message is a signal to a given slot,
+// which lets the controller inject consecutive messages to one capsule as a run.
+
+class UMLRTCapsuleMessageQueue
+{
+public:
+
+    UMLRTCapsuleMessageQueue ( const char * owner );
+
+    // Transfer all messages from a priority-queue. Returns the number of messages moved.
+    size_t moveAll ( UMLRTPriorityMessageQueue & fromQueue );
+
+    // Queue up all messages associated with timed-out timers.
+    void queueTimerMessages ( UMLRTTimerQueue * timerQueue, UMLRTClockCache & now );
+
+    // Get the highest priority message. Continues the current batch, if any.
+    UMLRTMessage * dequeueHighestPriority ( );
+
+    // Start a batch of at most 'maxCount' messages of the highest priority. Ends any
+    // current batch first. Returns the number of messages in the batch.
+    size_t dequeueBatch ( size_t maxCount );
+
+    // Return the next message of the current batch - NULL once the batch is done or has ended.
+    UMLRTMessage * nextInBatch ( );
+
+    // Return the next message of the current batch if it is a signal to 'slot' - otherwise NULL, leaving it in the batch.
+    UMLRTMessage * nextInBatchFor ( const UMLRTSlot * slot );
+
+    // Return any messages remaining in the current batch to the queue.
+    void endBatch ( );
+
+    // Put the message into its appropriate priority level.
+    void enqueue ( UMLRTMessage * msg, bool front = false );
+
+    // Append a list of messages (already linked together) that share one signal and therefore one priority.
+    void enqueueAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count );
+
+    bool isEmpty ( ) const { return total == 0; }
+
+    // Return the current # of queued messages (including those remaining in the current batch).
+    size_t count ( ) const { return total; }
+
+    // Purge queue (and current batch) of elements that match the criteria.
+    void remove ( UMLRTQueue::match_compare_t callback, UMLRTQueue::match_notify_t notify, void * userData );
+
+private:
+    UMLRTCapsuleMessageQueue ( );
+
+    // Singly-linked FIFO for one priority level.
+    typedef struct
+    {
+        const UMLRTQueueElement * head;
+        const UMLRTQueueElement * tail; // Undefined if 'head == NULL'.
+
+    } Level;
+
+    void levelPush ( UMLRTPriority priority, const UMLRTQueueElement * element, bool front );
+
+    const UMLRTQueueElement * levelPop ( UMLRTPriority priority );
+
+    void debugDequeued ( const UMLRTMessage * msg ) const;
+
+    // Highest priority level with queued messages. Only valid if 'nonEmpty != 0'.
+    UMLRTPriority highestPriority ( ) const;
+
+    // Owner - for debugging.
+    const char * const owner;
+
+    Level level[PRIORITY_MAXPLUS1];
+
+    // Bit 'p' is set when level[p] is non-empty.
+    uint32_t nonEmpty;
+
+    size_t total;
+
+    // Current batch. Entries purged by #remove are set to NULL.
+    UMLRTMessage * batch[USER_CONFIG_CONTROLLER_BATCH_SIZE];
+    size_t batchNext;
+    size_t batchCount;
+    UMLRTPriority batchPriority;
+};
+
+#endif // UMLRTCAPSULEMESSAGEQUEUE_HH
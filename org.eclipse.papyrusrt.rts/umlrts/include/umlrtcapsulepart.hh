@@ -23,6 +23,7 @@
 #include "umlrtcapsulerole.hh"
 
 struct UMLRTSlot;
+class UMLRTFreeSlots;
 
 struct UMLRTCapsulePart
 {
@@ -32,6 +33,9 @@ struct UMLRTCapsulePart
     size_t numSlot; // Replication factor.
     UMLRTSlot *  *  slots;
 
+    // Unoccupied slots of an optional or plugin part. Built by the frame service on first use for generated parts.
+    mutable UMLRTFreeSlots * freeSlots;
+
     size_t size ( ) const { return role() == NULL ? 0 : role()->multiplicityUpper; }
 
     const UMLRTCapsuleRole * role() const
@@ -0,0 +1,64 @@
+// umlrtclockcache.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTCLOCKCACHE_HH
+#define UMLRTCLOCKCACHE_HH
+
+#include "umlrttimespec.hh"
+
+// The current time, read at most once per clock between calls to 'invalidate'.
+
+// A controller invalidates its cache at the start of each pass of its main loop and before it
+// waits, so all the timers examined during that step are compared against the same 'now'.
+
+class UMLRTClockCache
+{
+public:
+    UMLRTClockCache ( ) : haveMonotonic(false), haveClock(false), reads(0) { }
+
+    // Forget the cached times - the next request reads the clock.
+    void invalidate ( ) { haveMonotonic = haveClock = false; }
+
+    // See UMLRTTimespec::getmonotonic.
+    const UMLRTTimespec & monotonic ( )
+    {
+        if (!haveMonotonic)
+        {
+            UMLRTTimespec::getmonotonic(&monotonicNow);
+            haveMonotonic = true;
+            ++reads;
+        }
+        return monotonicNow;
+    }
+
+    // See UMLRTTimespec::getclock.
+    const UMLRTTimespec & clock ( )
+    {
+        if (!haveClock)
+        {
+            UMLRTTimespec::getclock(&clockNow);
+            haveClock = true;
+            ++reads;
+        }
+        return clockNow;
+    }
+
+    // Number of times a clock was actually read.
+    unsigned long getReads ( ) const { return reads; }
+
+private:
+    UMLRTTimespec monotonicNow;
+    UMLRTTimespec clockNow;
+    bool haveMonotonic;
+    bool haveClock;
+    unsigned long reads;
+};
+
+#endif // UMLRTCLOCKCACHE_HH
@@ -16,7 +16,8 @@
 #include "umlrtapi.hh"
 #include "umlrtcapsuleclass.hh"
 #include "umlrtcommsportrole.hh"
-#include "umlrtmessagequeue.hh"
+#include "umlrtdeferqueue.hh"
+#include "umlrtlinkpolicy.hh"
 #include "umlrtslot.hh"
 
 struct UMLRTSlot;
@@ -33,7 +34,7 @@ struct UMLRTCommsPort
     size_t numFarEnd;
     UMLRTCommsPortFarEnd * farEnds; // List size > 1 for replicated ports.
 
-    mutable UMLRTMessageQueue * deferQueue; // Deferred messages on this port.
+    mutable UMLRTDeferQueue * deferQueue; // Deferred messages on this port.
     mutable char * registeredName;
     mutable const char * registrationOverride;
 
@@ -48,9 +49,10 @@ struct UMLRTCommsPort
     bool spp; // True if the port is an SPP.
     bool unbound; // True to represent the unbound port. Has no far-end instances and is replaced when binding.
     bool wired; // True for wired ports. Used for rtBound/rtUnbound notifications.
+    mutable UMLRTLinkPolicy linkPolicy; // Sends to another host when its link is out of credit. Generated ports default to LINK_POLICY_ERROR.
 
-    // Struct passed to queue-remove routine on deferQueue for purge/recall operations.
-    // Selects messages from deferQueue and specifies behaviour of the purge/recall of each matched message.
+    // Struct passed to the deferQueue remove routine for recall operations.
+    // Specifies behaviour of the recall of each matched message.
     struct PurgeRecall
     {
         int index;
@@ -60,18 +62,17 @@ struct UMLRTCommsPort
 
     const char * getName ( ) const { return role() == NULL ? "(undefined)" : role()->name; }
 
-    static bool purgeMatchCompare( UMLRTMessage * msg, const PurgeRecall * purge );
     static void purgeMatchNotify( UMLRTMessage * msg, const PurgeRecall * purge );
 
     // 'index' is the port far-end instance (-1 for all instances). 'id' is the signal id being purged (-1 for all.)
     int purge( int index = -1, int id = -1 ) const;
 
-    static bool recallMatchCompare( UMLRTMessage * msg, const PurgeRecall * recall );
     static void recallMatchNotify( UMLRTMessage * msg, const PurgeRecall * recall );
 
     // 'index' is the port far-end instance destination of recalled message (-1 for all instances.)
     // 'front' is true if messages are being recalled to front of capsule queue (false to queue messages on tail of queue.)
     // 'one' is true if only a signal message (matching the criteria) are recalled (false for 'all' messages.)
+    // 'id' is the signal id being recalled (-1 for all.)
     int recall( int index = -1, bool front = false, bool one = false, int id = -1  ) const;
 
     const char * slotName ( ) const { return slot->name; }
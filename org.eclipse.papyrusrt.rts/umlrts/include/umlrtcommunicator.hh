@@ -13,9 +13,14 @@
 
 // UMLRTCommunicator is the main controller-class.
 
+#include "umlrtlinkpolicy.hh"
+#include "umlrtmutex.hh"
 #include "umlrtqueue.hh"
 #include "umlrtqueueelement.hh"
+#include "umlrtsemaphore.hh"
 #include <stdlib.h>
+#include <string>
+#include <vector>
 
 struct UMLRTHost;
 
@@ -36,18 +41,26 @@ public:
                     free((void*)payload);
             }
 
+            // One receiving port instance. A frame lists every destination on its host so the
+            // payload is encoded and transmitted once for all of them.
+            struct Destination
+            {
+                std::string slot;
+                int port;
+                bool internal;
+                int srcPortIndex; // Far-end index of the source port the signal was sent on.
+            };
+
             UMLRTHost * destHost;
-            const char * destSlot;
+            std::vector<Destination> dests;
             const char * srcSlot;
 
-            int destPort;
             int srcPort;
-            bool destInternal;
             bool srcInternal;
 
             const char * protocolName;
             const char * signalName;
-            const char * payload;
+            char * payload; // Owned (malloc'd). Consumed by in-situ JSON parsing on receipt.
             int payloadSize;
     };
 
@@ -60,9 +73,34 @@ public:
     void waitForGoSignal ( UMLRTHost * host );
     const char *  waitForDeployment ( );
 
-    void queueMessage ( UMLRTCommunicator::Message * msg );
+    // Outcome of queuing a frame.
+    enum QueueResult
+    {
+        QUEUED,
+        REFUSED,        // Out of credit - LINK_POLICY_ERROR.
+        DROPPED,        // Out of credit - LINK_POLICY_DROP.
+        WOULD_BLOCK     // Out of credit - LINK_POLICY_BLOCK. Retry with #queueMessageWait.
+    };
+
+    // Queue 'msg' for its destination host. Each queued frame takes one credit of the link, returned
+    // when the frame has been sent. A link whose queue reaches the high water mark has no credit until
+    // it drains to the low water mark, so a slow host cannot make the sender queue without limit.
+    // 'msg' is deleted if REFUSED or DROPPED.
+    QueueResult queueMessage ( UMLRTCommunicator::Message * msg, UMLRTLinkPolicy policy );
+
+    // Wait up to USER_CONFIG_LINK_BLOCK_MSEC for credit to queue 'msg', then give up (REFUSED, 'msg' deleted).
+    // The caller must not hold the RTS lock - the frames it waits for are sent by the execution director.
+    QueueResult queueMessageWait ( UMLRTCommunicator::Message * msg );
+
     UMLRTCommunicator::Message* sendrecv();
 
+    // Compress payloads of at least 'bytes' on links where the peer agrees (0 disables compression).
+    // Must be set before the deployment handshake, which negotiates compression per link.
+    static void setCompressThreshold ( size_t bytes );
+
+    // Set the link water marks, in frames. A 'high' of 0 disables link flow control.
+    static void setWaterMarks ( size_t high, size_t low );
+
 private:    
     const char * localaddr;
     UMLRTHost * localhost;
@@ -70,6 +108,21 @@ private:
     bool abort;
 
     UMLRTQueue messageQueue;
+
+    static size_t compressThreshold;
+    static size_t highWater;
+    static size_t lowWater;
+
+    UMLRTMutex creditMutex;     // Guards the link credit of every host.
+    UMLRTSemaphore creditFreed; // Posted for each waiting sender when a link drains.
+    size_t creditWaiters;
+    size_t creditRound;         // Advanced each time the waiters are woken.
+
+    // Take one credit of the link to 'host'. False if there is none. Assumes creditMutex is taken.
+    bool takeCredit ( UMLRTHost * host );
+
+    // A frame to 'host' has left the queue.
+    void returnCredit ( UMLRTHost * host );
     
     void disconnect ( UMLRTHost * host );
     void handshake ( UMLRTHost * host );
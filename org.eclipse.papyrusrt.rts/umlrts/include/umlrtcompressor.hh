@@ -0,0 +1,36 @@
+// umlrtcompressor.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTCOMPRESSOR_HH
+#define UMLRTCOMPRESSOR_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+// UMLRTCompressor - fast compression of remote signal payloads.
+
+// Output is in the LZ4 block format (greedy matching, 64KB window), so a frame can be
+// unpacked by any LZ4 block decoder. It favours speed over ratio: JSON-encoded numeric
+// arrays typically shrink 3-5x for a small fraction of the cost of encoding them.
+
+class UMLRTCompressor
+{
+public:
+    // Worst-case compressed size of 'srcSize' bytes.
+    static size_t bound ( size_t srcSize ) { return srcSize + (srcSize / 255) + 16; }
+
+    // Compress 'src' into 'dst'. Returns the compressed size, or 0 if it does not fit in 'dstCapacity'.
+    static size_t compress ( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstCapacity );
+
+    // Expand 'src' into exactly 'dstSize' bytes. Returns false if the input is corrupt or of a different size.
+    static bool decompress ( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstSize );
+};
+
+#endif // UMLRTCOMPRESSOR_HH
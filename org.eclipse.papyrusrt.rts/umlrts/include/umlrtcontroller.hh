@@ -16,15 +16,20 @@
 #include "umlrtbasicthread.hh"
 #include "umlrtslot.hh"
 #include "umlrtcapsuleid.hh"
+#include "umlrtclockcache.hh"
+#include "umlrtcapsulemessagequeue.hh"
 #include "umlrtprioritymessagequeue.hh"
 #include "umlrttimerqueue.hh"
 #include "umlrtcontrollercommand.hh"
+#include "umlrtsemaphore.hh"
 
 struct UMLRTCommsPort;
+class UMLRTMessage;
 class UMLRTMessagePool;
 class UMLRTSignal;
 class UMLRTSignalElementPool;
 struct UMLRTTimer;
+class UMLRTTimerFd;
 class UMLRTTimerPool;
 
 class UMLRTController : UMLRTBasicThread
@@ -58,6 +63,11 @@ public:
         E_INC_NOT_OPT,          // attempting to incarnate in a non-optional slot
         E_INC_PARTS_ERROR,      // slot had parts already allocated - internal error
         E_INC_SLOT_OCC,         // capsule slot is occupied
+        E_INC_SLOT_DSTR,        // capsule slot was condemned for destruction during the incarnate
+        E_INVOKE_REENTRANT,     // invoke of a capsule already in a transition on this thread
+        E_INVOKE_REMOTE,        // invoke of a capsule on another host
+        E_INVOKE_TIMEOUT,       // invoke of a capsule on another controller was not handled in time
+        E_REPLY_NO_INVOKE,      // reply from a port with no invoke to reply to, or already replied
         E_SAPDREG_NOT_SAP,      // attempt to deregister a port which is not a SAP.
         E_SAPDREG_SAP_LOCKED,   // attempt to deregister a locked service port.
         E_SAPREG_NOT_SAP,       // attempt to register a port which is not a SAP.
@@ -68,6 +78,7 @@ public:
         E_SPPREG_NOT_SPP,       // attempt to register a port which is not a SPP.
         E_SEND_FROM_DSTR,       // send attempted from a slot designated for destruction
         E_SEND_INV_SIG,         // invalid send signal
+        E_SEND_LINK_FULL,       // link to the destination host is out of credit
         E_SEND_NO_CAP_INST,     // destination port has no capsule instance running
         E_SEND_NO_MSG_AVL,      // deliver no message available
         E_SEND_NO_PORT_INST,    // source port index greater than source port replication
@@ -78,6 +89,7 @@ public:
         E_TIMER_GET,            // failed to get timer
         E_TIMER_NOT_ALLOC,      // timer not marked as allocated
         E_TIMER_CANC_INV,       // cancel invalid timer
+        E_TIMER_POLICY,         // overrun policy invalid for the timer
         E_MAX                   // indicates maximum error code
 
     } Error;
@@ -105,6 +117,11 @@ public:
     "incarnate failed - non-optional slot", \
     "incarnate failed - internal software error - slot parts already defined", \
     "incarnate failed - capsule slot already occuppied", \
+    "incarnate failed - capsule slot condemned for destruction", \
+    "invoke failed - destination capsule is in a transition on this thread", \
+    "invoke failed - destination capsule is on another host", \
+    "invoke failed - no reply before the timeout", \
+    "reply failed - port is not handling an invoke or has already replied", \
     "SAP deregister failed - port not an SAP", \
     "SAP deregister failed - port registration is locked", \
     "SAP register failed - port not an SAP", \
@@ -115,6 +132,7 @@ public:
     "SPP register failed - port not an SPP", \
     "send failed - send from a slot condemned for destruction", \
     "send failed - attempt to send invalid signal", \
+    "send failed - link to the destination host is out of credit", \
     "send failed - destination port has no running capsule instance", \
     "send failed - failed to allocate msg resource", \
     "send failed - source port index exceeds available port far end instances", \
@@ -125,11 +143,12 @@ public:
     "timer failed - failed to allocate timer", \
     "timer failed - internal software error - timer not marked as allocated", \
     "timer failed - cannot cancel invalid timer", \
+    "timer failed - overrun policy invalid for the timer", \
 }
 
     UMLRTController ( const char * name_, size_t numSlot, UMLRTSlot slots_[] );
     UMLRTController ( const char * name_ );
-    virtual ~UMLRTController ( ) { }
+    virtual ~UMLRTController ( );
 
     // Abort the controller (or all controllers). This release always aborts all.
     void abort ( ) { enqueueAbortAllControllers(); }
@@ -147,6 +166,14 @@ public:
     // Deliver a signal to the destination port. Returns true if no error.
     bool deliver ( const UMLRTCommsPort * destPort, const UMLRTSignal & signal, size_t srcPortIndex );
 
+    // Allocate and format the message delivering a signal to the destination port, without queuing it.
+    // If 'referenceHeld' the caller has already counted the message's reference to the signal element.
+    // Returns NULL (and sets the sender's error) if no message is available.
+    UMLRTMessage * prepareDelivery ( const UMLRTCommsPort * destPort, const UMLRTSignal & signal, size_t srcPortIndex, bool referenceHeld = false );
+
+    // Queue a list of prepared messages (linked together, all carrying the same signal) with a single wakeup.
+    void deliverAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count );
+
     // Enqueue an abort command.
     void enqueueAbort ( );
 
@@ -200,6 +227,41 @@ public:
     // Initialize the free signal, message and timer pools.
     static void initializePools ( UMLRTSignalElementPool * signalElementPool_, UMLRTMessagePool * messagePool_, UMLRTTimerPool * timerPool_ );
 
+    // Number of messages injected by this controller since it started.
+    size_t getInjectedCount ( ) const { return injectedCount; }
+
+    // What the inject loop needs of a capsule run by this controller, kept in one array per controller
+    // so injecting touches the controller's own memory rather than the slots scattered across the model.
+    // A slot gets an entry when it is first injected into (or at startup, for generated slots) and loses
+    // it when its capsule is destroyed, deported or migrated away. The array is only changed with the
+    // RTS lock held; other threads hold the RTS lock to read it.
+    struct Resident
+    {
+        UMLRTCapsule * capsule;
+        UMLRTSlot * slot;
+        size_t injected;    // Messages injected - sampled (and reset) by the controller load balancer.
+        bool condemned;     // Copy of the slot's 'condemned' (see #setCondemned).
+    };
+
+    // This controller's resident capsules. Assumes RTS lock held when called from another thread.
+    size_t getNumResidents ( ) const { return numResidents; }
+    Resident * getResidents ( ) const { return residents; }
+
+    // Drop the entry of a slot whose capsule is leaving this controller. Assumes RTS lock held.
+    void evict ( const UMLRTSlot * slot );
+
+    // Set the 'condemned' flag of a slot and of its entry in its controller. Assumes RTS lock held.
+    static void setCondemned ( UMLRTSlot * slot, bool condemned );
+
+    // Number of messages waiting to be injected. Only a snapshot when called from another thread.
+    size_t getQueueDepth ( );
+
+    // Number of times this controller has read a clock to run its timers.
+    unsigned long getClockReads ( ) const { return now.getReads(); }
+
+    // Inject the message of a same-controller invoke directly, from the invoker's transition.
+    void injectInvoke ( UMLRTMessage & msg );
+
     // Tell caller whether they are running in this controller's context.
     bool isMyThread ( );
 
@@ -217,9 +279,17 @@ public:
     // Set the error code.
     void setError ( Error error );
 
+    // Set the most consecutive messages to one capsule injected as a single run (see #dispatch). 1 disables runs.
+    static void setCapsuleRun ( size_t count ) { capsuleRun = (count > 0) ? count : 1; }
+
    // Start the controller thread.
     void spawn ( );
 
+    // Move a slot to another controller on this host. Its queued messages and running timers move with it.
+    // The move is done by the slot's current controller between injections, so the capsule is never run
+    // by both controllers. Returns false if the slot cannot be moved.
+    static bool migrate ( UMLRTSlot * slot, UMLRTController * destination );
+
     // Start a timer (enqueue the timer on to the controller's timer queue).
     void startTimer ( const UMLRTTimer * timer );
 
@@ -237,6 +307,30 @@ private:
 
     } t_message_match_criteria;
 
+    // Used to collect the messages and timers of a migrating slot.
+    typedef struct
+    {
+        UMLRTSlot * slot;
+        const UMLRTQueueElement * head;
+        const UMLRTQueueElement * tail;
+
+    } t_migrate_list;
+
+    // Callback to select messages and commands for a migrating slot.
+    static bool migrateMsgMatchCompare ( UMLRTMessage * msg, t_migrate_list * list );
+
+    // Callback to select timers for a migrating slot.
+    static bool migrateTimerMatchCompare ( UMLRTTimer * timer, t_migrate_list * list );
+
+    // Callback when a message or timer of a migrating slot was removed - adds it to the list.
+    static void migrateMatchNotify ( UMLRTQueueElement * element, t_migrate_list * list );
+
+    // Enqueue a migrate command.
+    void enqueueMigrate ( UMLRTSlot * slot, UMLRTController * destination );
+
+    // Move a slot from this controller to another - run from this controller.
+    void migrateSlot ( UMLRTSlot * slot, UMLRTController * destination );
+
     // Callback to purge messages for a condemned slot.
     static bool deallocateMsgMatchCompare ( UMLRTMessage * msg, t_message_match_criteria * criteria );
 
@@ -252,18 +346,27 @@ private:
     // Process controller command.
     void executeCommand ( UMLRTMessage * msg );
 
+    // Run by a worker thread when the controller is in a UMLRTControllerPool.
+    friend class UMLRTControllerPool;
+
     const char * const name_;
 
     // Messages from other threads.
     UMLRTPriorityMessageQueue    incomingQueue;
 
     // Messages destined for contained capsules. This thread is the only
-    // thread enqueuing and dequeuing from this queue.
-    UMLRTPriorityMessageQueue    capsuleQueue;
+    // thread enqueuing and dequeuing from this queue, so it is not locked.
+    UMLRTCapsuleMessageQueue     capsuleQueue;
 
     // Queue of running timers. Starts out empty.
     UMLRTTimerQueue timerQueue;
 
+    // Armed with the time remaining on the first running timer while the controller waits.
+    UMLRTTimerFd * timerFd;
+
+    // The current time, read at most once per step of the main loop (expiring timers, waiting).
+    UMLRTClockCache now;
+
     // Queue of deferred messages.
     UMLRTMessageQueue deferredMessages;
 
@@ -282,6 +385,9 @@ private:
     // The application-wide free timer pool.
     static UMLRTTimerPool * timerPool;
 
+    // Most consecutive messages to one capsule injected as a single run.
+    static size_t capsuleRun;
+
     bool _exit; // Normal exit.
     void * exitValue; // Defined by user on normal exit. Set to EXIT_FAILURE on abort.
     bool _abort; // Abnormal exit.
@@ -289,6 +395,32 @@ private:
     // Last error - set by a failed RTS API which returns an error-indication back to the user.
     Error lastError;
 
+    // Messages injected - sampled by the controller load balancer.
+    size_t injectedCount;
+
+    // Resident capsules (see #Resident). A slot's 'resident' is 1 + the index of its entry.
+    Resident * residents;
+    size_t numResidents;
+    size_t maxResidents;
+
+    // The entry of a slot run by this controller - added if it has none.
+    Resident * resident ( const UMLRTSlot * slot );
+
+    // The entry of a slot run by this controller - NULL if it has none.
+    Resident * findResident ( const UMLRTSlot * slot );
+
+    // Add an entry for a slot.
+    Resident * adopt ( const UMLRTSlot * slot );
+
+    // Controller pool scheduling state - see UMLRTControllerPool.
+    volatile int poolState;
+    UMLRTController * poolNext;
+    UMLRTController * poolPrev;
+    bool poolStarted;
+
+    // Posted when the controller exits in a pool (there is no thread to join).
+    UMLRTSemaphore poolDone;
+
     // Output the capsule nesting.
     void debugOutputSlotContainment ( const UMLRTSlot * slot, size_t nesting );
 
@@ -320,6 +452,20 @@ private:
     // Main loop
     virtual void * run ( void * args );
 
+    // Initialization before the first message is injected.
+    void startup ( );
+
+    // Transfer incoming messages and expired timers to the capsule queue and inject the messages queued.
+    // Consecutive messages to one capsule are injected as a run - the checks for commands, empty slots
+    // and debug output are made once for the run, while each message is still a separate transition.
+    void dispatch ( );
+
+    // Clean-up when the controller exits or aborts. Returns the exit value.
+    void * shutdown ( );
+
+    // True if there are messages or expired timers waiting to be processed.
+    bool isReady ( );
+
     // Wait on either an external message or a timeout.
     void wait ( );
 };
@@ -0,0 +1,60 @@
+// umlrtcontrollerbalancer.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTCONTROLLERBALANCER_HH
+#define UMLRTCONTROLLERBALANCER_HH
+
+#include <stddef.h>
+#include <stdint.h>
+#include "umlrtbasicthread.hh"
+#include "umlrtuserconfig.hh"
+
+class UMLRTController;
+struct UMLRTSlot;
+
+// UMLRTControllerBalancer - optional thread that moves capsules from busy controllers to idle ones.
+
+// Every period, the load of each controller on this host is taken as the number of messages it
+// injected during the period plus the messages waiting in its queues. When the busiest controller
+// is busy enough and sufficiently busier than the least busy one, the capsule on the busiest
+// controller whose own message count best halves the difference is moved (UMLRTController::migrate).
+// At most one capsule is moved per period.
+
+class UMLRTControllerBalancer : public UMLRTBasicThread
+{
+public:
+    // Start the balancer thread. 'periodMsec' is the sampling period.
+    static void spawn ( uint32_t periodMsec );
+
+    virtual void * run ( void * args );
+
+private:
+    UMLRTControllerBalancer ( uint32_t periodMsec_ );
+
+    // Sample the controllers and move a capsule if they are out of balance.
+    void balance ( );
+
+    // Visit a controller's resident capsules, resetting their message counts and keeping track of
+    // the best candidate to move from 'busiest'.
+    void visitResidents ( const UMLRTController * controller, const UMLRTController * busiest, size_t target, size_t limit );
+
+    const uint32_t periodMsec;
+
+    // Controllers and their injected message counts at the previous sample.
+    UMLRTController * controllers[USER_CONFIG_BALANCER_MAX_CONTROLLERS];
+    size_t previous[USER_CONFIG_BALANCER_MAX_CONTROLLERS];
+    size_t numControllers;
+
+    // Best candidate found by visitResidents.
+    UMLRTSlot * candidate;
+    size_t candidateDistance;
+};
+
+#endif // UMLRTCONTROLLERBALANCER_HH
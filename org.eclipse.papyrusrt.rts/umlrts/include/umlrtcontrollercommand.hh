@@ -15,6 +15,7 @@
 #include <stdlib.h>
 
 class UMLRTCapsule;
+class UMLRTController;
 struct UMLRTSlot;
 
 struct UMLRTControllerCommand
@@ -28,20 +29,22 @@ struct UMLRTControllerCommand
         EXIT, // Normal exit of the controller.
         IMPORT, // Import a capsule into a slot.
         INCARNATE, // Incarnate a capsule into a slot i.e. initialize the dynamic capsule.
+        MIGRATE, // Move a slot to another controller.
     } Command;
 
     UMLRTControllerCommand ( ) :
-            command(UNDEFINED), capsule(NULL), isTopSlot(false), slot(NULL), userMsg(NULL), wait(NULL), exitValue(0) {}
+            command(UNDEFINED), capsule(NULL), isTopSlot(false), slot(NULL), userMsg(NULL), wait(NULL), exitValue(0), destination(NULL) {}
 
     Command command; // All commands.
 
     UMLRTCapsule * capsule; // DEPORT, IMPORT, INCARNATE
     bool isTopSlot; // DESTROY
     UMLRTSignal signal; // INCARNATE
-    UMLRTSlot * slot; // DEPORT, DESTROY, IMPORT
+    UMLRTSlot * slot; // DEPORT, DESTROY, IMPORT, MIGRATE
     const char * userMsg; // DEBUG_OUTPUT_MODEL
     UMLRTSemaphore * wait; // DESTROY
     void * exitValue; // ABORT, EXIT
+    UMLRTController * destination; // MIGRATE
 /*
 Command parameters:
 
@@ -76,6 +79,11 @@ INCARNATE
  - command
  - capsule
  - signal
+
+MIGRATE
+ - command
+ - slot
+ - destination
 */
 
 };
@@ -0,0 +1,138 @@
+// umlrtcontrollerpool.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTCONTROLLERPOOL_HH
+#define UMLRTCONTROLLERPOOL_HH
+
+#include <stddef.h>
+#include <stdint.h>
+#include "umlrtbasicthread.hh"
+#include "umlrtmutex.hh"
+#include "umlrtsemaphore.hh"
+
+class UMLRTController;
+
+// UMLRTControllerPool - optional execution mode in which controllers do not get a thread each.
+
+// Instead, each controller is a logical run-queue that is scheduled on a fixed pool of worker
+// threads. A controller becomes ready when a message or command is queued to it or one of its
+// timers expires. Each worker has its own deque of ready controllers: a worker services its
+// own deque first and, when that is empty, steals from the other workers' deques.
+
+// A controller is only ever run by one worker at a time, so all the capsules it contains keep
+// their run-to-completion guarantee and the controller's capsule queue remains single-threaded.
+// The unit of stealing is the controller: models with more controllers than cores are balanced
+// across the cores without hand-tuning the deployment map.
+
+// A worker that has to block waiting on another controller (e.g. destroying a capsule on a
+// different controller) notifies the pool, which adds a worker if none would be left to run
+// the other controllers.
+
+class UMLRTControllerPool
+{
+public:
+
+    // Start 'numWorkers' worker threads. Must be called before the controllers are spawned.
+    static void start ( int numWorkers );
+
+    // True if controllers are run by the pool.
+    static bool isEnabled ( );
+
+    // Add a controller to the pool (instead of starting a thread for it) and schedule it.
+    static void add ( UMLRTController * controller );
+
+    // Make a controller ready to run. Has no effect if it is already queued or is done.
+    static void schedule ( UMLRTController * controller );
+
+    // A timer was started. Idle workers re-evaluate how long they may sleep.
+    static void timerStarted ( );
+
+    // The controller being run by the calling thread - NULL if the calling thread is not a worker
+    // or the worker is between controllers.
+    static UMLRTController * current ( );
+
+    // Bracket an operation that blocks the calling worker waiting on another controller.
+    static void blockingBegin ( );
+    static void blockingEnd ( );
+
+private:
+
+    // Controller scheduling states (UMLRTController::poolState).
+    typedef enum {
+        IDLE,       // No work - not queued.
+        QUEUED,     // On a worker's deque.
+        RUNNING,    // Being run by a worker.
+        RERUN,      // Being run, and was scheduled again while running.
+        DONE,       // Exited or aborted.
+    } State;
+
+    class Worker : public UMLRTBasicThread
+    {
+    public:
+        Worker ( int index_, const char * name_ );
+
+        // Owner end of the deque.
+        void push ( UMLRTController * controller );
+        UMLRTController * pop ( );
+
+        // Thief end of the deque.
+        UMLRTController * steal ( );
+
+        virtual void * run ( void * args );
+
+        const int index;
+
+    private:
+        Worker ( );
+
+        // Intrusive list of ready controllers (linked through UMLRTController::poolNext/poolPrev).
+        UMLRTMutex mutex;
+        UMLRTController * head;
+        UMLRTController * tail;
+    };
+
+    // Add a worker thread. Returns false if the maximum number of workers are running.
+    static bool addWorker ( );
+
+    // Find a ready controller - from the worker's own deque first, then by stealing.
+    static UMLRTController * findWork ( Worker * worker );
+
+    // Run one pass of a controller and reschedule it if it still has work.
+    static void execute ( Worker * worker, UMLRTController * controller );
+
+    // Schedule idle controllers whose first timer has expired. Returns the number scheduled and
+    // sets 'msec' to how long an idle worker may sleep before the next timer expires.
+    static int checkTimers ( uint32_t * msec );
+
+    // All controllers have finished - let the workers exit.
+    static void stop ( );
+
+    static Worker * workers[];
+    static volatile int numWorkers;
+    static UMLRTMutex workersMutex;
+
+    // All controllers in the pool (for timer checks).
+    static UMLRTController * * controllers;
+    static size_t numControllers;
+    static size_t maxControllers;
+    static UMLRTMutex controllersMutex;
+
+    // Controllers that have not finished.
+    static volatile int liveControllers;
+
+    // Idle workers sleep on this semaphore.
+    static UMLRTSemaphore wakeup;
+    static volatile int idleWorkers;
+    static volatile int blockedWorkers;
+    static volatile unsigned int nextWorker;
+    static volatile bool stopping;
+};
+
+#endif // UMLRTCONTROLLERPOOL_HH
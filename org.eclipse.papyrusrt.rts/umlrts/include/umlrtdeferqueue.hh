@@ -0,0 +1,85 @@
+// umlrtdeferqueue.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTDEFERQUEUE_HH
+#define UMLRTDEFERQUEUE_HH
+
+#include <stdlib.h>
+#include "umlrtmutex.hh"
+#include "umlrtqueue.hh"
+
+class UMLRTMessage;
+
+// UMLRTDeferQueue - the deferred messages of a port.
+
+// Messages are kept in the order they were deferred on one port-wide list and, in the same
+// order, on a list per far-end index (bucket). Purge and recall for a single port instance
+// only visit that instance's bucket. Both lists are doubly-linked so a message is removed
+// from the other list without searching it.
+
+// Messages with a far-end index beyond the number of buckets share the last bucket.
+
+class UMLRTDeferQueue
+{
+public:
+    typedef void (*match_notify_t) ( UMLRTMessage * msg, void * userData );
+
+    // Create an empty queue with a bucket for each of 'numFarEnd' port instances.
+    UMLRTDeferQueue ( size_t numFarEnd );
+
+    // As above, but the buckets are kept in 'bucketStorage' (of #bucketStorageSize bytes) owned by the caller.
+    UMLRTDeferQueue ( size_t numFarEnd, void * bucketStorage );
+    ~UMLRTDeferQueue ( );
+
+    static size_t bucketStorageSize ( size_t numFarEnd ) { return ((numFarEnd > 0) ? numFarEnd : 1) * sizeof(Bucket); }
+
+    // Append a deferred message.
+    void enqueue ( UMLRTMessage * msg );
+
+    bool isEmpty ( ) const { return head == NULL; }
+
+    size_t count ( ) const { return _count; }
+
+    // Remove messages deferred on far-end 'index' (-1 for all instances) with signal 'id' (-1 for all signals)
+    // in the order they were deferred, calling 'notify' for each. If 'one' is true, only the first match is removed.
+    // Return count of messages removed.
+    int remove ( int index, int id, bool one, match_notify_t notify, void * userData );
+
+    // Walk the messages in the order they were deferred, calling the callback. Abort if the callback returns true.
+    // Return number of messages walked.
+    int walk ( UMLRTQueue::walk_callback_t callback, void * userData ) const;
+
+private:
+    struct Bucket
+    {
+        UMLRTMessage * head;
+        UMLRTMessage * tail;
+    };
+
+    Bucket & bucket ( size_t index ) const { return buckets[(index < numBuckets) ? index : numBuckets - 1]; }
+
+    // Unlink a message from both lists.
+    void unlink ( UMLRTMessage * msg );
+
+    void initBuckets ( );
+
+    Bucket * buckets;
+    size_t numBuckets;
+    bool ownBuckets;
+
+    // Port-wide list. Linked through UMLRTQueueElement::next and UMLRTMessage::deferPrev.
+    UMLRTMessage * head;
+    UMLRTMessage * tail;
+    size_t _count;
+
+    mutable UMLRTMutex mutex;
+};
+
+#endif // UMLRTDEFERQUEUE_HH
@@ -15,6 +15,7 @@ class UMLRTCapsule;
 class UMLRTController;
 struct UMLRTSlot;
 struct UMLRTHost;
+struct UMLRTThreadAttributes;
 
 class UMLRTDeploymentMap
 {
@@ -49,6 +50,9 @@ public:
     // Join all controller's threads
     static void joinAllControllers ( );
 
+    // Fill an array with the controllers on this host. Returns the number of controllers (which may exceed 'max').
+    static size_t getControllers ( UMLRTController * controllers[], size_t max );
+
     // Return the controller for a given name. Returns NULL if the controller is not found.
     static UMLRTController * getControllerFromName ( const char * controllerName );
 
@@ -70,6 +74,9 @@ public:
     // Return the host where this capsule is running. Returns NULL if no host is assigned or doesn't exist.
     static UMLRTHost * getHostForCapsule ( const char * capsuleName );
 
+    // Return the thread attributes defined for a controller. Returns NULL if none were defined.
+    static const UMLRTThreadAttributes * getControllerAttributes ( const char * controllerName );
+
     // Return the host assigned to this controller. Returns NULL if no controller is assigned or doesn't exist.
     static UMLRTHost * getHostForController ( const char * controllerName );
 
@@ -99,9 +106,11 @@ public:
 
     static bool fromFile( const char* fileName );
 
+    // Validate the JSON deployment map and load it. Fatal error if it is invalid.
     static void decode( const char * json  );
 
-    static const char * encode( );
+    // Encode the part of the map needed by 'receiver' (and the hosts it deploys). The caller frees the result.
+    static char * encode( const UMLRTHost * receiver );
 
     static bool isLoaded( );
 
@@ -130,16 +139,21 @@ private:
     // Parse an individual host line.
     static bool parseHostLine ( char * line );
 
+    // Define the thread attributes of a controller.
+    static void setControllerAttributes ( const char * controllerName, const UMLRTThreadAttributes & attributes );
+
     static UMLRTHashMap * getControllerNameMap ( );
     static UMLRTHashMap * getCapsuleNameMap ( );
     static UMLRTHashMap * getHostNameMap ( );
     static UMLRTHashMap * getSlotNameMap ( );
     static UMLRTHashMap * getCapsuleToControllerMap ( );
     static UMLRTHashMap * getControllerToHostMap ( );
+    static UMLRTHashMap * getControllerAttributesMap ( );
 
     static UMLRTHashMap * controllerNameMap;
     static UMLRTHashMap * capsuleToControllerMap;
     static UMLRTHashMap * controllerToHostMap;
+    static UMLRTHashMap * controllerAttributesMap;
     static UMLRTHashMap * capsuleNameMap;
     static UMLRTHashMap * hostNameMap;
     static UMLRTHashMap * slotNameMap;
@@ -147,7 +161,7 @@ private:
     static int numDefaultSlotList;
     static UMLRTSlot * defaultSlotList;
 
-    static const char * payload;
+    static char * payload; // The decoded map, parsed in-situ. The map entries point into it.
 };
 
 #endif // UMLRTDEPLOYMENTMAP_HH
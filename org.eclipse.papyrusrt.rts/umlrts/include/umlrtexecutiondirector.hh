@@ -23,6 +23,10 @@ public:
 	static void init ( const char * localaddr );
     static bool sendSignal ( const UMLRTCommsPort * destPort, const UMLRTSignal &signal, size_t srcPortIndex );
 
+    // Send the signal to all remote far ends of its source port. The payload is encoded once and each
+    // remote host receives a single frame listing its destinations. Returns true if anything was sent.
+    static bool sendSignalAll ( const UMLRTSignal &signal );
+
     static void spawn ( );
     static void join ( );
 private:
@@ -42,6 +46,12 @@ private:
     void joinThread ( );
     void deploy ( );
 
+    static UMLRTCommunicator::Message * newMessage ( UMLRTHost * destHost, const UMLRTSignal &signal, const std::string &json );
+    static void addDestination ( UMLRTCommunicator::Message * msg, const UMLRTCommsPort * destPort, size_t srcPortIndex );
+
+    // Queue a frame for sending, applying the link policy of the port it was sent from. False if refused.
+    static bool queueFrame ( UMLRTCommunicator::Message * msg, const UMLRTCommsPort * srcPort );
+
     void * runLocal ( void * args );
 
     // Main loop
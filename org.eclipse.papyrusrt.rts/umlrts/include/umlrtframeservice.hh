@@ -22,8 +22,11 @@ struct UMLRTSlot;
 struct UMLRTCapsulePart;
 struct UMLRTCapsuleRole;
 struct UMLRTCommsPort;
+struct UMLRTCommsPortFarEnd;
 struct UMLRTCommsPortRole;
 class UMLRTController;
+class UMLRTDeferQueue;
+class UMLRTFreeSlots;
 struct UMLRTObject_class;
 struct UMLRTTypedValue;
 
@@ -62,9 +65,6 @@ public:
     // Count the number of free far-ends on a port.
     static size_t freeFarEndsCount ( const UMLRTCommsPort * port );
 
-    // Create a port list - either slot ports, port map or internal ports. No ports are connected yet.
-    static const UMLRTCommsPort * createPortArray ( UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass );
-
     static const UMLRTCommsPort * * createInternalPorts ( UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass );
 
     // Create the trivial border port list from the slot ports.
@@ -114,6 +114,8 @@ public:
     static void sendBoundUnboundForPortIndex( const UMLRTCommsPort * port, int index, bool isBind );
 
 private:
+    friend class UMLRTSubstructure;
+
     // Define (or augment) a capsule border port list (during incarnate or import) by mapping requested class with the slot class.
     // If 'bind' param is false, just check. If 'bind' param is true, perform the binding.
     static const UMLRTCommsPort * * bindPorts ( UMLRTSlot * slot, UMLRTCapsule * capsule, const UMLRTCapsuleClass * requestedClass,
@@ -134,36 +136,25 @@ private:
     // Call capsule #disconnect methods for this deport.
     static void controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCommsPort * * borderPorts );
 
-    // Create a capsule name based on parent. Using when constructing slots.
-    static char * createName ( const char * prefix, const char * suffix, size_t index, bool appendIndex );
-
-    // Recurse and create the sub-structure of a slot.
-    static UMLRTCapsulePart * createParts ( const char * containerName, const UMLRTCapsuleClass * containerClass);
-
     // Create a single port.
     static const UMLRTCommsPort * createPort ( UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass, int roleIndex,
             bool border, bool importProxy = false, bool isUnbound = false );
 
-    // Define port contents.
+    // Define port contents. The far-end list and defer queue are allocated unless supplied (see UMLRTSubstructure).
     static void definePort ( UMLRTCommsPort * port, UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass, int roleIndex,
-            bool border, bool importProxy = false, bool isUnbound = false );
+            bool border, bool importProxy = false, bool isUnbound = false,
+            UMLRTCommsPortFarEnd * farEnds = NULL, UMLRTDeferQueue * deferQueue = NULL );
 
     // Recurse into sub-structure assigning controllers to capsules.
     static void defineSlotControllers ( UMLRTSlot * slot, const UMLRTCapsulePart * part, const UMLRTCapsuleClass * capsuleClass,
             const char * logThread, UMLRTController * assignedController, UMLRTController * defaultController, int index );
 
-    // Destroy the parts book-keeping within a slot. Doesn't destroy the parts themselves (controllerRequestDestroy used to destroy parts).
-    static void destroyPartsBookkeeping ( size_t numParts, const UMLRTCapsulePart * parts );
-
     // Recurse into sub-structure deporting any slots that require deporting.
     static void deportParts ( UMLRTSlot * slot );
 
     // Destroy a port's contents. Optionally delete the port itself.
     static void destroyPort ( const UMLRTCommsPort * port, bool deletePort );
 
-    // Destroy a port array. Called when destroying slot ports.
-    static void destroyPortArray ( const UMLRTCommsPort * ports, size_t numPorts );
-
     // Destroy a port list. Called when destroying capsule border ports.
     static void destroyPortList ( const UMLRTCommsPort * * ports, size_t numPorts, bool proxiesOnly );
 
@@ -173,12 +164,27 @@ private:
     // Obtain the controller for this capsule based on a list of rules for assigning controllers
     static UMLRTController * getCapsuleController ( const UMLRTSlot * slot, const UMLRTCapsulePart * part, const char * logThread, UMLRTController * assignedController, UMLRTController * defaultController, int slotIndex );
 
+    // The free slots of an optional or plugin part.
+    static UMLRTFreeSlots * getFreeSlots ( const UMLRTCapsulePart * part );
+
     // If user doesn't explicitly specify the slot index, we get the next free slot-index available.
     static int getNextFreeCapsuleSlot ( const UMLRTCapsulePart * part );
 
+    // Record in its part's free slots that 'slot' has gained or lost its capsule instance.
+    static void occupySlot ( UMLRTSlot * slot );
+    static void vacateSlot ( UMLRTSlot * slot );
+
     // Send rtBound to far-ends of slot not associated with relay ports.
     static void incarnateSendBoundSlotFarEnd ( UMLRTSlot * slot );
 
+    // Incarnate, first phase: choose and reserve the slot. NULL (with the error set) if there is none.
+    static UMLRTSlot * incarnateReserveSlot ( const UMLRTCommsPort * srcPort, const UMLRTCapsulePart * part, int & index );
+
+    // Incarnate, last phase: bind the slot ports, publish the prepared 'parts' and instantiate the capsule.
+    static UMLRTCapsuleId incarnatePublish ( const UMLRTCommsPort * srcPort, const UMLRTCapsulePart * part, UMLRTSlot * slot,
+            const UMLRTCapsuleClass * capsuleClass, UMLRTCapsulePart * parts, UMLRTController * controller,
+            const void * userData, const UMLRTObject_class * type );
+
     // Initialize ports, including registration of service ports for a given capsule.
     static void initializeCapsulePorts ( UMLRTCapsule * capsule );
 
@@ -0,0 +1,61 @@
+// umlrtfreeslots.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTFREESLOTS_HH
+#define UMLRTFREESLOTS_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+// UMLRTFreeSlots - the unoccupied slots of an optional or plugin part.
+
+// Incarnate and import without an explicit index take the lowest free slot. This is a two-level
+// bitmap - a bit per slot, and a summary bit per bitmap word with any free slot - so finding it
+// reads one summary word and one bitmap word for parts of up to 4096 slots,
+// rather than visiting every occupied slot before it.
+
+// Only the frame service uses it, with the global RTS lock held.
+
+class UMLRTFreeSlots
+{
+public:
+    // Track 'numSlot' slots, all free.
+    UMLRTFreeSlots ( size_t numSlot );
+
+    // As above, but the bitmaps are kept in 'storage' (of #storageSize bytes) owned by the caller.
+    UMLRTFreeSlots ( size_t numSlot, void * storage );
+    ~UMLRTFreeSlots ( );
+
+    static size_t storageSize ( size_t numSlot );
+
+    // The lowest free slot index, or -1 if every slot is occupied.
+    int first ( ) const;
+
+    bool isFree ( size_t index ) const { return (index < numSlot) && ((words[index / WORD_BITS] >> (index % WORD_BITS)) & 1); }
+
+    void occupy ( size_t index );
+    void vacate ( size_t index );
+
+private:
+    typedef uint64_t word_t;
+
+    enum { WORD_BITS = sizeof(word_t) * 8 };
+
+    static size_t wordsFor ( size_t bits ) { return (bits + WORD_BITS - 1) / WORD_BITS; }
+
+    void init ( );
+
+    size_t numSlot;
+    word_t * words;     // A bit set for each free slot.
+    word_t * summary;   // A bit set for each word of 'words' that is not zero.
+    bool ownStorage;
+};
+
+#endif // UMLRTFREESLOTS_HH
@@ -54,6 +54,10 @@ public:
     bool isEmpty ( ) const { return mapSize == 0; }
     void insert ( const void * key, void * object ); // O(n) insert
 
+    // Insert 'count' new entries in one O((n + count) log (n + count)) pass - for loading a large map at once.
+    // Returns NULL on success. If a key occurs twice (or is already in the map) nothing is inserted and that key is returned.
+    const void * insertAll ( const void * const keys[], void * const objects[], int count );
+
     void * getFirstObject ( ) const;
     Iterator getIterator ( ) const; // Return an iterator to traverse map.
     // WARNING: traversing a map with an Iterator is not thread-safe.
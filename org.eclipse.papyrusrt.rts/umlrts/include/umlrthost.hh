@@ -9,6 +9,7 @@
 
 #include "basedebug.hh"
 #include "umlrtdeploymentmap.hh"
+#include <stdint.h>
 #include <string.h>
 
 // This is the data container for information the RTS needs about each host
@@ -23,6 +24,19 @@ public:
         signaled = false;
         goSignaled = false;
         gotack = false;
+        compress = false;
+        framesSent = 0;
+        framesCompressed = 0;
+        bytesBeforeCompression = 0;
+        bytesAfterCompression = 0;
+        compressNsec = 0;
+        framesDecompressed = 0;
+        decompressNsec = 0;
+        queued = 0;
+        congested = false;
+        framesRefused = 0;
+        framesDropped = 0;
+        sendsBlocked = 0;
 	}
 
 	~UMLRTHost ( ) {
@@ -39,6 +53,23 @@ public:
     bool signaled;
     bool goSignaled;
     bool gotack;
+    bool compress; // True if both ends of the link agreed to compress large payloads.
+
+    // Link statistics (see UMLRTDeploymentMap::debugOutputHostList).
+    uint64_t framesSent;
+    uint64_t framesCompressed;
+    uint64_t bytesBeforeCompression; // Payload bytes of the compressed frames.
+    uint64_t bytesAfterCompression;
+    uint64_t compressNsec;
+    uint64_t framesDecompressed;
+    uint64_t decompressNsec;
+
+    // Link flow control (see UMLRTCommunicator::queueMessage). Guarded by the communicator.
+    size_t queued;      // Frames queued for the host and not yet sent - the link credit in use.
+    bool congested;     // Reached the high water mark and has not drained to the low water mark since.
+    uint64_t framesRefused;
+    uint64_t framesDropped;
+    uint64_t sendsBlocked;
 };
 
 #endif // UMLRTHOST_HH
@@ -0,0 +1,81 @@
+// umlrtinvoke.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTINVOKE_HH
+#define UMLRTINVOKE_HH
+
+#include <stddef.h>
+
+class UMLRTMessage;
+class UMLRTMutex;
+class UMLRTSemaphore;
+class UMLRTSignal;
+struct UMLRTCommsPort;
+
+// UMLRTInvoke - synchronous invoke and reply (see UMLRTOutSignal::invokeAt and UMLRTOutSignal::reply).
+
+// An invoke of a capsule run by the invoker's own controller does not queue a message at all. The
+// message is built on the invoker's stack and injected directly into the destination capsule,
+// which may reply before the invoke returns. Invoking a capsule that is already in the middle of
+// a transition on this thread (the invoker itself, or one of the invokers further up the stack)
+// fails with E_INVOKE_REENTRANT.
+
+// An invoke of a capsule run by another controller queues one message at synchronous priority and
+// blocks the invoker on a reply slot of its own thread until the destination has handled it, or
+// until USER_CONFIG_INVOKE_TIMEOUT_MSEC expires. The reply is copied straight into the invoker's
+// reply message. Each invoke bumps the slot's generation, so a reply or completion arriving after
+// a timeout is recognized and ignored. Invoking a capsule on another host is not supported.
+
+// The destination capsule's controller is blocked for the duration of a same-controller invoke,
+// and the invoker's for a cross-controller one - two controllers invoking each other wait until
+// one of them times out.
+
+class UMLRTInvoke
+{
+public:
+    // Invoke 'signal' through far end 'index' of its source port. Returns the number of replies
+    // (0 or 1) copied to 'replyMsg'. Sets the source controller's error on failure.
+    static int invokeAt ( const UMLRTSignal & signal, int index, UMLRTMessage * replyMsg );
+
+    // Reply with 'signal' to the invoke its source port's capsule is handling. Return true if success.
+    static bool reply ( const UMLRTSignal & signal );
+
+    // A queued invoke message is being returned to the pool - injected, dropped or purged. Wakes the invoker.
+    static void complete ( const UMLRTMessage * msg );
+
+private:
+    UMLRTInvoke ( );
+
+    // This thread's reply slot for cross-controller invokes. Never freed - a late reply may still refer to it.
+    static UMLRTInvoke * getThreadSlot ( );
+
+    // True if the capsule of 'destPort' is mid-transition on this thread.
+    static bool isReentrant ( const UMLRTCommsPort * srcPort, const UMLRTCommsPort * destPort );
+
+    static int invokeLocal ( const UMLRTSignal & signal, const UMLRTCommsPort * srcPort, int index, UMLRTMessage * replyMsg );
+    static int invokeQueued ( const UMLRTSignal & signal, const UMLRTCommsPort * srcPort, int index, UMLRTMessage * replyMsg );
+
+    // Copy the reply 'signal' to the invoke 'msg' into the reply message. False if already replied.
+    bool store ( const UMLRTMessage * msg, const UMLRTSignal & signal );
+
+    const UMLRTCommsPort * srcPort; // Invoker's port.
+    size_t srcPortIndex;
+    UMLRTMessage * replyMsg;
+    int numReply;
+    size_t generation;
+    bool pending;           // A queued invoke has not completed yet.
+    UMLRTInvoke * outer;    // Enclosing same-controller invoke on this thread.
+
+    // Only for the thread's reply slot - NULL on a same-controller invoke.
+    UMLRTMutex * mutex;
+    UMLRTSemaphore * done;
+};
+
+#endif // UMLRTINVOKE_HH
@@ -0,0 +1,103 @@
+// umlrtjsonreader.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTJSONREADER_HH
+#define UMLRTJSONREADER_HH
+
+#include "umlrtobjectclass.hh"
+#include <rapidjson/reader.h>
+
+// UMLRTJsonReader - decode a typed value straight from SAX events.
+
+// The value is read in the form written by UMLRTObject_class::toJson - an object with
+// "type" and "value" members (and an optional "name", which is ignored) - and stored
+// directly into its destination, without building a DOM. Used with in-situ parsing
+// (kParseInsituFlag) strings are not copied either.
+
+// The handler parsing the enclosing document calls begin() when a typed value is
+// expected, then forwards each event - starting with the StartObject that opens the
+// value - until isDone() returns true.
+
+class UMLRTJsonReader
+{
+public:
+    UMLRTJsonReader ( ) : depth(0), done(true) { }
+
+    // Read an array of 'arraySize' elements of type 'desc' into 'dst'.
+    void begin ( const UMLRTObject_class * desc, void * dst, int arraySize );
+
+    // True once the typed value's object has been closed.
+    bool isDone ( ) const { return done; }
+
+    // SAX handler events. Each returns false if the input does not match the type being read.
+    bool Null ( );
+    bool Bool ( bool b );
+    bool Int ( int i );
+    bool Uint ( unsigned u );
+    bool Int64 ( int64_t i );
+    bool Uint64 ( uint64_t u );
+    bool Double ( double d );
+    bool RawNumber ( const char * str, SizeType length, bool copy ) { return false; }
+    bool String ( const char * str, SizeType length, bool copy );
+    bool StartObject ( );
+    bool Key ( const char * str, SizeType length, bool copy );
+    bool EndObject ( SizeType memberCount );
+    bool StartArray ( );
+    bool EndArray ( SizeType elementCount );
+
+    // One JSON scalar, before it is converted to the primitive type being read.
+    struct Scalar
+    {
+        enum Kind { NUL, BOOL, INT, UINT, REAL, STRING };
+
+        Kind kind;
+        bool b;
+        int64_t i;      // INT - negative integers only.
+        uint64_t u;     // UINT - non-negative integers.
+        double d;
+        const char * str;
+        SizeType length;
+    };
+
+private:
+    // One typed value being read. Nested composite fields push a frame each.
+    struct Frame
+    {
+        enum State
+        {
+            OBJECT,     // Expecting the StartObject of the typed value.
+            MEMBER,     // Expecting a member name or EndObject.
+            SKIP,       // Expecting the string value of "type" or "name".
+            VALUE,      // Expecting the StartArray of "value".
+            PRIMITIVES, // In "value" of a primitive type - one scalar per element.
+            ELEMENTS,   // In "value" of a composite type - one array of fields per element.
+            FIELDS      // In the field array of one element - one typed value per field.
+        };
+
+        const UMLRTObject_class * desc;
+        uint8_t * dst;
+        int arraySize;
+        State state;
+        int element;    // Index of the element being read.
+        size_t field;   // Index of the field being read (FIELDS).
+        bool gotValue;
+    };
+
+    enum { MAX_NEST = 32 };
+
+    bool scalar ( const Scalar & s );
+    bool push ( const UMLRTObject_class * desc, void * dst, int arraySize );
+
+    Frame stack[MAX_NEST];
+    int depth;
+    bool done;
+};
+
+#endif // UMLRTJSONREADER_HH
@@ -0,0 +1,28 @@
+// umlrtlinkpolicy.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTLINKPOLICY_HH
+#define UMLRTLINKPOLICY_HH
+
+#include <stdint.h>
+
+// What a send from a port does when the link to the destination host has run out of credit
+// (see UMLRTCommunicator::queueMessage).
+
+enum
+{
+    LINK_POLICY_ERROR = 0,  // Fail the send with E_SEND_LINK_FULL.
+    LINK_POLICY_BLOCK,      // Wait for the link to drain (up to USER_CONFIG_LINK_BLOCK_MSEC), then fail.
+    LINK_POLICY_DROP,       // Discard the signal. The send succeeds.
+    LINK_POLICY_MAXPLUS1
+};
+typedef uint8_t UMLRTLinkPolicy;
+
+#endif // UMLRTLINKPOLICY_HH
@@ -17,14 +17,18 @@
 
 struct UMLRTObject_class;
 struct UMLRTTypedValue;
+class UMLRTMappedFile;
 
 // Protocol for log ports.
 
+// When the asynchronous log writer is running (see umlrtlogwriter.hh), output is formatted
+// by the calling thread and queued for the writer thread rather than written directly.
+
 class UMLRTLogProtocol_baserole
 {
 public:
 
-    UMLRTLogProtocol_baserole ( ) : ostream(stderr), isOpenFile(false) { }
+    UMLRTLogProtocol_baserole ( ) : ostream(stderr), isOpenFile(false), mappedFile(NULL) { }
 
     // Output data with the new-line appended.
     int log ( const char * fmt, ... ) const;
@@ -82,6 +86,7 @@ public:
     // Redirect to a file by name. The RTS library is responsible for opening and closing the stream
     // associated with the file. (The current version of the library will open the file when this
     // method is called and only close the file when output is redirected to a different destination.
+    // If the log writer was started with memory-mapped files enabled, the file is memory-mapped.
     bool redirect ( const char * fname ) const;
 
     // stdout and stderr are protected by a mutex to avoid individual log calls from clobbering
@@ -92,12 +97,28 @@ public:
 
 private:
 
+    // Format and output. The formatted output is a single record when output is asynchronous.
+    int write ( const char * fmt, ... ) const;
+    int vwrite ( const char * fmt, va_list ap, bool newline ) const;
+
+    // Output a prefix followed by 'count' copies of a character.
+    int repeat ( const char * prefix, char c, int count ) const;
+
+    // Output formatted data - queued to the log writer if it is running.
+    int output ( const char * data, size_t length ) const;
+
+    // Close the file opened via redirect(fname), if any.
+    void closeFile ( ) const;
+
     // Output streams to direct log output.
     mutable FILE * ostream;
 
     // True if ostream is a file and needs to be closed if output is re-directed.
     mutable bool isOpenFile;
 
+    // Memory-mapped file opened via redirect(fname) when mapped log files are enabled.
+    mutable UMLRTMappedFile * mappedFile;
+
     // We avoid concurrent writes from multiple threads to stdout and stderr and the application
     // must handle mutual exclusion for writes to other streams.
     static UMLRTMutex stdoutMutex;
@@ -0,0 +1,153 @@
+// umlrtlogwriter.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTLOGWRITER_HH
+#define UMLRTLOGWRITER_HH
+
+#include <stdio.h>
+#include <stddef.h>
+#include "umlrtbasicthread.hh"
+#include "umlrtmutex.hh"
+#include "umlrtsemaphore.hh"
+
+class UMLRTMappedFile;
+
+// UMLRTLogWriter moves log port output off the controller threads.
+
+// Once started, each thread that logs gets its own single-producer/single-consumer ring
+// buffer. Formatted records are copied into the calling thread's buffer without taking
+// any lock and a single writer thread drains all buffers to their destination streams
+// (or memory-mapped files). When a buffer is full, the record is either dropped (and
+// counted) or the producer waits for the writer to make room - depending on the policy.
+
+// Records from one thread are written in order. Records from different threads are
+// interleaved at record granularity.
+
+class UMLRTLogWriter : public UMLRTBasicThread
+{
+public:
+
+    typedef enum {
+        POLICY_DROP,  // Discard records that do not fit in the buffer.
+        POLICY_BLOCK, // Wait for the writer thread to make room.
+    } Policy;
+
+    // Start the writer thread. 'bufferSize' is rounded up to a power of 2. The writer is
+    // shut down automatically when the process exits.
+    static void spawn ( Policy policy, size_t bufferSize, bool useMappedFiles );
+
+    // Write out all pending records and stop the writer thread.
+    static void shutdown ( );
+
+    static bool isRunning ( );
+
+    // True if log ports should redirect to memory-mapped files.
+    static bool useMappedFiles ( );
+
+    // Queue a record for output to 'ostream' (or 'mapped' when not NULL). Returns the number of
+    // bytes queued - zero if the record was dropped, -1 if the writer has been shut down.
+    static int submit ( FILE * ostream, UMLRTMappedFile * mapped, const char * data, size_t length );
+
+    // Wait until every record queued (by any thread) before this call has been written.
+    static void flush ( );
+
+    // Mapped files opened by log ports are registered so they can be closed (and truncated to
+    // their written length) when the writer is shut down.
+    static void addMappedFile ( UMLRTMappedFile * mapped );
+    static void removeMappedFile ( UMLRTMappedFile * mapped );
+
+    // Number of records dropped because a buffer was full.
+    static size_t getDropCount ( );
+
+    virtual ~UMLRTLogWriter ( );
+
+private:
+
+    UMLRTLogWriter ( );
+
+    // Per-thread ring buffer. 'head' is only written by the writer thread and 'tail' only by
+    // the owning thread. Both increase monotonically and are masked when indexing 'data'.
+    typedef struct Buffer
+    {
+        char * data;
+        size_t mask;
+        volatile size_t head;
+        volatile size_t tail;
+        struct Buffer * next;
+
+    } Buffer;
+
+    // Record header - followed in the buffer by 'length' bytes of data.
+    typedef struct
+    {
+        FILE * ostream;
+        UMLRTMappedFile * mapped;
+        size_t length;
+
+    } RecordHeader;
+
+    // Copy a record into the calling thread's buffer (see #submit).
+    static int queue ( FILE * ostream, UMLRTMappedFile * mapped, const char * data, size_t length );
+
+    // Return the calling thread's buffer, creating it on first use.
+    static Buffer * getThreadBuffer ( );
+
+    static void copyIn ( Buffer * buffer, size_t pos, const void * src, size_t length );
+    static void copyOut ( const Buffer * buffer, size_t pos, void * dest, size_t length );
+
+    // Write out the pending records of one buffer. Returns the number of records written.
+    static int drain ( Buffer * buffer );
+
+    // Write out the pending records of all buffers. Returns the number of records written.
+    static int drainAll ( );
+
+    // Wait for the writer thread to complete a drain pass.
+    static void waitForDrain ( );
+
+    static void atExit ( );
+
+    virtual void * run ( void * args );
+
+    static UMLRTLogWriter * instance;
+
+    // All thread buffers. Buffers are pushed with compare-and-swap and live until the process exits.
+    static Buffer * volatile buffers;
+
+    typedef struct MappedFileEntry
+    {
+        UMLRTMappedFile * mapped;
+        struct MappedFileEntry * next;
+
+    } MappedFileEntry;
+
+    static MappedFileEntry * mappedFileList;
+    static UMLRTMutex mappedFileListMutex;
+
+    static Policy policy;
+    static size_t bufferSize;
+    static bool mappedFiles;
+
+    static volatile bool running;
+    static volatile bool stopping;
+
+    // Threads inside #submit, plus SUBMIT_CLOSED once #shutdown has begun - no record is queued after that.
+    static volatile int submitters;
+    enum { SUBMIT_CLOSED = 0x40000000 };
+    static volatile size_t dropCount;
+
+    // Writer wakes up when posted or after USER_CONFIG_LOG_FLUSH_MSEC.
+    static UMLRTSemaphore wakeup;
+
+    // Posted by the writer after a drain pass for each thread waiting in #waitForDrain.
+    static UMLRTSemaphore drained;
+    static volatile int drainWaiters;
+};
+
+#endif // UMLRTLOGWRITER_HH
@@ -0,0 +1,58 @@
+// umlrtmappedfile.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTMAPPEDFILE_HH
+#define UMLRTMAPPEDFILE_HH
+
+#include <stddef.h>
+
+// UMLRTMappedFile is a platform-independent, append-only, memory-mapped output file.
+
+// Writes are copied directly into the mapping and the mapping is extended as the file
+// grows. The file is truncated to the number of bytes actually written when it is closed.
+// The class is not thread-safe - it is only written to by the log writer thread.
+
+typedef void * osmappedfile_t;
+
+class UMLRTMappedFile
+{
+public:
+    UMLRTMappedFile ( );
+
+    ~UMLRTMappedFile ( );
+
+    // Create (truncate) the file and map 'initialSize' bytes of it. Returns false if error.
+    bool open ( const char * fname, size_t initialSize );
+
+    // Append data to the file. Returns the number of bytes written.
+    size_t write ( const void * data, size_t size );
+
+    // Schedule write-back of the data written so far.
+    void sync ( );
+
+    // Unmap and close the file.
+    void close ( );
+
+    bool isOpen ( ) const { return file != NULL; }
+
+    size_t length ( ) const { return written; }
+
+private:
+    // Extend the mapping so it can hold at least 'required' bytes.
+    bool grow ( size_t required );
+
+    osmappedfile_t file;
+
+    char * base;
+    size_t mapped;
+    size_t written;
+};
+
+#endif // UMLRTMAPPEDFILE_HH
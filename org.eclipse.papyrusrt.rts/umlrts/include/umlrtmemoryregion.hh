@@ -0,0 +1,52 @@
+// umlrtmemoryregion.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTMEMORYREGION_HH
+#define UMLRTMEMORYREGION_HH
+
+#include <stddef.h>
+
+// UMLRTMemoryRegion is a platform-independent allocator of contiguous, pre-faulted memory.
+
+// A region is mapped directly from the OS and every page of it is faulted in before it is
+// returned, so the first use of the memory never takes a page fault. Regions are never released -
+// they back the free pools, which only grow.
+
+// Huge pages are best effort: a BACKING_HUGE request falls back to BACKING_THP when no huge pages
+// are reserved, and BACKING_THP falls back to BACKING_PAGES where transparent huge pages are not
+// supported.
+
+class UMLRTMemoryRegion
+{
+public:
+    enum Backing
+    {
+        BACKING_PAGES,  // Default-size pages.
+        BACKING_THP,    // Default-size pages the OS is advised to merge into transparent huge pages.
+        BACKING_HUGE,   // Explicitly reserved huge pages.
+        BACKING_MAXPLUS1
+    };
+
+    // Allocate at least 'size' bytes of zeroed memory with 'backing'. On return, 'size' holds the
+    // size actually mapped (rounded up to the page size used) and 'backing' the backing actually
+    // used. Returns NULL if error.
+    static void * allocate ( size_t & size, Backing & backing );
+
+    // The page size the region allocator rounds to for 'backing'.
+    static size_t pageSize ( Backing backing );
+
+    // Name of 'backing' - "pages", "thp" or "huge".
+    static const char * backingName ( Backing backing );
+
+    // Parse a backing name. Returns false if not recognized.
+    static bool parseBacking ( const char * name, Backing & backing );
+};
+
+#endif // UMLRTMEMORYREGION_HH
@@ -13,8 +13,10 @@
 
 #include "umlrtqueueelement.hh"
 #include "umlrtsignal.hh"
+#include "osutil.hh"
 
 struct UMLRTCommsPort;
+class UMLRTInvoke;
 class UMLRTSignal;
 struct UMLRTSlot;
 
@@ -30,20 +32,35 @@ struct UMLRTSlot;
 // Signals are separated from messages so that one signal can reside in
 // multiple messages (to support broadcast operations).
 
-class UMLRTMessage : public UMLRTQueueElement
+// A message is written by the sending thread and then by the receiving controller, so each one
+// starts on its own cache line - adjacent pool messages handled by different controllers never
+// share one. The fields read to deliver the message fill the first line; the flags fit in the
+// padding after the queue element.
+
+class OS_CACHE_ALIGNED UMLRTMessage : public UMLRTQueueElement
 {
 public:
 
-    UMLRTMessage ( ) : allocated(false), destPort(NULL), destSlot(NULL), isCommand(false), sapIndex0_(0), srcPortIndex(0) { };
+    UMLRTMessage ( ) : allocated(false), isCommand(false), destPort(NULL), destSlot(NULL), sapIndex0_(0), srcPortIndex(0),
+            deferPrev(NULL), deferIndexNext(NULL), deferIndexPrev(NULL), invoke(NULL), invokeGeneration(0) { };
 
     bool allocated;   // For sanity checking of message allocation.
+    bool isCommand;   // true when it's a command and not a signal.
     const UMLRTCommsPort * destPort; // Message destination - capsule contained within.
     const UMLRTSlot * destSlot; // Destination slot.
-    bool isCommand;   // true when it's a command and not a signal.
     size_t sapIndex0_; // The port index on the receive side.
     UMLRTSignal signal;
     size_t srcPortIndex; // The associated srcPort of the message is contained within the signal.
 
+    // Links used while the message is on a port's defer queue (see UMLRTDeferQueue).
+    UMLRTMessage * deferPrev;
+    UMLRTMessage * deferIndexNext;
+    UMLRTMessage * deferIndexPrev;
+
+    // Set on the message of a synchronous invoke - the invoker waiting for it (see UMLRTInvoke).
+    UMLRTInvoke * invoke;
+    size_t invokeGeneration;
+
     bool defer ( ) const;
     void * getParam ( size_t index ) const;
     UMLRTPriority getPriority ( ) const { return signal.getPriority(); }
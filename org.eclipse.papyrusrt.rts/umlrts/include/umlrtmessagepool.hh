@@ -24,12 +24,13 @@ class UMLRTMessagePool: public UMLRTPool
 {
 public:
     UMLRTMessagePool(UMLRTMessage messages[], size_t arraySize, size_t incrementSize =
-            USER_CONFIG_MESSAGE_POOL_INCR);
+            USER_CONFIG_MESSAGE_POOL_INCR, size_t maxSize_ = USER_CONFIG_MESSAGE_POOL_MAX);
 
-    UMLRTMessagePool(size_t incrementSize = USER_CONFIG_MESSAGE_POOL_INCR);
+    UMLRTMessagePool(size_t incrementSize = USER_CONFIG_MESSAGE_POOL_INCR, size_t maxSize_ = USER_CONFIG_MESSAGE_POOL_MAX);
 
 private:
-    virtual void grow();
+    virtual size_t elementSize() const;
+    virtual void grow(void * region, size_t count);
 };
 
 #endif // UMLRTMESSAGEPOOL_HH
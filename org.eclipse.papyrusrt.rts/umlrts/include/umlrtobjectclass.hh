@@ -17,8 +17,13 @@
 #include <stdio.h>
 
 #include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 using namespace rapidjson;
 
+// JSON output is streamed straight into a SAX writer - no intermediate DOM is built.
+typedef Writer<StringBuffer> UMLRTJsonWriter;
+
 // Type descriptors used for encoding/decoding data and passing user data within the RTS API.
 // A number of UMLRTType_xxx descriptors are pre-defined by the library. See below.
 
@@ -82,7 +87,9 @@ struct UMLRTObject_class
     void * ( * encode ) ( const UMLRTObject_class * desc, const void * src, void * dst, int nest );
     void * ( * destroy ) ( const UMLRTObject_class * desc, void * data );
     int ( * fprintf ) ( FILE * ostream, const UMLRTObject_class * desc, const void * data, int nest, int arraySize ); // returns number of chars output.
-    Value * (* toJson) ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize );
+    // toJson writes the "type" and "value" members of a typed value. The caller opens and closes the
+    // enclosing object so it can add members of its own (e.g. "name").
+    void (* toJson) ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize );
     void * (* fromJson) ( Value & value, const UMLRTObject_class * desc, void * dst, int nest );
 
     const char * name;
@@ -111,7 +118,7 @@ extern size_t UMLRTObject_getSize ( const UMLRTObject_class * desc );
 
 // The following returns the number of characters that were printed.
 extern int UMLRTObject_fprintf ( FILE *ostream, const UMLRTObject_class * desc, const void * data, int nest = 0, int arraySize = 1 );
-extern Value * UMLRTObject_toJson ( Document & document, const UMLRTObject_class * desc, const void * data, int nest = 0, int arraySize = 1 );
+extern void UMLRTObject_toJson ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest = 0, int arraySize = 1 );
 extern void * UMLRTObject_fromJson ( Value & value, const UMLRTObject_class * desc, void * dst, int nest = 0 );
 
 // These are the primitive data-types with pre-defined data descriptors.
@@ -44,6 +44,10 @@ public:
     // Deliver the signal to a destination.
     bool signalDeliver ( const UMLRTCommsPort * srcPort, size_t srcPortIndex ) const;
 
+    // Deliver the signal to all far ends of a replicated port under one RTS lock, queuing the messages
+    // for each destination controller as a single batch.
+    bool signalBroadcast ( const UMLRTCommsPort * srcPort ) const;
+
     // Reply to a synchronous message. Return true if success.
     bool reply ( );
 
@@ -11,6 +11,7 @@
 #ifndef UMLRTPOOL_HH
 #define UMLRTPOOL_HH
 
+#include "umlrtmemoryregion.hh"
 #include "umlrtmutex.hh"
 #include <stddef.h>
 
@@ -20,26 +21,63 @@ struct UMLRTQueueElement;
 
 // Basic operations are put() and get(). The implementation is a LIFO queue.
 
+// An empty pool grows by 'increment' elements at a time, up to 'maxSize' elements (0 - unbounded),
+// and get() returns NULL once the limit is reached. Each growth - and the initial reserve made by
+// configure() - is one contiguous, pre-faulted UMLRTMemoryRegion, so the elements of a pool are
+// packed together and taking one never page-faults. The region is rounded up to whole pages and
+// the rest of its last page is used for elements too. Regions start on a page boundary, so the
+// elements of a cache-line aligned type (UMLRTMessage, UMLRTSignalElement) never share a line.
+
+// The pool keeps telemetry: the elements it owns, the elements currently taken, the most ever
+// taken at once (the high-water mark) and the number of get() calls refused at the limit.
+
 class UMLRTPool
 {
 public:
-    UMLRTPool(size_t incrementSize);
+    UMLRTPool(size_t incrementSize, size_t maxSize_ = 0);
     virtual ~UMLRTPool() = 0;
 
-    // Get an element from the pool.
+    // Get an element from the pool. NULL if the pool is exhausted.
     const UMLRTQueueElement * get();
 
     // Add element to the pool.
     void put(const UMLRTQueueElement * element);
 
+    // Set the growth of the pool and reserve elements so it owns at least 'initialSize' of them.
+    // A pool never shrinks - 'maxSize' only limits further growth. Returns false if the reserve
+    // could not be allocated.
+    bool configure(size_t initialSize, size_t maxSize_, size_t incrementSize, UMLRTMemoryRegion::Backing backing_);
+
+    size_t getSize() const { return size; }
+    size_t getInUse() const { return inUse; }
+    size_t getHighWater() const { return highWater; }
+    size_t getMaxSize() const { return maxSize; }
+    size_t getIncrement() const { return increment; }
+    size_t getExhausted() const { return exhausted; }
+    UMLRTMemoryRegion::Backing getBacking() const { return backing; }
+
 protected:
     const UMLRTQueueElement * head;
-    const size_t increment;  // the size to grow the pool if needed
+    size_t increment;  // the size to grow the pool if needed
+    size_t maxSize;    // the most elements the pool grows to (0 - unbounded)
+    size_t size;       // elements owned by the pool - set by the array constructors of the derived pools
     int qid; // For debug. Give elements a qid for easier tracking.
     UMLRTMutex mutex;
 
 private:
-    virtual void grow() = 0;
+    // Allocate a region for at least 'count' elements (up to the limit) and grow into it. Assumes mutex is taken.
+    bool reserve(size_t count);
+
+    // Size of one element, for sizing the regions.
+    virtual size_t elementSize() const = 0;
+
+    // Construct 'count' elements in 'region' and add them to the pool. Assumes mutex is taken.
+    virtual void grow(void * region, size_t count) = 0;
+
+    UMLRTMemoryRegion::Backing backing;
+    size_t inUse;
+    size_t highWater;
+    size_t exhausted;
 };
 
 #endif // UMLRTPOOL_HH
@@ -26,6 +26,9 @@ class UMLRTNotify;
 
 // The priority of each message is contained in the signal (within the message).
 
+// This queue may be written by any thread. A controller's own capsules use the unlocked
+// UMLRTCapsuleMessageQueue (see umlrtcapsulemessagequeue.hh).
+
 class UMLRTPriorityMessageQueue
 {
 public:
@@ -37,20 +40,16 @@ public:
     // Return the queue associated with a priority.
     UMLRTMessageQueue & getQueue ( UMLRTPriority priority );
 
-    // Used to transfer all messages from each priority queue to
-    // their associated priority-queue
-
-    void moveAll ( UMLRTPriorityMessageQueue & fromQueue );
-
-    // Queue up all messages associated with timed-out timers.
-    void queueTimerMessages ( UMLRTTimerQueue * timerQueue );
-
     // Get the highest priority message from the collection of queues.
     UMLRTMessage * dequeueHighestPriority ( );
 
     // Put the message into its appropriate priority-queue.
     void enqueue ( UMLRTMessage * msg, bool front = false );
 
+    // Append a list of messages (already linked together) that share one signal and therefore
+    // one priority. The consumer is notified once for the whole list.
+    void enqueueAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count );
+
     // NOTE: isEmpty() is intended only for the sole consumer of the queue and
     // only reflects the emptiness of the queue at the time of calling.
     // Synchronization (i.e. the 'notify' mechanism) is required to ensure the
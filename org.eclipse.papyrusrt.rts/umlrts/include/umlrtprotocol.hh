@@ -41,6 +41,9 @@ public:
     // Get service port registration name.
     const char * getRegisteredName() const;
 
+    // Get what a send does when the link to the destination host is out of credit.
+    UMLRTLinkPolicy getLinkPolicy() const;
+
     // Find the smallest replication index connected to the far-end capsule.
     int indexTo( const UMLRTCapsule * capsule ) const;
 
@@ -83,6 +86,9 @@ public:
     // Register this SPP port with the serivce SAPs. Return true for success.
     bool registerSPP( const char * service );
 
+    // Set what a send does when the link to the destination host is out of credit. Return false if 'policy' is invalid.
+    bool setLinkPolicy( UMLRTLinkPolicy policy );
+
     // Return the replication factor of the port.
     size_t size() const { return srcPort->numFarEnd; }
 
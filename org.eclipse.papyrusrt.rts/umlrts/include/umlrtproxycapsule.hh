@@ -0,0 +1,34 @@
+// umlrtproxycapsule.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTPROXYCAPSULE_HH
+#define UMLRTPROXYCAPSULE_HH
+
+#include "umlrtcapsule.hh"
+
+// Stand-in for a capsule that runs on another host.
+
+// A distributed host only instantiates the capsules deployed on it. The generated 'create' function
+// gives each remote slot a proxy instead: it holds the capsule's border and internal ports, wired
+// like the real capsule's, so local capsules can address it and messages it sends arrive with
+// valid source ports. It has no attributes or behaviour - signals to it are forwarded to its host.
+
+class UMLRTProxyCapsule : public UMLRTCapsule
+{
+public:
+    UMLRTProxyCapsule ( const UMLRTCapsuleClass * capsuleClass, UMLRTSlot * slot, const UMLRTCommsPort * * borderPorts, const UMLRTCommsPort * * internalPorts );
+
+    virtual void initialize ( const UMLRTMessage & msg );
+    virtual void inject ( const UMLRTMessage & msg );
+    virtual const char * save ( );
+    virtual void load ( const char * data );
+};
+
+#endif // UMLRTPROXYCAPSULE_HH
@@ -89,6 +89,10 @@ public:
     // Initialize a signal with no payload and no srcPort. Used for internal 'empty initialization signal'.
     void initialize ( const char * name, Id id );
 
+    // Refer to the same signal element as 'signal' without incrementing its reference count. The caller
+    // must already hold a reference for this signal (see UMLRTSignalElement::incrementRefCount).
+    void adoptReference ( const UMLRTSignal & signal );
+
     // Check whether this signal is an 'invalid signal'.
     bool isInvalid ( ) const { return element == NULL; }
 
@@ -16,6 +16,7 @@
 #include "umlrtobjectclass.hh"
 #include "umlrtqueueelement.hh"
 #include "umlrtpriority.hh"
+#include "osutil.hh"
 #include <stdint.h>
 #include <stdarg.h>
 
@@ -46,8 +47,8 @@ public:
     // Decode payload into 'data' buffer.
     void decode ( const void * * decodeInfo, const UMLRTObject_class * desc, void * data, int arraySize = 1 );
 
-    // Reference counting
-    void decrementRefCount ( ) const;
+    // Reference counting. A broadcast adds or drops the references of all its messages at once.
+    void decrementRefCount ( int count = 1 ) const;
 
     // Destroy 'data' previously encoded into the payload.
     void destroy ( );
@@ -81,7 +82,7 @@ public:
     const UMLRTObject_class * getType ( size_t index = 0 ) const;
 
     // Reference counting
-    void incrementRefCount ( ) const;
+    void incrementRefCount ( int count = 1 ) const;
 
     void initialize ( const char * name, Id id, const UMLRTCommsPort * srcPort, size_t payloadSize, UMLRTPriority priority = PRIORITY_NORMAL );
     void initialize ( const char * name, Id id, size_t payloadSize, UMLRTPriority priority = PRIORITY_NORMAL );
@@ -99,28 +100,30 @@ public:
     void debugOutputPayload ( );
 
 private:
+    // The fields read to deliver and decode the signal share the first cache line. The reference
+    // count is updated by every thread holding the signal, so it starts a line of its own, with
+    // the fields only used when the element is allocated or freed.
+
     // This signal's ID.
     uint32_t id;
 
+    // User-data is serialized into payload buffer.
+    // This buffer may be temporarily replaced with a larger buffer obtained
+    // from the heap.
+    uint8_t * payload;
+
+    size_t appPayloadSize; // What user declared was the payload size.
+
     // The src port for this signal.
     const UMLRTCommsPort * srcPort;
 
     // Signal name defined by signal initialization.
     const char * name;
 
-    // Keep a copy of the default-sized payload buffer.
-    uint8_t * defaultPayload;
-
-    // User-data is serialized into payload buffer.
-    // This buffer may be temporarily replaced with a larger buffer obtained
-    // from the heap.
-    uint8_t * payload;
+    const UMLRTObject_class * desc;
 
     UMLRTPriority priority;
 
-    size_t appPayloadSize; // What user declared was the payload size.
-    size_t maxPayloadSize; // Actual buffer size.
-
     // Set this true when a buffer larger than the default-size is allocated
     // for a signal and must be deallocated when the signal is returned to the
     // pool.
@@ -132,13 +135,17 @@ private:
     bool allocated;
 
     // Number of UMLRTSignal's referring to this element.
-    mutable int refCount;
+    OS_CACHE_ALIGNED mutable int refCount;
 
     // Mutex for reference counting.
     mutable UMLRTMutex refCountMutex;
 
     const UMLRTObject * object;
-    const UMLRTObject_class * desc;
+
+    // Keep a copy of the default-sized payload buffer.
+    uint8_t * defaultPayload;
+
+    size_t maxPayloadSize; // Actual buffer size.
 };
 
 #endif // UMLRTSIGNALELEMENT_HH
@@ -24,12 +24,14 @@ class UMLRTSignalElementPool: public UMLRTPool
 {
 public:
     UMLRTSignalElementPool(UMLRTSignalElement signalElements[], size_t arraySize,
-            size_t incrementSize = USER_CONFIG_SIGNAL_ELEMENT_POOL_INCR);
+            size_t incrementSize =
+            USER_CONFIG_SIGNAL_ELEMENT_POOL_INCR, size_t maxSize_ = USER_CONFIG_SIGNAL_ELEMENT_POOL_MAX);
 
-    UMLRTSignalElementPool(size_t incrementSize = USER_CONFIG_SIGNAL_ELEMENT_POOL_INCR);
+    UMLRTSignalElementPool(size_t incrementSize = USER_CONFIG_SIGNAL_ELEMENT_POOL_INCR, size_t maxSize_ = USER_CONFIG_SIGNAL_ELEMENT_POOL_MAX);
 
 private:
-    virtual void grow();
+    virtual size_t elementSize() const;
+    virtual void grow(void * region, size_t count);
 };
 
 #endif // UMLRTSIGNALPOOL_HH
@@ -28,7 +28,8 @@ public:
 	UMLRTObject * getOutSignalPayloadObject ( const char* protocol, const char* signal );
 	UMLRTObject * getInSignalPayloadObject ( const char* protocol, const char* signal );
 
-	bool fromJSON( const char * json, const UMLRTCommsPort * port, UMLRTSignal & signal );
+	// Decode a message written by toJSON. 'json' is parsed in situ, so its contents are destroyed.
+	bool fromJSON( char * json, const UMLRTCommsPort * port, UMLRTSignal & signal );
 	std::string toJSON( const UMLRTSignal & signal );
 
 	static UMLRTSignalRegistry& getRegistry ( )
@@ -22,6 +22,7 @@ struct UMLRTCapsulePart;
 class UMLRTController;
 struct UMLRTCommsPort;
 struct UMLRTHost;
+class UMLRTSubstructure;
 
 
 // This is the data container for information the RTS needs on each capsule
@@ -64,6 +65,15 @@ struct UMLRTSlot
     // Set by the controller for all sub-slots in a destruction - but reset to false for the top slot after its parts have been destroyed.
     bool condemned;
 
+    // The block holding an incarnated sub-slot, its ports and its name. NULL for generated slots.
+    UMLRTSubstructure * substructure;
+
+    // The part holding this slot, once the part tracks its free slots (see UMLRTFreeSlots).
+    const UMLRTCapsulePart * part;
+
+    // 1 + index of the slot's entry in its controller's resident list, 0 if it has none (see UMLRTController::Resident).
+    size_t resident;
+
     const UMLRTCapsuleRole * role() const
     {
         return (containerClass == NULL) ? NULL : &containerClass->subcapsuleRoles[roleIndex];
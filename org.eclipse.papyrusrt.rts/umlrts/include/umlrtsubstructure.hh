@@ -0,0 +1,111 @@
+// umlrtsubstructure.hh
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTSUBSTRUCTURE_HH
+#define UMLRTSUBSTRUCTURE_HH
+
+#include <stddef.h>
+#include "umlrtmutex.hh"
+
+class UMLRTHashMap;
+struct UMLRTCapsuleClass;
+struct UMLRTCapsulePart;
+struct UMLRTSlot;
+
+// UMLRTSubstructure - the parts, slots and slot ports below an incarnated capsule, in one block.
+
+// The first incarnation of a capsule class measures its whole sub-structure - part and slot
+// lists, slots, slot ports with their far-end lists and defer queues, and slot names - and
+// caches the layout. Every incarnation then takes a single block (recycled from the class's
+// free list when one is large enough) and builds the sub-structure in place.
+
+// Sub-slots are destroyed one at a time by their own controllers, so the block counts its
+// users - one per sub-slot plus the incarnated slot's reference to its parts - and is
+// released when the last one is gone.
+
+// #create runs without the global RTS lock - the block is private until the frame service
+// publishes it, and the layouts and free lists have their own mutex. The other methods
+// assume the RTS lock is held.
+
+class UMLRTSubstructure
+{
+public:
+    // Build the sub-structure of a 'capsuleClass' capsule in slot 'containerName'. NULL if the class has no parts.
+    static UMLRTCapsulePart * create ( const char * containerName, const UMLRTCapsuleClass * capsuleClass );
+
+    // The capsule in 'slot' has been destroyed - the slot no longer refers to its parts. Only the parts
+    // of an incarnated slot (as returned by #create) hold a reference to their block. The parts of a
+    // fixed sub-slot are laid out inside its container's block, which its sub-slots account for.
+    static void releaseParts ( const UMLRTSlot * slot );
+
+    // A sub-slot has been destroyed. Its slot ports are destroyed here.
+    static void releaseSlot ( UMLRTSlot * slot );
+
+    // Drop 'parts' (as returned by #create) that were never published.
+    static void discard ( const UMLRTCapsulePart * parts );
+
+    // Keep the block holding 'slot' (if any) from being reused while an incarnation into the slot is prepared.
+    static void pin ( const UMLRTSlot * slot );
+    static void unpin ( const UMLRTSlot * slot );
+
+private:
+    // The cached size of a class's sub-structure and its recycled blocks.
+    struct Layout
+    {
+        size_t objectBytes; // Everything but the names - fixed for the class.
+        size_t nameBytes;   // Slot names below a container with an empty name.
+        size_t numSlots;    // Each slot name also repeats the container name.
+        UMLRTSubstructure * freeList;
+        size_t numFree;
+    };
+
+    // Where the next object and name go. Only measures when the block is NULL.
+    struct Cursor
+    {
+        char * objects;
+        size_t objectBytes;
+        char * names;
+        size_t nameBytes;
+        size_t numSlots;
+
+        void * take ( size_t size );
+        char * takeName ( size_t size );
+    };
+
+    static size_t align ( size_t size ) { return (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1); }
+
+    static Layout * getLayout ( const UMLRTCapsuleClass * capsuleClass );
+    static UMLRTHashMap * getLayoutMap ( );
+
+    static UMLRTCapsulePart * place ( Cursor & cursor, UMLRTSubstructure * block, const char * containerName,
+            size_t containerLength, const UMLRTCapsuleClass * containerClass );
+
+    static void release ( UMLRTSubstructure * block );
+
+    // The block starting with 'parts' (as returned by #create).
+    static UMLRTSubstructure * blockOf ( const UMLRTCapsulePart * parts ) { return (UMLRTSubstructure *)((char *)parts - align(sizeof(UMLRTSubstructure))); }
+
+    // True if 'address' is inside this block.
+    bool contains ( const void * address ) const;
+
+    // Release every slot below 'parts'.
+    static void discardSlots ( const UMLRTCapsulePart * parts );
+
+    static UMLRTMutex mutex; // Guards the layouts and their free lists.
+
+    enum { ALIGNMENT = 16 };
+
+    Layout * layout;
+    size_t size;        // Bytes following the (aligned) header.
+    size_t users;
+    UMLRTSubstructure * next; // In the layout's free list.
+};
+
+#endif // UMLRTSUBSTRUCTURE_HH
@@ -0,0 +1,57 @@
+// umlrtthreadattributes.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef UMLRTTHREADATTRIBUTES_HH
+#define UMLRTTHREADATTRIBUTES_HH
+
+#include <stddef.h>
+#include <stdint.h>
+
+// UMLRTThreadAttributes - scheduling and placement attributes applied to a thread when it is started.
+
+// Defined per-controller in the deployment map. Any attribute left at its default leaves the
+// operating system's default behaviour in place.
+
+struct UMLRTThreadAttributes
+{
+    enum { MAX_CPUS = 1024 };
+
+    typedef enum {
+        POLICY_DEFAULT, // Time-sharing (SCHED_OTHER).
+        POLICY_FIFO,    // Real-time, first-in first-out (SCHED_FIFO).
+        POLICY_RR,      // Real-time, round-robin (SCHED_RR).
+    } Policy;
+
+    UMLRTThreadAttributes ( );
+
+    // Parse a CPU list of the form "0-3,8,10-11" (as used by Linux cpusets). Returns false if it is malformed.
+    bool parseCpuList ( const char * list );
+
+    // Parse a policy name - "fifo", "rr" or "other". Returns false if it is not recognized.
+    bool parsePolicy ( const char * name );
+
+    void addCpu ( int cpu );
+    bool hasCpu ( int cpu ) const { return (cpu >= 0) && (cpu < MAX_CPUS) && ((cpus[cpu / 8] & (1 << (cpu % 8))) != 0); }
+
+    // True if any attribute differs from the default.
+    bool isDefined ( ) const;
+
+    // Output the attributes to a buffer for debugging.
+    const char * toString ( char * buffer, size_t size ) const;
+
+    uint8_t cpus[MAX_CPUS / 8];
+    int numCpus;        // Number of CPUs in 'cpus'. Zero if the thread may run on any CPU.
+    Policy policy;
+    int priority;       // Real-time priority - only used with POLICY_FIFO and POLICY_RR.
+    size_t stackSize;   // Zero for the default stack size.
+    int numaNode;       // Memory allocated by the thread is preferentially taken from this node. -1 for no preference.
+};
+
+#endif // UMLRTTHREADATTRIBUTES_HH
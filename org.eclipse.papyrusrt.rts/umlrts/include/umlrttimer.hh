@@ -15,27 +15,36 @@
 #include "umlrtmessage.hh"
 #include "umlrtqueueelement.hh"
 #include "umlrtoutsignal.hh"
+#include "umlrttimerprotocol.hh"
 #include "umlrttimespec.hh"
 
 // An RTS timer.
 
 // Timers are kept in a 'pool' and are allocated when required.
 
-// The 'due' time is the clock-time that the timer is set to expire.
+// The 'due' time is the time that the timer is set to expire. For timers started with
+// 'informAt' ('isClockTime' true), this is a wall-clock time. For relative and interval
+// timers, it is a time on the monotonic clock (see UMLRTTimespec::getmonotonic) and is
+// unaffected by adjustments to the system clock.
 
 // If a timer is an interval-timer, it has an 'interval' time and is restarted
 // by adding the 'interval' to the 'due' time (making that the new 'due' time).
+// Re-arming never reads the clock for the new 'due' time, so periodic timeouts do not drift.
+// The 'overrunPolicy' determines what happens when the new 'due' time has already passed.
 
 // Timers either reside in the system pool (and are available for applications) or are
 // queued on a controller's timerQueue.
 
 struct UMLRTTimer : public UMLRTQueueElement
 {
-    UMLRTTimer() : isInterval(false), destPort(NULL), allocated(false) {}
+    UMLRTTimer() : isInterval(false), isClockTime(false), overrunPolicy(UMLRTTimerProtocol::OVERRUN_CATCHUP), overruns(0), destPort(NULL), allocated(false) {}
 
     UMLRTTimespec due;
     UMLRTTimespec interval;
     bool isInterval;
+    bool isClockTime; // 'due' is a wall-clock time.
+    UMLRTTimerProtocol::OverrunPolicy overrunPolicy;
+    unsigned int overruns; // Intervals skipped or delivered late since the timer was started.
 
     UMLRTOutSignal signal;
     const UMLRTCommsPort * destPort;
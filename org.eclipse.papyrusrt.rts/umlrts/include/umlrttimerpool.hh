@@ -24,12 +24,13 @@ class UMLRTTimerPool: public UMLRTPool
 {
 public:
     UMLRTTimerPool(UMLRTTimer timerElements[], size_t arraySize, size_t incrementSize =
-            USER_CONFIG_TIMER_POOL_INCR);
+            USER_CONFIG_TIMER_POOL_INCR, size_t maxSize_ = USER_CONFIG_TIMER_POOL_MAX);
 
-    UMLRTTimerPool(size_t incrementSize = USER_CONFIG_TIMER_POOL_INCR);
+    UMLRTTimerPool(size_t incrementSize = USER_CONFIG_TIMER_POOL_INCR, size_t maxSize_ = USER_CONFIG_TIMER_POOL_MAX);
 
 private:
-    virtual void grow();
+    virtual size_t elementSize() const;
+    virtual void grow(void * region, size_t count);
 };
 
 #endif // UMLRTTIMERPOOL_HH
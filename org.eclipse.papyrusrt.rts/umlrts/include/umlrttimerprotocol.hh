@@ -29,6 +29,15 @@ class UMLRTTimerProtocol
 public:
     enum SignalId { signal_timeout = UMLRTSignal::FIRST_PROTOCOL_SIGNAL_ID };
 
+    // What an interval timer does when it is re-armed after one or more of its intervals have already passed
+    // (e.g. the controller was busy).
+    enum OverrunPolicy
+    {
+        OVERRUN_CATCHUP,    // Deliver a timeout for every interval that passed. (Default.)
+        OVERRUN_SKIP,       // Deliver one timeout and skip ahead to the next interval not yet passed.
+        OVERRUN_COALESCE    // As OVERRUN_SKIP, but the timeout payload is an 'int' holding the number of intervals skipped.
+    };
+
     class InSignals {  };
     class OutSignals {
     public:
@@ -57,6 +66,15 @@ public:
         // Cancel a timer. Returns true of timer was cancelled before time-out.
         bool cancelTimer( const UMLRTCommsPort * srcPort, const UMLRTTimerId id ) const;
 
+        // Set the overrun policy of an interval timer. Call immediately after 'informEvery'.
+        // OVERRUN_COALESCE replaces the timeout payload and is only valid for timers started without user-defined data.
+        // Returns false if the policy is not valid for the timer.
+        bool setOverrunPolicy( const UMLRTCommsPort * srcPort, const UMLRTTimerId id, OverrunPolicy policy ) const;
+
+        // Total number of intervals an interval timer has skipped (OVERRUN_SKIP or OVERRUN_COALESCE) or
+        // delivered late in a burst (OVERRUN_CATCHUP) since it was started.
+        unsigned int getOverrunCount( const UMLRTCommsPort * srcPort, const UMLRTTimerId id ) const;
+
         // Clock adjustments must be made between calls to 'timeAdjustStart()' and 'timeAdjustComplete()'
         // to ensure the timing service delivers clock-time-based timeouts correctly.
         // The resulting change in the platform clock must be computed and passed to the timer service
@@ -130,6 +148,16 @@ public:
         return UMLRTTimerProtocol::Base::cancelTimer( srcPort, id );
     }
 
+    // See UMLRTTimerProtocol.
+    bool setOverrunPolicy( const UMLRTTimerId id, UMLRTTimerProtocol::OverrunPolicy policy ) const
+    {
+        return UMLRTTimerProtocol::Base::setOverrunPolicy( srcPort, id, policy );
+    }
+    unsigned int getOverrunCount( const UMLRTTimerId id ) const
+    {
+        return UMLRTTimerProtocol::Base::getOverrunCount( srcPort, id );
+    }
+
     // See UMLRTTimerProtocol.
     void timeAdjustStart( ) const
     {
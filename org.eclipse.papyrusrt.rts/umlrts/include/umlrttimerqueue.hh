@@ -18,7 +18,13 @@
 
 // Queue of running timers.
 
+// Relative and interval timers are due on the monotonic clock and are kept in the base
+// queue list (head/tail). Clock-time timers ('informAt') are kept in a separate list
+// (clockHead/clockTail) since their due-times are compared against the wall-clock.
+// Only operations on the clock-time list are blocked during time adjustments.
+
 struct UMLRTTimer;
+class UMLRTClockCache;
 class UMLRTNotify;
 
 class UMLRTTimerQueue : public UMLRTQueue
@@ -36,11 +42,17 @@ public:
     void clearNotifyFd ( );
 
     // Remove the first timer on the queue. Returns NULL if none or the first timer has not yet expired.
+    // The second variant compares against the cached time of the caller.
     UMLRTTimer * dequeue ( );
+    UMLRTTimer * dequeue ( UMLRTClockCache & now );
 
     // Add a timer to the queue in order of when they will expire.
     void enqueue ( const UMLRTTimer * timer );
 
+    // Hides the UMLRTQueue versions - these cover both the monotonic and clock-time lists.
+    bool isEmpty ( ) const { return (head == NULL) && (clockHead == NULL); }
+    int remove ( match_compare_t compare, match_notify_t notify, void * userData, bool one = false );
+
     // return umlrtnotify fd[READ]
     int getNotifyFd ( );
 
@@ -49,17 +61,35 @@ public:
     static void timeAdjustUnlock ( );
 
     // Called from UMLRTTimerProtocol - not a user API - used internally by the RTS.
+    // Clock-time timers follow the adjusted clock - the controllers are notified to re-evaluate their wait.
     static void timeAdjustAllQueues ( const UMLRTTimespec & delta );
     void timeAdjustElements ( const UMLRTTimespec & delta );
 
-    // Calculate how much time left before timer on the head of the queue is due.
+    // Calculate how much time left before the first timer in the queue is due.
+    // If a slack window is set, this is the time left before the last relative or interval timer due within
+    // the window following the first, so that all of them expire in one controller wakeup.
     UMLRTTimespec timeRemaining ( ) const;
+    UMLRTTimespec timeRemaining ( UMLRTClockCache & now ) const;
+
+    // Set the slack window applied to all timer queues. A timer may be delivered up to 'slack' late
+    // so that it can be batched with others. Zero (the default) delivers every timer when it is due.
+    static void setSlack ( const UMLRTTimespec & slack );
 
 private:
 
     static UMLRTHashMap * getTimerQueuesMap ( );
 
+    // Sorted-list helpers common to both timer lists. Assume the queue mutex is held.
+    static bool insertSorted ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, const UMLRTTimer * timer );
+    static bool unlink ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, const UMLRTTimer * timer );
+    int removeFrom ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, match_compare_t compare, match_notify_t notify, void * userData, bool one );
+
+    // Clock-time timers.
+    mutable const UMLRTQueueElement * clockHead;
+    mutable const UMLRTQueueElement * clockTail; // WARNING: undefined if 'clockHead == 0'.
+
     UMLRTNotify * notifyPtr;
+    static UMLRTTimespec slack;
     static UMLRTMutex timeAdjustMutex;
     static UMLRTHashMap  * timerQueues;
 };
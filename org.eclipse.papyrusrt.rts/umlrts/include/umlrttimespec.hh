@@ -23,7 +23,8 @@
 class UMLRTTimespec
 {
 public:
-    UMLRTTimespec();
+    // Zero. Does not read the clock - use 'getclock' or 'getmonotonic' for the current time.
+    UMLRTTimespec() : tv_sec(0), tv_nsec(0) { }
 
     UMLRTTimespec( const UMLRTTimespec & tm );
     UMLRTTimespec( long seconds, long nanoseconds );
@@ -46,10 +47,15 @@ public:
     // Return true if the time specification is zero or negative.
     bool isZeroOrNegative() const;
 
+    // Wall-clock time. Follows adjustments to the system clock.
     static void getclock( UMLRTTimespec & tm );
     static void getclock( UMLRTTimespec * tm );
     static void getClock( UMLRTTimespec * tm ); // Deprecated
 
+    // Monotonic time since an unspecified starting point. Not affected by adjustments to the system clock.
+    // Relative and interval timers are timed with this clock.
+    static void getmonotonic( UMLRTTimespec * tm );
+
     long tv_sec;
     long tv_nsec; // Nanoseconds (one-billionths of a second). Always < one billion. Always >= 0.
 
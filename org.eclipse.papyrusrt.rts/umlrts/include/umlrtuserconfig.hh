@@ -35,4 +35,54 @@
 #define USER_CONFIG_SIGNAL_ELEMENT_POOL_INCR        50
 #define USER_CONFIG_TIMER_POOL_INCR                 50
 
+// maximum number of elements a pool grows to (0 - unbounded)
+#define USER_CONFIG_MESSAGE_POOL_MAX                0
+#define USER_CONFIG_SIGNAL_ELEMENT_POOL_MAX         0
+#define USER_CONFIG_TIMER_POOL_MAX                  0
+
+// Memory the pools grow into (see UMLRTMemoryRegion)
+#define USER_CONFIG_POOL_BACKING                    UMLRTMemoryRegion::BACKING_PAGES
+
+// Maximum number of messages a controller takes from its capsule queue at a time
+#define USER_CONFIG_CONTROLLER_BATCH_SIZE           32
+
+// Maximum number of consecutive messages to one capsule a controller injects as a single run (1 disables runs)
+#define USER_CONFIG_CONTROLLER_CAPSULE_RUN          16
+
+// Destroyed incarnation sub-structures kept per capsule class for reuse (see UMLRTSubstructure)
+#define USER_CONFIG_SUBSTRUCTURE_FREE_LIST          16
+
+// Longest a synchronous invoke of a capsule on another controller waits for it to be handled (milliseconds)
+#define USER_CONFIG_INVOKE_TIMEOUT_MSEC             5000
+
+// Distinct destination controllers a broadcast send batches at once before queuing what it has so far
+#define USER_CONFIG_BROADCAST_MAX_CONTROLLERS       8
+
+// Controller worker pool (see UMLRTControllerPool)
+#define USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS     64
+#define USER_CONFIG_CONTROLLER_POOL_IDLE_MSEC       1000    // longest an idle worker sleeps with no timer running
+#define USER_CONFIG_CONTROLLER_POOL_TIMER_CHECK     16      // busy workers check for expired timers every this many passes
+
+// Timer expiries due within this window of each other are batched into one controller wakeup (microseconds)
+#define USER_CONFIG_TIMER_SLACK_USEC                0
+
+// Controller load balancer (see UMLRTControllerBalancer)
+#define USER_CONFIG_BALANCER_MAX_CONTROLLERS        64
+#define USER_CONFIG_BALANCER_MIN_LOAD               100     // messages per period on the busiest controller before a capsule is moved
+#define USER_CONFIG_BALANCER_IMBALANCE_PCT          150     // busiest controller's load as a percentage of the least busy before a capsule is moved
+
+// Link flow control - frames queued for one remote host (see UMLRTCommunicator::queueMessage)
+#define USER_CONFIG_LINK_HIGH_WATER                 1024    // no more frames are queued once this many are waiting (0 disables)
+#define USER_CONFIG_LINK_LOW_WATER                  256     // ... until the queue drains to this many
+#define USER_CONFIG_LINK_BLOCK_MSEC                 1000    // longest a LINK_POLICY_BLOCK send waits for the link to drain
+
+// Remote signal payloads of at least this many bytes are compressed on links where both hosts agree (0 disables)
+#define USER_CONFIG_LINK_COMPRESS_THRESHOLD         0
+
+// Asynchronous log port output
+#define USER_CONFIG_LOG_BUFFER_SIZE                 65536   // per-thread buffer size (bytes)
+#define USER_CONFIG_LOG_RECORD_SIZE                 512     // records larger than this are formatted on the heap
+#define USER_CONFIG_LOG_FLUSH_MSEC                  10      // maximum delay before buffered output is written
+#define USER_CONFIG_LOG_MAPPED_FILE_SIZE            1048576 // initial size of a memory-mapped log file
+
 #endif // UMLRTUSERCONFIG_H
@@ -0,0 +1,56 @@
+// osatomic.hh
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#ifndef OSATOMIC_HH
+#define OSATOMIC_HH
+
+// Minimal set of atomic operations needed by the lock-free parts of the RTS.
+// Loads have acquire semantics, stores have release semantics and the
+// read-modify-write operations are full barriers.
+
+// Storage class for per-thread variables (POD types only).
+#define OS_THREAD_LOCAL __thread
+
+class OSAtomic
+{
+public:
+    template <typename T>
+    static T load ( const volatile T * p ) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+    template <typename T>
+    static void store ( volatile T * p, T value ) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+    // Returns the value held before the addition.
+    template <typename T>
+    static T fetchAdd ( volatile T * p, T value ) { return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST); }
+
+    // Returns the value held before the exchange.
+    template <typename T>
+    static T exchange ( volatile T * p, T value ) { return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST); }
+
+    // Returns true if *p was equal to 'expected' and was replaced by 'desired'.
+    template <typename T>
+    static bool compareAndSwap ( volatile T * p, T expected, T desired )
+    {
+        return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+
+    static void fence ( ) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+    // Hint to the processor that we are in a spin-wait loop.
+    static void pause ( )
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#endif
+    }
+};
+
+#endif // OSATOMIC_HH
@@ -0,0 +1,46 @@
+// ostimerfd.hh
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#ifndef OSTIMERFD_HH
+#define OSTIMERFD_HH
+
+#include "umlrttimespec.hh"
+
+// A one-shot timer on the monotonic clock whose expiry is signalled on a file descriptor.
+// Each controller owns one and arms it with the time remaining on its first running timer,
+// so the wait in select() has nanosecond resolution.
+
+class UMLRTTimerFd
+{
+public:
+
+    UMLRTTimerFd();
+    ~UMLRTTimerFd();
+
+    // Arm the timer to expire after 'relative' (which must be positive). Re-arming replaces the previous expiry.
+    // Returns false if timer file descriptors are not supported - the caller must fall back to a select() timeout.
+    bool arm( const UMLRTTimespec & relative );
+
+    // Stop the timer if it is armed.
+    void disarm();
+
+    // Return the file descriptor which becomes readable when the timer expires. -1 if not supported.
+    int getFd();
+
+    // Clear the expiry indication.
+    void clear();
+
+private:
+
+    int fd;
+    bool armed;
+};
+
+#endif // OSTIMERFD_HH
@@ -12,5 +12,24 @@
 #define OSUTIL_HH
 
 #include <string.h>
+#include <stdint.h>
+
+// Data written by different threads is kept at least a cache line apart.
+#define OS_CACHE_LINE_SIZE 64
+
+// Align a type or a member to a cache line. Placed before the declaration (or after 'class').
+#define OS_CACHE_ALIGNED __attribute__((aligned(OS_CACHE_LINE_SIZE)))
+
+// Compile-time check - declares the array type 'name', which fails to compile if 'condition' is false.
+#define OS_STATIC_ASSERT(condition, name) typedef char name[(condition) ? 1 : -1] __attribute__((unused))
+
+// Offset of a member of a class with a (non-virtual) base class. Only for OS_STATIC_ASSERT.
+#define OS_MEMBER_OFFSET(type, member) ((size_t)&reinterpret_cast<const volatile char &>((((type *)OS_CACHE_LINE_SIZE)->member)) - OS_CACHE_LINE_SIZE)
+
+// Index of the lowest set bit of a non-zero value.
+static inline unsigned osCountTrailingZeros ( uint64_t value )
+{
+    return (unsigned)__builtin_ctzll(value);
+}
 
 #endif // OSUTIL_HH
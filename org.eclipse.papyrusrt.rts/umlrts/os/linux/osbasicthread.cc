@@ -8,13 +8,24 @@
  * http://www.eclipse.org/legal/epl-v10.html
  *******************************************************************************/
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "basedebug.hh"
 #include "basefatal.hh"
 #include "umlrtbasicthread.hh"
 
-#ifndef _GNU_SOURCE
-#define _GNU_SOURCE
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
 #endif
 
 // Start the thread, passing in a single argument.
@@ -35,6 +46,19 @@ void UMLRTBasicThread::start(void * args)
     {
         FATAL_ERRNO("pthread_attr_init");
     }
+    if (attributes.stackSize != 0)
+    {
+        size_t stackSize = attributes.stackSize;
+        if (stackSize < (size_t)PTHREAD_STACK_MIN)
+        {
+            stackSize = (size_t)PTHREAD_STACK_MIN;
+        }
+        int rc;
+        if ((rc = pthread_attr_setstacksize(&attr, stackSize)) != 0)
+        {
+            FATAL("thread %s pthread_attr_setstacksize(%lu): %s", name, (unsigned long)stackSize, strerror(rc));
+        }
+    }
     threadargs.inst = this;
     threadargs.args = args;
 
@@ -55,6 +79,95 @@ void UMLRTBasicThread::start(void * args)
 #endif
 }
 
+// Apply the attributes that can only be set from the new thread itself.
+
+void UMLRTBasicThread::applyAttributes()
+{
+    if (!attributes.isDefined())
+    {
+        return;
+    }
+    char buf[256];
+    BDEBUG(BD_CONTROLLER, "thread %s attributes %s\n", name, attributes.toString(buf, sizeof(buf)));
+
+    // A NUMA node without an explicit CPU list keeps the thread on the node's CPUs.
+    UMLRTThreadAttributes nodeCpus;
+    const UMLRTThreadAttributes * cpus = &attributes;
+    if ((attributes.numCpus == 0) && (attributes.numaNode >= 0))
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", attributes.numaNode);
+        FILE * fd = fopen(path, "r");
+        if ((fd == NULL) || (fgets(buf, sizeof(buf), fd) == NULL) || !nodeCpus.parseCpuList(buf))
+        {
+            FATAL("thread %s: NUMA node %d not found (%s)", name, attributes.numaNode, path);
+        }
+        fclose(fd);
+        cpus = &nodeCpus;
+    }
+    if (cpus->numCpus > 0)
+    {
+        cpu_set_t * set = CPU_ALLOC(UMLRTThreadAttributes::MAX_CPUS);
+        size_t setSize = CPU_ALLOC_SIZE(UMLRTThreadAttributes::MAX_CPUS);
+        if (set == NULL)
+        {
+            FATAL("thread %s: CPU_ALLOC failed", name);
+        }
+        CPU_ZERO_S(setSize, set);
+        for (int cpu = 0; cpu < UMLRTThreadAttributes::MAX_CPUS; ++cpu)
+        {
+            if (cpus->hasCpu(cpu))
+            {
+                CPU_SET_S(cpu, setSize, set);
+            }
+        }
+        int rc;
+        if ((rc = pthread_setaffinity_np(pthread_self(), setSize, set)) != 0)
+        {
+            FATAL("thread %s pthread_setaffinity_np: %s", name, strerror(rc));
+        }
+        CPU_FREE(set);
+    }
+    if (attributes.policy != UMLRTThreadAttributes::POLICY_DEFAULT)
+    {
+        int policy = (attributes.policy == UMLRTThreadAttributes::POLICY_FIFO) ? SCHED_FIFO : SCHED_RR;
+        if ((attributes.priority < sched_get_priority_min(policy)) || (attributes.priority > sched_get_priority_max(policy)))
+        {
+            FATAL("thread %s priority %d out of range [%d..%d]", name, attributes.priority,
+                    sched_get_priority_min(policy), sched_get_priority_max(policy));
+        }
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = attributes.priority;
+
+        int rc;
+        if ((rc = pthread_setschedparam(pthread_self(), policy, &param)) == EPERM)
+        {
+            // Not privileged (CAP_SYS_NICE or RLIMIT_RTPRIO) - keep running with the default policy.
+            printf("WARNING: thread %s: no permission to set real-time priority %d - using the default scheduling policy.\n", name, attributes.priority);
+        }
+        else if (rc != 0)
+        {
+            FATAL("thread %s pthread_setschedparam: %s", name, strerror(rc));
+        }
+    }
+    if (attributes.numaNode >= 0)
+    {
+        // Pages first touched by this thread (its queues, capsules it creates and pool growth) come from this node.
+        unsigned long nodemask[16];
+        memset(nodemask, 0, sizeof(nodemask));
+        if (attributes.numaNode >= (int)(sizeof(nodemask) * CHAR_BIT))
+        {
+            FATAL("thread %s NUMA node %d out of range", name, attributes.numaNode);
+        }
+        nodemask[attributes.numaNode / (sizeof(unsigned long) * CHAR_BIT)] |= 1UL << (attributes.numaNode % (sizeof(unsigned long) * CHAR_BIT));
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask, sizeof(nodemask) * CHAR_BIT) < 0)
+        {
+            printf("WARNING: thread %s: set_mempolicy(node %d) failed: %s\n", name, attributes.numaNode, strerror(errno));
+        }
+    }
+}
+
 // Wait for the thread to complete and get returned value.
 
 void * UMLRTBasicThread::join()
@@ -0,0 +1,133 @@
+// osmappedfile.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include "basedebug.hh"
+#include "umlrtmappedfile.hh"
+
+// platform-dependent implementation of a memory-mapped output file.
+
+UMLRTMappedFile::UMLRTMappedFile ( ) : file(NULL), base(NULL), mapped(0), written(0)
+{
+}
+
+UMLRTMappedFile::~UMLRTMappedFile ( )
+{
+    close();
+}
+
+bool UMLRTMappedFile::open ( const char * fname, size_t initialSize )
+{
+    close();
+
+    int fd = ::open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        BDEBUG(BD_ERROR, "open(%s) failed: %s\n", fname, strerror(errno));
+        return false;
+    }
+    file = (osmappedfile_t)(intptr_t)(fd + 1); // Never NULL while open.
+    written = 0;
+    if (!grow(initialSize))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool UMLRTMappedFile::grow ( size_t required )
+{
+    int fd = (int)(intptr_t)file - 1;
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    size_t newsize = (mapped != 0) ? mapped : pagesize;
+
+    while (newsize < required)
+    {
+        newsize *= 2;
+    }
+    newsize = (newsize + pagesize - 1) & ~(pagesize - 1);
+
+    if (ftruncate(fd, newsize) < 0)
+    {
+        BDEBUG(BD_ERROR, "ftruncate failed: %s\n", strerror(errno));
+        return false;
+    }
+    void * newbase;
+    if (base == NULL)
+    {
+        newbase = mmap(NULL, newsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    else
+    {
+        newbase = mremap(base, mapped, newsize, MREMAP_MAYMOVE);
+    }
+    if (newbase == MAP_FAILED)
+    {
+        BDEBUG(BD_ERROR, "mmap failed: %s\n", strerror(errno));
+        return false;
+    }
+    base = (char *)newbase;
+    mapped = newsize;
+    return true;
+}
+
+size_t UMLRTMappedFile::write ( const void * data, size_t size )
+{
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if ((written + size) > mapped)
+    {
+        if (!grow(written + size))
+        {
+            return 0;
+        }
+    }
+    memcpy(base + written, data, size);
+    written += size;
+    return size;
+}
+
+void UMLRTMappedFile::sync ( )
+{
+    if (base != NULL)
+    {
+        msync(base, mapped, MS_ASYNC);
+    }
+}
+
+void UMLRTMappedFile::close ( )
+{
+    if (file != NULL)
+    {
+        int fd = (int)(intptr_t)file - 1;
+        if (base != NULL)
+        {
+            munmap(base, mapped);
+        }
+        if (ftruncate(fd, written) < 0)
+        {
+            BDEBUG(BD_ERROR, "ftruncate failed: %s\n", strerror(errno));
+        }
+        ::close(fd);
+    }
+    file = NULL;
+    base = NULL;
+    mapped = 0;
+    written = 0;
+}
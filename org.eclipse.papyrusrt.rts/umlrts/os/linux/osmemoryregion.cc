@@ -0,0 +1,94 @@
+// osmemoryregion.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include "basedebug.hh"
+#include "umlrtmemoryregion.hh"
+
+// platform-dependent implementation of the pre-faulted memory region allocator.
+
+// The common x86-64 and aarch64 huge page size.
+#define OS_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static size_t roundUp ( size_t size, size_t granule )
+{
+    return (size + granule - 1) & ~(granule - 1);
+}
+
+/*static*/ size_t UMLRTMemoryRegion::pageSize ( Backing backing )
+{
+    return (backing == BACKING_PAGES) ? (size_t)sysconf(_SC_PAGESIZE) : OS_HUGE_PAGE_SIZE;
+}
+
+/*static*/ void * UMLRTMemoryRegion::allocate ( size_t & size, Backing & backing )
+{
+    if (backing == BACKING_HUGE)
+    {
+#ifdef MAP_HUGETLB
+        size_t hugeSize = roundUp(size, OS_HUGE_PAGE_SIZE);
+        void * region = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (region != MAP_FAILED)
+        {
+            size = hugeSize;
+            return region;
+        }
+        BDEBUG(BD_ERROR, "mmap of %lu bytes of huge pages failed (%s) - using transparent huge pages\n", (unsigned long)hugeSize, strerror(errno));
+#endif
+        backing = BACKING_THP;
+    }
+    if (backing == BACKING_THP)
+    {
+#ifdef MADV_HUGEPAGE
+        // Map an extra huge page so the region can be trimmed to start on a huge page boundary.
+        size_t thpSize = roundUp(size, OS_HUGE_PAGE_SIZE);
+        void * mapping = mmap(NULL, thpSize + OS_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            BDEBUG(BD_ERROR, "mmap of %lu bytes failed: %s\n", (unsigned long)(thpSize + OS_HUGE_PAGE_SIZE), strerror(errno));
+            return NULL;
+        }
+        char * region = (char *)roundUp((size_t)(uintptr_t)mapping, OS_HUGE_PAGE_SIZE);
+        size_t head = region - (char *)mapping;
+        if (head > 0)
+        {
+            munmap(mapping, head);
+        }
+        munmap(region + thpSize, OS_HUGE_PAGE_SIZE - head);
+        if (madvise(region, thpSize, MADV_HUGEPAGE) < 0)
+        {
+            BDEBUG(BD_ERROR, "madvise(MADV_HUGEPAGE) failed: %s\n", strerror(errno));
+        }
+        // Fault the region in now, a page at a time.
+        size_t pagesize = sysconf(_SC_PAGESIZE);
+        for (size_t offset = 0; offset < thpSize; offset += pagesize)
+        {
+            ((volatile char *)region)[offset] = 0;
+        }
+        size = thpSize;
+        return region;
+#else
+        backing = BACKING_PAGES;
+#endif
+    }
+    size_t pagesSize = roundUp(size, sysconf(_SC_PAGESIZE));
+    void * region = mmap(NULL, pagesSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (region == MAP_FAILED)
+    {
+        BDEBUG(BD_ERROR, "mmap of %lu bytes failed: %s\n", (unsigned long)pagesSize, strerror(errno));
+        return NULL;
+    }
+    backing = BACKING_PAGES;
+    size = pagesSize;
+    return region;
+}
@@ -0,0 +1,96 @@
+// ostimerfd.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "basedebug.hh"
+#include "basedebugtype.hh"
+#include "basefatal.hh"
+#include "ostimerfd.hh"
+
+// See ostimerfd.hh for documentation.
+UMLRTTimerFd::UMLRTTimerFd() : fd(-1), armed(false)
+{
+    if ((fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) < 0)
+    {
+        // Leave it to the controller to fall back to select() timeouts.
+        BDEBUG(BD_TIMER, "timerfd_create failed errno(%d) - using select() timeouts\n", errno);
+        fd = -1;
+    }
+}
+
+UMLRTTimerFd::~UMLRTTimerFd()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+bool UMLRTTimerFd::arm( const UMLRTTimespec & relative )
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct itimerspec spec;
+
+    spec.it_interval.tv_sec = 0;
+    spec.it_interval.tv_nsec = 0;
+    spec.it_value.tv_sec = relative.tv_sec;
+    spec.it_value.tv_nsec = relative.tv_nsec;
+
+    if ((spec.it_value.tv_sec == 0) && (spec.it_value.tv_nsec == 0))
+    {
+        // A zero value would disarm the timer.
+        spec.it_value.tv_nsec = 1;
+    }
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0)
+    {
+        FATAL_ERRNO("timerfd_settime");
+    }
+    armed = true;
+    return true;
+}
+
+void UMLRTTimerFd::disarm()
+{
+    if ((fd >= 0) && armed)
+    {
+        struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+
+        if (timerfd_settime(fd, 0, &spec, NULL) < 0)
+        {
+            FATAL_ERRNO("timerfd_settime");
+        }
+        armed = false;
+    }
+}
+
+int UMLRTTimerFd::getFd()
+{
+    return fd;
+}
+
+void UMLRTTimerFd::clear()
+{
+    uint64_t expirations;
+
+    if (read(fd, &expirations, sizeof(expirations)) < 0)
+    {
+        if (errno != EAGAIN)
+        {
+            FATAL_ERRNO("read timerfd");
+        }
+    }
+    armed = false;
+}
@@ -17,14 +17,14 @@
 
 /*static*/ void UMLRTTimespec::getclock( UMLRTTimespec * tm )
 {
-    struct timeval tv;
+    struct timespec ts;
 
-    if (gettimeofday(&tv, NULL) < 0)
+    if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
     {
-        FATAL_ERRNO("gettimeofday");
+        FATAL_ERRNO("clock_gettime(CLOCK_REALTIME)");
     }
-    tm->tv_sec = tv.tv_sec;
-    tm->tv_nsec = tv.tv_usec * 1000;
+    tm->tv_sec = ts.tv_sec;
+    tm->tv_nsec = ts.tv_nsec;
 }
 
 /*static*/ void UMLRTTimespec::getclock( UMLRTTimespec & tm )
@@ -32,6 +32,19 @@
     getclock(&tm);
 }
 
+// clock_gettime() is serviced by the vDSO (normally from the TSC) without entering the kernel.
+/*static*/ void UMLRTTimespec::getmonotonic( UMLRTTimespec * tm )
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+    {
+        FATAL_ERRNO("clock_gettime(CLOCK_MONOTONIC)");
+    }
+    tm->tv_sec = ts.tv_sec;
+    tm->tv_nsec = ts.tv_nsec;
+}
+
 /*static*/ void UMLRTTimespec::timespecAbsAddMsec( struct timespec * timeout, long msec )
 {
     clock_gettime(CLOCK_REALTIME, timeout);
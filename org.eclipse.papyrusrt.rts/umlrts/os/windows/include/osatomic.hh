@@ -0,0 +1,72 @@
+// osatomic.hh
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#ifndef OSATOMIC_HH
+#define OSATOMIC_HH
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <intrin.h>
+
+// Minimal set of atomic operations needed by the lock-free parts of the RTS.
+// Only 32-bit and 64-bit integral and pointer types are supported.
+
+// Storage class for per-thread variables (POD types only).
+#define OS_THREAD_LOCAL __declspec(thread)
+
+class OSAtomic
+{
+public:
+    template <typename T>
+    static T load ( const volatile T * p ) { T value = *p; _ReadWriteBarrier(); return value; }
+
+    template <typename T>
+    static void store ( volatile T * p, T value ) { _ReadWriteBarrier(); *p = value; }
+
+    // Returns the value held before the addition.
+    template <typename T>
+    static T fetchAdd ( volatile T * p, T value )
+    {
+        if (sizeof(T) == sizeof(LONG))
+        {
+            return (T)InterlockedExchangeAdd((volatile LONG *)p, (LONG)value);
+        }
+        return (T)InterlockedExchangeAdd64((volatile LONGLONG *)p, (LONGLONG)value);
+    }
+
+    // Returns the value held before the exchange.
+    template <typename T>
+    static T exchange ( volatile T * p, T value )
+    {
+        if (sizeof(T) == sizeof(LONG))
+        {
+            return (T)InterlockedExchange((volatile LONG *)p, (LONG)value);
+        }
+        return (T)InterlockedExchange64((volatile LONGLONG *)p, (LONGLONG)value);
+    }
+
+    // Returns true if *p was equal to 'expected' and was replaced by 'desired'.
+    template <typename T>
+    static bool compareAndSwap ( volatile T * p, T expected, T desired )
+    {
+        if (sizeof(T) == sizeof(LONG))
+        {
+            return InterlockedCompareExchange((volatile LONG *)p, (LONG)desired, (LONG)expected) == (LONG)expected;
+        }
+        return InterlockedCompareExchange64((volatile LONGLONG *)p, (LONGLONG)desired, (LONGLONG)expected) == (LONGLONG)expected;
+    }
+
+    static void fence ( ) { MemoryBarrier(); }
+
+    // Hint to the processor that we are in a spin-wait loop.
+    static void pause ( ) { YieldProcessor(); }
+};
+
+#endif // OSATOMIC_HH
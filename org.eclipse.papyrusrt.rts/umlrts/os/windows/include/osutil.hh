@@ -11,10 +11,42 @@
 #ifndef OSUTIL_HH
 #define OSUTIL_HH
 
+#include <stddef.h>
+#include <stdint.h>
+#include <intrin.h>
+
 #define strtok_r strtok_s
 #define snprintf _snprintf
 #define vsnprintf _vsnprintf
 #define strcasecmp _stricmp
 #define strncasecmp _strnicmp
 
+// Data written by different threads is kept at least a cache line apart.
+#define OS_CACHE_LINE_SIZE 64
+
+// Align a type or a member to a cache line. Placed before the declaration (or after 'class').
+#define OS_CACHE_ALIGNED __declspec(align(OS_CACHE_LINE_SIZE))
+
+// Compile-time check - declares the array type 'name', which fails to compile if 'condition' is false.
+#define OS_STATIC_ASSERT(condition, name) typedef char name[(condition) ? 1 : -1]
+
+// Offset of a member of a class with a (non-virtual) base class. Only for OS_STATIC_ASSERT.
+#define OS_MEMBER_OFFSET(type, member) offsetof(type, member)
+
+// Index of the lowest set bit of a non-zero value.
+static __inline unsigned osCountTrailingZeros ( uint64_t value )
+{
+    unsigned long index;
+#if defined(_M_X64)
+    _BitScanForward64(&index, value);
+#else
+    if (!_BitScanForward(&index, (unsigned long)value))
+    {
+        _BitScanForward(&index, (unsigned long)(value >> 32));
+        index += 32;
+    }
+#endif
+    return (unsigned)index;
+}
+
 #endif // OSUTIL_HH
@@ -11,6 +11,8 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <process.h>    /* _beginthreadex, _endthreadex */
+#include <stdio.h>
+#include "basedebug.hh"
 #include "basefatal.hh"
 #include "umlrtbasicthread.hh"
 
@@ -22,7 +24,7 @@ void UMLRTBasicThread::start(void * args)
     threadargs.args = args;
 
     uintptr_t tid_ = _beginthreadex(NULL, // security
-            0,  // stack size, same size as the main thread stack
+            (unsigned)attributes.stackSize,  // stack size, zero for same size as the main thread stack
             (unsigned (__stdcall*)(void*)) static_entrypoint,   // thread routine
             &threadargs    ,// thread args
             NULL,// initial state flag
@@ -37,6 +39,51 @@ void UMLRTBasicThread::start(void * args)
     tid = (osthreadid_t) tid_;
 }
 
+// Apply the attributes that can only be set from the new thread itself.
+
+void UMLRTBasicThread::applyAttributes()
+{
+    if (!attributes.isDefined())
+    {
+        return;
+    }
+    char buf[256];
+    BDEBUG(BD_CONTROLLER, "thread %s attributes %s\n", name, attributes.toString(buf, sizeof(buf)));
+
+    // Only the CPUs in the thread's processor group (the first 64) can be used.
+    DWORD_PTR mask = 0;
+    for (int cpu = 0; cpu < (int)(sizeof(mask) * 8); ++cpu)
+    {
+        if (attributes.hasCpu(cpu))
+        {
+            mask |= ((DWORD_PTR)1) << cpu;
+        }
+    }
+    if ((attributes.numCpus == 0) && (attributes.numaNode >= 0))
+    {
+        // A NUMA node without an explicit CPU list keeps the thread on the node's CPUs.
+        ULONGLONG nodeMask = 0;
+        if (!GetNumaNodeProcessorMask((UCHAR)attributes.numaNode, &nodeMask) || (nodeMask == 0))
+        {
+            FATAL("thread %s: NUMA node %d not found", name, attributes.numaNode);
+        }
+        mask = (DWORD_PTR)nodeMask;
+    }
+    if ((mask != 0) && (SetThreadAffinityMask(GetCurrentThread(), mask) == 0))
+    {
+        FATAL("thread %s SetThreadAffinityMask failed (%lu)", name, GetLastError());
+    }
+    if (attributes.policy != UMLRTThreadAttributes::POLICY_DEFAULT)
+    {
+        // Windows has no FIFO/RR distinction - map the real-time priority onto the thread priority levels.
+        int priority = (attributes.priority >= 50) ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+        if (!SetThreadPriority(GetCurrentThread(), priority))
+        {
+            printf("WARNING: thread %s: SetThreadPriority failed (%lu) - using the default priority.\n", name, GetLastError());
+        }
+    }
+}
+
 // Wait for the thread to complete and get returned value.
 
 void * UMLRTBasicThread::join()
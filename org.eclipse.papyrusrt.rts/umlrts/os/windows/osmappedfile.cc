@@ -0,0 +1,143 @@
+// osmappedfile.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <string.h>
+#include "basedebug.hh"
+#include "umlrtmappedfile.hh"
+
+// platform-dependent implementation of a memory-mapped output file.
+
+typedef struct
+{
+    HANDLE file;
+    HANDLE mapping;
+
+} osmappedfile_handles_t;
+
+UMLRTMappedFile::UMLRTMappedFile ( ) : file(NULL), base(NULL), mapped(0), written(0)
+{
+}
+
+UMLRTMappedFile::~UMLRTMappedFile ( )
+{
+    close();
+}
+
+bool UMLRTMappedFile::open ( const char * fname, size_t initialSize )
+{
+    close();
+
+    HANDLE fh = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+    {
+        BDEBUG(BD_ERROR, "CreateFile(%s) failed: %lu\n", fname, GetLastError());
+        return false;
+    }
+    osmappedfile_handles_t * handles = new osmappedfile_handles_t;
+    handles->file = fh;
+    handles->mapping = NULL;
+    file = handles;
+    written = 0;
+    if (!grow(initialSize))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool UMLRTMappedFile::grow ( size_t required )
+{
+    osmappedfile_handles_t * handles = (osmappedfile_handles_t *)file;
+    size_t newsize = (mapped != 0) ? mapped : 65536;
+
+    while (newsize < required)
+    {
+        newsize *= 2;
+    }
+    if (base != NULL)
+    {
+        UnmapViewOfFile(base);
+        base = NULL;
+    }
+    if (handles->mapping != NULL)
+    {
+        CloseHandle(handles->mapping);
+        handles->mapping = NULL;
+    }
+    handles->mapping = CreateFileMappingA(handles->file, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)newsize >> 32), (DWORD)newsize, NULL);
+    if (handles->mapping == NULL)
+    {
+        BDEBUG(BD_ERROR, "CreateFileMapping failed: %lu\n", GetLastError());
+        return false;
+    }
+    base = (char *)MapViewOfFile(handles->mapping, FILE_MAP_WRITE, 0, 0, newsize);
+    if (base == NULL)
+    {
+        BDEBUG(BD_ERROR, "MapViewOfFile failed: %lu\n", GetLastError());
+        return false;
+    }
+    mapped = newsize;
+    return true;
+}
+
+size_t UMLRTMappedFile::write ( const void * data, size_t size )
+{
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if ((written + size) > mapped)
+    {
+        if (!grow(written + size))
+        {
+            return 0;
+        }
+    }
+    memcpy(base + written, data, size);
+    written += size;
+    return size;
+}
+
+void UMLRTMappedFile::sync ( )
+{
+    if (base != NULL)
+    {
+        FlushViewOfFile(base, written);
+    }
+}
+
+void UMLRTMappedFile::close ( )
+{
+    if (file != NULL)
+    {
+        osmappedfile_handles_t * handles = (osmappedfile_handles_t *)file;
+        if (base != NULL)
+        {
+            UnmapViewOfFile(base);
+        }
+        if (handles->mapping != NULL)
+        {
+            CloseHandle(handles->mapping);
+        }
+        LARGE_INTEGER length;
+        length.QuadPart = written;
+        SetFilePointerEx(handles->file, length, NULL, FILE_BEGIN);
+        SetEndOfFile(handles->file);
+        CloseHandle(handles->file);
+        delete handles;
+    }
+    file = NULL;
+    base = NULL;
+    mapped = 0;
+    written = 0;
+}
@@ -0,0 +1,74 @@
+// osmemoryregion.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include "basedebug.hh"
+#include "umlrtmemoryregion.hh"
+
+// platform-dependent implementation of the pre-faulted memory region allocator.
+
+// Windows has no transparent huge pages - BACKING_THP is served from default-size pages.
+// Large pages need the 'Lock pages in memory' privilege, otherwise BACKING_HUGE falls back too.
+
+static size_t roundUp ( size_t size, size_t granule )
+{
+    return (size + granule - 1) & ~(granule - 1);
+}
+
+static size_t defaultPageSize ( )
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+/*static*/ size_t UMLRTMemoryRegion::pageSize ( Backing backing )
+{
+    size_t largePageSize = GetLargePageMinimum();
+
+    return ((backing == BACKING_HUGE) && (largePageSize != 0)) ? largePageSize : defaultPageSize();
+}
+
+/*static*/ void * UMLRTMemoryRegion::allocate ( size_t & size, Backing & backing )
+{
+    if (backing == BACKING_HUGE)
+    {
+        size_t largePageSize = GetLargePageMinimum();
+        if (largePageSize != 0)
+        {
+            // Large pages are always resident.
+            size_t hugeSize = roundUp(size, largePageSize);
+            void * region = VirtualAlloc(NULL, hugeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (region != NULL)
+            {
+                size = hugeSize;
+                return region;
+            }
+            BDEBUG(BD_ERROR, "VirtualAlloc of %lu bytes of large pages failed (%lu) - using default pages\n", (unsigned long)hugeSize, GetLastError());
+        }
+    }
+    size_t pagesize = defaultPageSize();
+    size_t pagesSize = roundUp(size, pagesize);
+    char * region = (char *)VirtualAlloc(NULL, pagesSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (region == NULL)
+    {
+        BDEBUG(BD_ERROR, "VirtualAlloc of %lu bytes failed (%lu)\n", (unsigned long)pagesSize, GetLastError());
+        return NULL;
+    }
+    // Fault the region in now, a page at a time.
+    for (size_t offset = 0; offset < pagesSize; offset += pagesize)
+    {
+        ((volatile char *)region)[offset] = 0;
+    }
+    backing = BACKING_PAGES;
+    size = pagesSize;
+    return region;
+}
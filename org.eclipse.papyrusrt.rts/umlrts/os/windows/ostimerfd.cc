@@ -0,0 +1,40 @@
+// ostimerfd.cc
+
+/*******************************************************************************
+ * Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *******************************************************************************/
+
+#include "ostimerfd.hh"
+
+// Timer file descriptors are not available - controllers use select() timeouts.
+
+// See ostimerfd.hh for documentation.
+UMLRTTimerFd::UMLRTTimerFd() : fd(-1), armed(false)
+{
+}
+
+UMLRTTimerFd::~UMLRTTimerFd()
+{
+}
+
+bool UMLRTTimerFd::arm( const UMLRTTimespec & relative )
+{
+    return false;
+}
+
+void UMLRTTimerFd::disarm()
+{
+}
+
+int UMLRTTimerFd::getFd()
+{
+    return fd;
+}
+
+void UMLRTTimerFd::clear()
+{
+}
@@ -35,6 +35,17 @@ void UMLRTTimespec::getclock(UMLRTTimespec & tm)
     getclock(&tm);
 }
 
+/*static*/
+void UMLRTTimespec::getmonotonic(UMLRTTimespec * tm)
+{
+    // OSTime::clock_gettime is based on the performance counter.
+    struct timespec ts;
+
+    OSTime::clock_gettime(&ts);
+    tm->tv_sec = (long)ts.tv_sec;
+    tm->tv_nsec = ts.tv_nsec;
+}
+
 /*static*/
 void UMLRTTimespec::timespecAbsAddMsec(struct timespec * timeout, long msec)
 {
@@ -14,6 +14,7 @@
 #include "umlrtcommsport.hh"
 #include "umlrtcommsportrole.hh"
 #include "umlrtcontroller.hh"
+#include "umlrtinvoke.hh"
 #include "umlrtmessagepool.hh"
 #include "umlrtsignalelementpool.hh"
 #include "umlrttimerpool.hh"
@@ -96,6 +97,12 @@ namespace umlrt
             }
             message->isCommand = false;
         }
+        if (message->invoke != NULL)
+        {
+            // Wake the invoker - it has any reply by now.
+            UMLRTInvoke::complete(message);
+            message->invoke = NULL;
+        }
         message->signal = invalid; // Causes application signal element to be 'dereferenced'.
 
         if (!pool)
@@ -17,6 +17,8 @@
 {
     threadargs_t *threadargs = (threadargs_t*)arg;
 
+    threadargs->inst->applyAttributes();
+
     return threadargs->inst->run( threadargs->args );
 }
 
@@ -27,6 +29,13 @@ UMLRTBasicThread::UMLRTBasicThread( const char * name_ ) : tid(0)
     strncpy(name, name_, sizeof(name) - 1);
 }
 
+// Set the attributes applied when the thread is started.
+
+void UMLRTBasicThread::setAttributes( const UMLRTThreadAttributes & attributes_ )
+{
+    attributes = attributes_;
+}
+
 // Return my name
 
 const char * UMLRTBasicThread::getName() const
@@ -80,11 +80,16 @@ void UMLRTCapsule::Serializer::registerField ( const UMLRTObject_field * field,
 
 const char * UMLRTCapsule::Serializer::write ( int currentState )
 {
-    Document document;
-    document.SetObject();
+	StringBuffer buffer;
+	UMLRTJsonWriter writer(buffer);
 
-    Value fields;
-	fields.SetArray();
+	writer.StartObject();
+	if(currentState != -1) {
+		writer.Key("currentState");
+		writer.Int(currentState);
+	}
+	writer.Key("fields");
+	writer.StartArray();
 
 	fieldObjMap->lock();
     UMLRTHashMap::Iterator iter = fieldObjMap->getIterator();
@@ -94,24 +99,18 @@ const char * UMLRTCapsule::Serializer::write ( int currentState )
     		const UMLRTObject_field * field = (const UMLRTObject_field *)iter.getObject();
     		void * data = fieldDataMap->getObject(field->name);
 
-    		Value name;
-    		name.SetString(StringRef(field->name));
-
-    		Value * value = field->desc->toJson(document, field->desc, data, 0, field->arraySize);
-    		value->AddMember("name", name, document.GetAllocator());
-    		fields.PushBack(*value, document.GetAllocator());
+    		writer.StartObject();
+    		writer.Key("name");
+    		writer.String(field->name);
+    		field->desc->toJson(writer, field->desc, data, 0, field->arraySize);
+    		writer.EndObject();
 
         iter = iter.next();
     }
     fieldObjMap->unlock();
 
-    if(currentState != -1)
-    		document.AddMember("currentState", Value().SetInt(currentState), document.GetAllocator());
-    	document.AddMember("fields", fields, document.GetAllocator());
-
-	StringBuffer buffer;
-	Writer<StringBuffer> writer(buffer);
-	document.Accept(writer);
+	writer.EndArray();
+	writer.EndObject();
 	return strdup(buffer.GetString());
 }
 
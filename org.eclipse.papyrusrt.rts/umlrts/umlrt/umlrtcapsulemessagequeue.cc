@@ -0,0 +1,449 @@
+// umlrtcapsulemessagequeue.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "basedebug.hh"
+#include "basedebugtype.hh"
+#include "basefatal.hh"
+#include "umlrtapi.hh"
+#include "umlrtclockcache.hh"
+#include "umlrtslot.hh"
+#include "umlrtcommsportrole.hh"
+#include "umlrtcapsulemessagequeue.hh"
+#include "umlrtprioritymessagequeue.hh"
+#include "umlrtmessage.hh"
+#include "umlrttimer.hh"
+#include "umlrttimerqueue.hh"
+#include <stdlib.h>
+#include <stdio.h>
+
+// See umlrtcapsulemessagequeue.hh for documentation.
+
+UMLRTCapsuleMessageQueue::UMLRTCapsuleMessageQueue ( const char * owner_ )
+    : owner(owner_), nonEmpty(0), total(0), batchNext(0), batchCount(0), batchPriority(PRIORITY_SYNCHRONOUS)
+{
+    for (UMLRTPriority priority = PRIORITY_SYNCHRONOUS; priority < PRIORITY_MAXPLUS1; ++priority)
+    {
+        level[priority].head = level[priority].tail = NULL;
+    }
+}
+
+void UMLRTCapsuleMessageQueue::levelPush ( UMLRTPriority priority, const UMLRTQueueElement * element, bool front )
+{
+    Level & q = level[priority];
+
+    if (q.head == NULL)
+    {
+        element->next = NULL;
+        q.head = q.tail = element;
+        nonEmpty |= (1U << priority);
+    }
+    else if (front)
+    {
+        element->next = q.head;
+        q.head = element;
+    }
+    else
+    {
+        element->next = NULL;
+        q.tail->next = element;
+        q.tail = element;
+    }
+}
+
+const UMLRTQueueElement * UMLRTCapsuleMessageQueue::levelPop ( UMLRTPriority priority )
+{
+    Level & q = level[priority];
+    const UMLRTQueueElement * element = q.head;
+
+    if (element != NULL)
+    {
+        if ((q.head = element->next) == NULL)
+        {
+            nonEmpty &= ~(1U << priority);
+        }
+    }
+    return element;
+}
+
+UMLRTPriority UMLRTCapsuleMessageQueue::highestPriority ( ) const
+{
+    // Lower priority values are higher priorities - find the lowest set bit.
+    UMLRTPriority priority = PRIORITY_SYNCHRONOUS;
+
+    while ((nonEmpty & (1U << priority)) == 0)
+    {
+        ++priority;
+    }
+    return priority;
+}
+
+void UMLRTCapsuleMessageQueue::debugDequeued ( const UMLRTMessage * msg ) const
+{
+    // Source port may no longer exist.
+    BDEBUG(BD_MSG, "%s: msg dequeued priority(%d) -> %s port(%s) [sapIndex0 %d] signal id(%d) qid[%d] name(%s) payloadSz(%d)\n",
+            owner,
+            msg->signal.getPriority(),
+            msg->isCommand ? "" : msg->sap()->slotName(),
+            msg->isCommand ? "isCommand" : msg->sap()->getName(),
+            msg->isCommand ? 0 : msg->sapIndex0(),
+            msg->getSignalId(),
+            msg->signal.getQid(),
+            msg->getSignalName(),
+            msg->signal.getPayloadSize());
+}
+
+// Transfer all messages from a priority-queue.
+size_t UMLRTCapsuleMessageQueue::moveAll ( UMLRTPriorityMessageQueue & fromQueue )
+{
+    size_t moved = 0;
+
+    for (UMLRTPriority priority = PRIORITY_SYNCHRONOUS; priority < PRIORITY_MAXPLUS1; ++priority)
+    {
+        UMLRTMessageQueue & from = fromQueue.getQueue(priority);
+
+        // Unlocked peek - avoids taking the lock of empty levels. A message queued after the peek
+        // is picked up on the next call (the sender's notification guarantees there is one).
+        if (!from.isEmpty())
+        {
+            const UMLRTQueueElement * last; // These are UMLRTMessage's.
+            size_t count;
+            const UMLRTQueueElement * all = from.dequeueAll(&last, &count);
+
+            if (all != NULL)
+            {
+                if (priority < batchPriority)
+                {
+                    // Higher priority messages have arrived - they must preempt the current batch.
+                    endBatch();
+                }
+                Level & q = level[priority];
+                if (q.head == NULL)
+                {
+                    q.head = all;
+                    nonEmpty |= (1U << priority);
+                }
+                else
+                {
+                    q.tail->next = all;
+                }
+                q.tail = last;
+                total += count;
+                moved += count;
+            }
+        }
+    }
+    return moved;
+}
+
+// Re-arm an interval timer for its next interval. The new due-time is derived from the previous one (not the clock),
+// so the timer does not drift. Returns the number of intervals skipped according to the timer's overrun policy.
+static unsigned int rearmIntervalTimer ( UMLRTTimer * timer, const UMLRTTimespec & now )
+{
+    timer->due += timer->interval;
+
+    if (timer->due > now)
+    {
+        // On time.
+        return 0;
+    }
+    const int64_t NSEC_PER_SEC = 1000000000LL;
+    int64_t interval = timer->interval.tv_sec * NSEC_PER_SEC + timer->interval.tv_nsec;
+
+    if ((timer->overrunPolicy == UMLRTTimerProtocol::OVERRUN_CATCHUP) || (interval <= 0))
+    {
+        // The next timeout is already due - it will be delivered late, in a burst with this one.
+        ++timer->overruns;
+        return 0;
+    }
+    // Skip ahead to the first interval which has not yet passed.
+    UMLRTTimespec late = now - timer->due;
+    unsigned int skipped = (unsigned int)((late.tv_sec * NSEC_PER_SEC + late.tv_nsec) / interval) + 1;
+    int64_t advance = interval * skipped;
+
+    timer->due += UMLRTTimespec(advance / NSEC_PER_SEC, advance % NSEC_PER_SEC);
+    timer->overruns += skipped;
+
+    return skipped;
+}
+
+// Get all expired timers from the timer-queue and enqueue these to this queue.
+void UMLRTCapsuleMessageQueue::queueTimerMessages ( UMLRTTimerQueue * timerQueue, UMLRTClockCache & now )
+{
+    // All timers are compared against the same 'now' and interval timers are re-armed relative to it.
+    UMLRTTimer * timer = timerQueue->dequeue(now);
+
+    while (timer != NULL)
+    {
+        if (!timer->allocated)
+        {
+            FATAL("%s:timer (%p) obtained from timer-queue is not allocated.", owner, timer);
+        }
+        UMLRTMessage * msg = umlrt::MessageGetFromPool();
+
+        if (!msg)
+        {
+            FATAL("message allocation failed during timout message creation.");
+        }
+        char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
+        BDEBUG(BD_TIMER, "%s: queue timer msg signal id(%d) to %s(%s) isInterval(%d) due(%s)\n",
+                owner, timer->signal.getId(), timer->destPort->slotName(), timer->sap()->getName(), timer->isInterval,
+                timer->isClockTime ? timer->due.toString(tmbuf, sizeof(tmbuf)) : timer->due.toStringRelative(tmbuf, sizeof(tmbuf)));
+
+        unsigned int skipped = 0;
+        if (timer->isInterval)
+        {
+            // This is an interval timer. Adjust it's due-time before building the timeout - a coalesced
+            // timeout carries the number of intervals skipped.
+            // Interval timers run on the monotonic clock - no time-adjustment lock is required.
+            if ((skipped = rearmIntervalTimer(timer, now.monotonic())) > 0)
+            {
+                BDEBUG(BD_TIMER, "%s: timer(%p) to %s(%s) skipped %u intervals policy(%d)\n",
+                        owner, timer, timer->destPort->slotName(), timer->sap()->getName(), skipped, timer->overrunPolicy);
+            }
+        }
+        if (timer->overrunPolicy == UMLRTTimerProtocol::OVERRUN_COALESCE)
+        {
+            int overruns = (int)skipped;
+            msg->signal.initialize("timeout", UMLRTTimerProtocol::signal_timeout, timer->destPort, &UMLRTType_int, &overruns, timer->signal.getPriority());
+        }
+        else
+        {
+            msg->signal = timer->signal;
+        }
+        msg->destPort = timer->destPort;
+        msg->destSlot = timer->destSlot;
+        msg->srcPortIndex = 0; // Timer ports are not replicated.
+        msg->isCommand = false;
+
+        enqueue(msg);
+
+        if (timer->isInterval)
+        {
+            timerQueue->enqueue(timer);
+        }
+        else
+        {
+            // This timer can be put back on the system pool.
+            umlrt::TimerPutToPool(timer);
+        }
+
+        // See if there's another one expired.
+        timer = timerQueue->dequeue(now);
+    }
+}
+
+// Get the highest priority message.
+UMLRTMessage * UMLRTCapsuleMessageQueue::dequeueHighestPriority ( )
+{
+    UMLRTMessage * msg = nextInBatch();
+
+    if ((msg == NULL) && (nonEmpty != 0))
+    {
+        msg = (UMLRTMessage *)levelPop(highestPriority());
+        --total;
+        debugDequeued(msg);
+    }
+    return msg;
+}
+
+// Start a batch of messages of the highest priority.
+size_t UMLRTCapsuleMessageQueue::dequeueBatch ( size_t maxCount )
+{
+    endBatch();
+
+    if (maxCount > USER_CONFIG_CONTROLLER_BATCH_SIZE)
+    {
+        maxCount = USER_CONFIG_CONTROLLER_BATCH_SIZE;
+    }
+    if (nonEmpty != 0)
+    {
+        batchPriority = highestPriority();
+
+        const UMLRTQueueElement * element;
+        while ((batchCount < maxCount) && ((element = levelPop(batchPriority)) != NULL))
+        {
+            batch[batchCount++] = (UMLRTMessage *)element;
+        }
+    }
+    return batchCount;
+}
+
+// Return the next message of the current batch.
+UMLRTMessage * UMLRTCapsuleMessageQueue::nextInBatch ( )
+{
+    UMLRTMessage * msg = NULL;
+
+    while ((msg == NULL) && (batchNext < batchCount))
+    {
+        msg = batch[batchNext++];
+    }
+    if (msg != NULL)
+    {
+        --total;
+        debugDequeued(msg);
+    }
+    return msg;
+}
+
+// Return the next message of the current batch if it is a signal to 'slot'.
+UMLRTMessage * UMLRTCapsuleMessageQueue::nextInBatchFor ( const UMLRTSlot * slot )
+{
+    // Skip messages purged from the batch.
+    while ((batchNext < batchCount) && (batch[batchNext] == NULL))
+    {
+        ++batchNext;
+    }
+    UMLRTMessage * msg = (batchNext < batchCount) ? batch[batchNext] : NULL;
+
+    if ((msg == NULL) || msg->isCommand || (msg->destSlot != slot))
+    {
+        return NULL;
+    }
+    ++batchNext;
+    --total;
+    debugDequeued(msg);
+
+    return msg;
+}
+
+// Return any messages remaining in the current batch to the front of their level (in order).
+void UMLRTCapsuleMessageQueue::endBatch ( )
+{
+    while (batchCount > batchNext)
+    {
+        UMLRTMessage * msg = batch[--batchCount];
+        if (msg != NULL)
+        {
+            levelPush(batchPriority, msg, true/*front*/);
+        }
+    }
+    batchNext = batchCount = 0;
+}
+
+// Put the message into its appropriate priority level.
+void UMLRTCapsuleMessageQueue::enqueue ( UMLRTMessage * msg, bool front )
+{
+    UMLRTPriority priority = msg->signal.getPriority();
+
+    if ((priority < PRIORITY_SYNCHRONOUS) || (priority >= PRIORITY_MAXPLUS1))
+    {
+        FATAL("enqueue with bad priority (%d)", priority);
+    }
+    if (!msg->isCommand && msg->destPort == NULL)
+    {
+        FATAL("enqueuing a message with no destination port");
+    }
+    // Source port may no longer exist.
+    BDEBUG(BD_MSG, "%s: msg enqueued priority(%d) -> capsule %s port %s[%d] signal id(%d)(%s) payloadSz(%d)\n",
+            owner,
+            msg->signal.getPriority(),
+            msg->isCommand ? "(no capsule)" : msg->sap()->slotName(),
+            msg->isCommand ? "isCommand" : msg->sap()->getName(),
+            msg->isCommand ? 0 : msg->sapIndex0(),
+            msg->getSignalId(),
+            msg->getSignalName(),
+            msg->signal.getPayloadSize());
+
+    if ((batchNext < batchCount) && ((priority < batchPriority) || (front && (priority == batchPriority))))
+    {
+        // This message must be injected before the rest of the batch.
+        endBatch();
+    }
+    levelPush(priority, msg, front);
+    ++total;
+}
+
+void UMLRTCapsuleMessageQueue::enqueueAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count )
+{
+    UMLRTPriority priority = first->signal.getPriority();
+
+    if ((priority < PRIORITY_SYNCHRONOUS) || (priority >= PRIORITY_MAXPLUS1))
+    {
+        FATAL("enqueueAll with bad priority (%d)", priority);
+    }
+    BDEBUG(BD_MSG, "%s: %d msgs enqueued priority(%d) signal id(%d)(%s) payloadSz(%d)\n",
+            owner,
+            count,
+            priority,
+            first->getSignalId(),
+            first->getSignalName(),
+            first->signal.getPayloadSize());
+
+    if ((batchNext < batchCount) && (priority < batchPriority))
+    {
+        // These messages must be injected before the rest of the batch.
+        endBatch();
+    }
+    Level & q = level[priority];
+    if (q.head == NULL)
+    {
+        q.head = first;
+        nonEmpty |= (1U << priority);
+    }
+    else
+    {
+        q.tail->next = first;
+    }
+    q.tail = last;
+    total += count;
+}
+
+void UMLRTCapsuleMessageQueue::remove ( UMLRTQueue::match_compare_t callback, UMLRTQueue::match_notify_t notify, void * userData )
+{
+    for (size_t i = batchNext; i < batchCount; ++i)
+    {
+        if ((batch[i] != NULL) && callback(batch[i], userData))
+        {
+            UMLRTMessage * msg = batch[i];
+            batch[i] = NULL;
+            --total;
+            notify(msg, userData);
+        }
+    }
+    for (UMLRTPriority priority = PRIORITY_SYNCHRONOUS; priority < PRIORITY_MAXPLUS1; ++priority)
+    {
+        Level & q = level[priority];
+        const UMLRTQueueElement * prev = NULL;
+        const UMLRTQueueElement * element = q.head;
+
+        while (element != NULL)
+        {
+            const UMLRTQueueElement * next = element->next;
+
+            if (callback(element, userData))
+            {
+                // Unlink before notifying - the notify callback may requeue or free the element.
+                if (prev == NULL)
+                {
+                    q.head = next;
+                }
+                else
+                {
+                    prev->next = next;
+                }
+                if (next == NULL)
+                {
+                    q.tail = prev;
+                }
+                --total;
+                notify(element, userData);
+            }
+            else
+            {
+                prev = element;
+            }
+            element = next;
+        }
+        if (q.head == NULL)
+        {
+            nonEmpty &= ~(1U << priority);
+        }
+    }
+}
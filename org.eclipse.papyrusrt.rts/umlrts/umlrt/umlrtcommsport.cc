@@ -13,20 +13,6 @@
 #include "umlrtmessage.hh"
 #include "umlrtqueue.hh"
 
-/*static*/ bool UMLRTCommsPort::purgeMatchCompare( UMLRTMessage * msg, const PurgeRecall * purge )
-{
-    bool match = true;
-    if (purge->index != -1)
-    {
-        match = (purge->index == (int)msg->sapIndex0());
-        if (match && (purge->id != -1))
-        {
-            match = (purge->id == (int)msg->signal.getId());
-        }
-    }
-    return match;
-}
-
 /*static*/ void UMLRTCommsPort::purgeMatchNotify( UMLRTMessage * msg, const PurgeRecall * purge )
 {
     umlrt::MessagePutToPool(msg);
@@ -38,22 +24,12 @@ int UMLRTCommsPort::purge( int index, int id ) const
     const PurgeRecall purge = { index, false/*front*/, id };
     if (deferQueue != NULL)
     {
-        count = deferQueue->remove( (UMLRTQueue::match_compare_t)purgeMatchCompare, (UMLRTQueue::match_notify_t)purgeMatchNotify, (void *)&purge );
+        count = deferQueue->remove( index, id, false/*one*/, (UMLRTDeferQueue::match_notify_t)purgeMatchNotify, (void *)&purge );
     }
     return count;
 }
 
 
-/*static*/ bool UMLRTCommsPort::recallMatchCompare( UMLRTMessage * msg, const PurgeRecall * recall )
-{
-    bool match = true;
-    if (recall->index != -1)
-    {
-        match = (recall->index == (int)msg->sapIndex0());
-    }
-    return match;
-}
-
 /*static*/ void UMLRTCommsPort::recallMatchNotify( UMLRTMessage * msg, const PurgeRecall * recall )
 {
     msg->destPort->slot->controller->recall( msg, recall->front );
@@ -66,7 +42,7 @@ int UMLRTCommsPort::recall( int index, bool front, bool one, int id  ) const
 
     if (deferQueue != NULL)
     {
-        count = deferQueue->remove( (UMLRTQueue::match_compare_t)recallMatchCompare, (UMLRTQueue::match_notify_t)recallMatchNotify, (void *)&recall, one );
+        count = deferQueue->remove( index, id, one, (UMLRTDeferQueue::match_notify_t)recallMatchNotify, (void *)&recall );
     }
     return count;
 }
@@ -9,7 +9,11 @@
 #include "basedebug.hh"
 #include "basefatal.hh"
 #include "umlrtcommunicator.hh"
+#include "umlrtcompressor.hh"
+#include "umlrtguard.hh"
 #include "umlrthost.hh"
+#include "umlrttimespec.hh"
+#include "umlrtuserconfig.hh"
 #include "nanomsg/nn.h"
 #include "nanomsg/pair.h"
 #include "nanomsg/reqrep.h"
@@ -22,8 +26,30 @@
 #include <rapidjson/writer.h>
 using namespace rapidjson;
 
+/*static*/ size_t UMLRTCommunicator::compressThreshold = USER_CONFIG_LINK_COMPRESS_THRESHOLD;
+/*static*/ size_t UMLRTCommunicator::highWater = USER_CONFIG_LINK_HIGH_WATER;
+/*static*/ size_t UMLRTCommunicator::lowWater = USER_CONFIG_LINK_LOW_WATER;
+
+/*static*/ void UMLRTCommunicator::setCompressThreshold ( size_t bytes )
+{
+	compressThreshold = bytes;
+}
+
+/*static*/ void UMLRTCommunicator::setWaterMarks ( size_t high, size_t low )
+{
+	highWater = high;
+	lowWater = (low < high) ? low : high;
+}
+
+static uint64_t elapsedNsec ( const UMLRTTimespec & start )
+{
+	UMLRTTimespec now;
+	UMLRTTimespec::getmonotonic(&now);
+	return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL + now.tv_nsec - start.tv_nsec;
+}
+
 UMLRTCommunicator::UMLRTCommunicator ( const char * _localaddr )
-	: localaddr(_localaddr), abort(false)
+	: localaddr(_localaddr), abort(false), creditFreed(0), creditWaiters(0), creditRound(0)
 {
 	localsock = nn_socket(AF_SP, NN_REP);
 	if( nn_bind (localsock, localaddr) < 0 )
@@ -41,13 +67,13 @@ void UMLRTCommunicator::setLocalHost( UMLRTHost * host )
 
 void UMLRTCommunicator::sendDeployment ( UMLRTHost * host )
 {
-	const char * deploymentJson = UMLRTDeploymentMap::encode( );
+	char * deploymentJson = UMLRTDeploymentMap::encode( host );
 
 	Document document;
 	document.SetObject();
 	Document::AllocatorType& allocator = document.GetAllocator();
 
-	Value sender, receiver, deployment;
+	Value sender, receiver, deployment, compress(compressThreshold > 0);
 	sender.SetString(StringRef(localhost->name));
 	receiver.SetString(StringRef(host->name));
 	deployment.SetString(StringRef(deploymentJson));
@@ -55,6 +81,7 @@ void UMLRTCommunicator::sendDeployment ( UMLRTHost * host )
 	document.AddMember("sender", sender, allocator);
 	document.AddMember("receiver", receiver, allocator);
 	document.AddMember("deployment", deployment, allocator);
+	document.AddMember("compress", compress, allocator);
 
 	StringBuffer buffer;
 	Writer<StringBuffer> writer(buffer);
@@ -62,7 +89,8 @@ void UMLRTCommunicator::sendDeployment ( UMLRTHost * host )
 
 	if ( nn_send (host->socket, buffer.GetString(), buffer.GetSize(), 0) < 0 )
 		FATAL("Error sending deployment to host  %s\n", host->name);
-	
+	free(deploymentJson);
+
 	host->deployed = true;
 
 	//printf("Sent deployment to host @ %s\n", host->address);
@@ -85,6 +113,14 @@ const char * UMLRTCommunicator::waitForDeployment ( )
 	const char * deployment = document["deployment"].GetString();
 
 	UMLRTDeploymentMap::decode( deployment );
+
+	// The deploying host offers compression - accept if we compress too. Our answer goes back in the ready signal.
+	if( document.HasMember("compress") && document["compress"].GetBool() && (compressThreshold > 0) )
+	{
+		UMLRTHost * peer = UMLRTDeploymentMap::getHostFromName(sender);
+		if( peer != NULL )
+			peer->compress = true;
+	}
 	return sender;
 
 	//printf("Got deployment");
@@ -96,13 +132,14 @@ void UMLRTCommunicator::sendReadySignal ( UMLRTHost * host )
 	document.SetObject();
 	Document::AllocatorType& allocator = document.GetAllocator();
 
-	Value sender, receiver, ready(true);
+	Value sender, receiver, ready(true), compress(host->compress);
 	sender.SetString(StringRef(localhost->name));
 	receiver.SetString(StringRef(host->name));
 
 	document.AddMember("sender", sender, allocator);
 	document.AddMember("receiver", receiver, allocator);
 	document.AddMember("ready", ready, allocator);
+	document.AddMember("compress", compress, allocator);
 
 	StringBuffer buffer;
 	Writer<StringBuffer> writer(buffer);
@@ -162,6 +199,7 @@ void UMLRTCommunicator::waitForReadySignal ( UMLRTHost * host )
 	ready = document["ready"].GetBool();
 	if(ready)
 		host->gotack = true;
+	host->compress = document.HasMember("compress") && document["compress"].GetBool() && (compressThreshold > 0);
 
 	//printf("Got ready signal from %s\n", (char*) buffer);
 }
@@ -210,9 +248,117 @@ void UMLRTCommunicator::disconnect ( UMLRTHost * host )
 	host->connected = false;
 }
 
-void UMLRTCommunicator::queueMessage ( UMLRTCommunicator::Message* msg )
+bool UMLRTCommunicator::takeCredit ( UMLRTHost * host )
+{
+	if( highWater == 0 )
+	{
+		++host->queued;
+		return true;
+	}
+	if( host->congested )
+		return false;
+
+	if( ++host->queued >= highWater )
+		host->congested = true; // This was the last credit.
+	return true;
+}
+
+void UMLRTCommunicator::returnCredit ( UMLRTHost * host )
+{
+	UMLRTGuard g(creditMutex);
+
+	--host->queued;
+	if( host->congested && (host->queued <= lowWater) )
+	{
+		host->congested = false;
+
+		// Waiters for other links go back to waiting.
+		for( ; creditWaiters > 0; --creditWaiters )
+			creditFreed.post();
+		++creditRound;
+	}
+}
+
+UMLRTCommunicator::QueueResult UMLRTCommunicator::queueMessage ( UMLRTCommunicator::Message* msg, UMLRTLinkPolicy policy )
 {
+	UMLRTHost * host = msg->destHost;
+	QueueResult result = QUEUED;
+	{
+		UMLRTGuard g(creditMutex);
+
+		if( !takeCredit(host) )
+		{
+			switch( policy )
+			{
+			case LINK_POLICY_BLOCK:
+				return WOULD_BLOCK; // Caller keeps the frame.
+			case LINK_POLICY_DROP:
+				host->framesDropped++;
+				result = DROPPED;
+				break;
+			default:
+				host->framesRefused++;
+				result = REFUSED;
+				break;
+			}
+		}
+	}
+	if( result != QUEUED )
+	{
+		BDEBUG(BD_SEND, "link to host %s out of credit (%d frames queued) - signal %s %s\n", host->name, host->queued, msg->signalName,
+				(result == DROPPED) ? "dropped" : "refused");
+		msg->release();
+		delete msg;
+		return result;
+	}
 	messageQueue.enqueue(msg);
+	return QUEUED;
+}
+
+UMLRTCommunicator::QueueResult UMLRTCommunicator::queueMessageWait ( UMLRTCommunicator::Message* msg )
+{
+	UMLRTHost * host = msg->destHost;
+	UMLRTTimespec start;
+	UMLRTTimespec::getmonotonic(&start);
+	bool queued = false;
+	{
+		UMLRTGuard g(creditMutex);
+
+		host->sendsBlocked++;
+		queued = takeCredit(host);
+	}
+	while( !queued )
+	{
+		uint64_t waitedMsec = elapsedNsec(start) / 1000000;
+		if( waitedMsec >= USER_CONFIG_LINK_BLOCK_MSEC )
+			break;
+
+		size_t round;
+		{
+			UMLRTGuard g(creditMutex);
+			++creditWaiters;
+			round = creditRound;
+		}
+		bool woken = creditFreed.wait((uint32_t)(USER_CONFIG_LINK_BLOCK_MSEC - waitedMsec));
+
+		UMLRTGuard g(creditMutex);
+		if( !woken && (round == creditRound) )
+			--creditWaiters; // Timed out before anyone counted us out.
+		queued = takeCredit(host);
+	}
+	if( !queued )
+	{
+		{
+			UMLRTGuard g(creditMutex);
+			host->framesRefused++;
+		}
+		BDEBUG(BD_SEND, "link to host %s still out of credit after %d msec - signal %s refused\n", host->name, USER_CONFIG_LINK_BLOCK_MSEC, msg->signalName);
+		msg->release();
+		delete msg;
+		return REFUSED;
+	}
+	messageQueue.enqueue(msg);
+	return QUEUED;
 }
 
 UMLRTCommunicator::Message* UMLRTCommunicator::sendrecv()
@@ -227,19 +373,53 @@ UMLRTCommunicator::Message* UMLRTCommunicator::sendrecv()
 		document.SetObject();
 		Document::AllocatorType& allocator = document.GetAllocator();
 
-		Value destSlot, srcSlot, protocolName, signalName, payload;
-		destSlot.SetString(StringRef(msg->destSlot));
+		UMLRTHost * host = msg->destHost;
+
+		// Large payloads on compressing links follow the frame header as binary (see below).
+		uint8_t * packed = NULL;
+		size_t packedSize = 0;
+		if( host->compress && (compressThreshold > 0) && ((size_t)msg->payloadSize >= compressThreshold) )
+		{
+			UMLRTTimespec start;
+			UMLRTTimespec::getmonotonic(&start);
+
+			size_t capacity = UMLRTCompressor::bound(msg->payloadSize);
+			if( (packed = (uint8_t *)malloc(capacity)) == NULL )
+				FATAL("compression buffer malloc(%d) failed", capacity);
+			packedSize = UMLRTCompressor::compress((const uint8_t *)msg->payload, msg->payloadSize, packed, capacity);
+			host->compressNsec += elapsedNsec(start);
+
+			if( (packedSize == 0) || (packedSize >= (size_t)msg->payloadSize) )
+			{
+				// Incompressible - send as text.
+				free(packed);
+				packed = NULL;
+			}
+		}
+
+		Value dests(kArrayType), srcSlot, protocolName, signalName, payload;
 		srcSlot.SetString(StringRef(msg->srcSlot));
 		protocolName.SetString(StringRef(msg->protocolName));
 		signalName.SetString(StringRef(msg->signalName));
-		payload.SetString(StringRef(msg->payload));
+		if( packed == NULL )
+			payload.SetString(StringRef(msg->payload));
 
-		Value destPort(msg->destPort), srcPort(msg->srcPort), payloadSize(msg->payloadSize);
-		Value destInternal(msg->destInternal), srcInternal(msg->srcInternal);
+		for( size_t i = 0; i < msg->dests.size(); i++ )
+		{
+			Value dest(kObjectType), destSlot, destPort(msg->dests[i].port), destInternal(msg->dests[i].internal), srcPortIndex(msg->dests[i].srcPortIndex);
+			destSlot.SetString(StringRef(msg->dests[i].slot.c_str()));
 
-		document.AddMember("destSlot", destSlot, allocator);
-		document.AddMember("destPort", destPort, allocator);
-		document.AddMember("destInternal", destInternal, allocator);
+			dest.AddMember("slot", destSlot, allocator);
+			dest.AddMember("port", destPort, allocator);
+			dest.AddMember("internal", destInternal, allocator);
+			dest.AddMember("srcPortIndex", srcPortIndex, allocator);
+			dests.PushBack(dest, allocator);
+		}
+
+		Value srcPort(msg->srcPort), payloadSize(msg->payloadSize);
+		Value srcInternal(msg->srcInternal);
+
+		document.AddMember("dests", dests, allocator);
 
 		document.AddMember("srcSlot", srcSlot, allocator);
 		document.AddMember("srcPort", srcPort, allocator);
@@ -248,18 +428,56 @@ UMLRTCommunicator::Message* UMLRTCommunicator::sendrecv()
 		document.AddMember("protocolName", protocolName, allocator);
 		document.AddMember("signalName", signalName, allocator);
 
-		document.AddMember("payload", payload, allocator);
+		if( packed == NULL )
+		{
+			document.AddMember("payload", payload, allocator);
+		}
+		else
+		{
+			Value sender, payloadEncoding("lz4"), compressedSize((uint64_t)packedSize);
+			sender.SetString(StringRef(localhost->name));
+			document.AddMember("sender", sender, allocator);
+			document.AddMember("payloadEncoding", payloadEncoding, allocator);
+			document.AddMember("compressedSize", compressedSize, allocator);
+		}
 		document.AddMember("payloadSize", payloadSize, allocator);
 
 		StringBuffer buffer;
 		Writer<StringBuffer> writer(buffer);
 		document.Accept(writer);
 
-		if ( nn_send (msg->destHost->socket, buffer.GetString(), buffer.GetSize(), 0) < 0 )
-			FATAL("Error sending message %s to host @ %s\n", buffer.GetString(), msg->destHost->name);
+		host->framesSent++;
+		if( packed == NULL )
+		{
+			if ( nn_send (host->socket, buffer.GetString(), buffer.GetSize(), 0) < 0 )
+				FATAL("Error sending message %s to host @ %s\n", buffer.GetString(), host->name);
+		}
+		else
+		{
+			// Frame is the header, its terminating '\0', then the compressed payload.
+			size_t frameSize = buffer.GetSize() + 1 + packedSize;
+			uint8_t * frame = (uint8_t *)malloc(frameSize);
+			if( frame == NULL )
+				FATAL("frame malloc(%d) failed", frameSize);
+			memcpy(frame, buffer.GetString(), buffer.GetSize() + 1);
+			memcpy(frame + buffer.GetSize() + 1, packed, packedSize);
+
+			if ( nn_send (host->socket, frame, frameSize, 0) < 0 )
+				FATAL("Error sending message %s to host @ %s\n", buffer.GetString(), host->name);
+
+			BDEBUG(BD_SERIALIZE, "payload of signal %s to host %s compressed %d -> %d bytes\n", msg->signalName, host->name, msg->payloadSize, packedSize);
+
+			host->framesCompressed++;
+			host->bytesBeforeCompression += msg->payloadSize;
+			host->bytesAfterCompression += packedSize;
+			free(frame);
+			free(packed);
+		}
 		
 		//printf("Sent message %s to host @ %s\n", buffer.GetString(), msg->destHost->name);
 
+		returnCredit(host);
+
 		msg->release();
 		delete msg;
 	}
@@ -274,9 +492,15 @@ UMLRTCommunicator::Message* UMLRTCommunicator::sendrecv()
 		Document document;
 		document.Parse(strdup((const char*)buffer));
 
-        msg->destSlot = document["destSlot"].GetString();
-        msg->destPort = document["destPort"].GetInt();
-        msg->destInternal = document["destInternal"].GetBool();
+        const Value & dests = document["dests"];
+        msg->dests.resize(dests.Size());
+        for( SizeType i = 0; i < dests.Size(); i++ )
+        {
+            msg->dests[i].slot = dests[i]["slot"].GetString();
+            msg->dests[i].port = dests[i]["port"].GetInt();
+            msg->dests[i].internal = dests[i]["internal"].GetBool();
+            msg->dests[i].srcPortIndex = dests[i]["srcPortIndex"].GetInt();
+        }
 
         msg->srcSlot = document["srcSlot"].GetString();
         msg->srcPort = document["srcPort"].GetInt();
@@ -286,7 +510,35 @@ UMLRTCommunicator::Message* UMLRTCommunicator::sendrecv()
         msg->signalName = document["signalName"].GetString();
 
         msg->payloadSize = document["payloadSize"].GetInt();
-        msg->payload = strdup(document["payload"].GetString());
+        if( !document.HasMember("payloadEncoding") )
+        {
+            msg->payload = strdup(document["payload"].GetString());
+        }
+        else
+        {
+            // Compressed payload follows the header and its '\0'.
+            size_t headerSize = strlen(buffer) + 1;
+            size_t compressedSize = document["compressedSize"].GetUint64();
+            if( (strcmp(document["payloadEncoding"].GetString(), "lz4") != 0) || (headerSize + compressedSize != (size_t)recv) )
+                FATAL("Received malformed compressed frame (%d bytes)", recv);
+
+            UMLRTTimespec start;
+            UMLRTTimespec::getmonotonic(&start);
+
+            char * payload = (char *)malloc(msg->payloadSize);
+            if( payload == NULL )
+                FATAL("payload malloc(%d) failed", msg->payloadSize);
+            if( !UMLRTCompressor::decompress((const uint8_t *)buffer + headerSize, compressedSize, (uint8_t *)payload, msg->payloadSize) )
+                FATAL("Received corrupt compressed payload");
+            msg->payload = payload;
+
+            UMLRTHost * peer = UMLRTDeploymentMap::getHostFromName(document["sender"].GetString());
+            if( peer != NULL )
+            {
+                peer->framesDecompressed++;
+                peer->decompressNsec += elapsedNsec(start);
+            }
+        }
 
         //printf("Received message: %s\n", buffer);
        // printf("Received message %s,%d,%s,%d,%s,%s,%d,%s\n", msg->destSlot, msg->destPort, msg->srcSlot, msg->srcPort, msg->protocolName, msg->signalName, msg->payloadSize, msg->payload);
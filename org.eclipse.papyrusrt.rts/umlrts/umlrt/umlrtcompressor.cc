@@ -0,0 +1,223 @@
+// umlrtcompressor.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtcompressor.hh"
+#include <string.h>
+
+// See umlrtcompressor.hh for documentation.
+
+// LZ4 block format constraints.
+#define MIN_MATCH       4       // Shortest match encoded.
+#define LAST_LITERALS   5       // The last bytes of a block are always literals.
+#define MF_LIMIT        12      // The last match must start at least this far from the end.
+#define MAX_DISTANCE    65535   // Largest match offset.
+#define HASH_LOG        12      // Match-finder table of 4K positions.
+
+static inline uint32_t read32 ( const uint8_t * p )
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash32 ( uint32_t v )
+{
+    return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+// Append a length continuation (the part beyond the 4-bit token field). Returns NULL if it does not fit.
+static uint8_t * putLength ( uint8_t * op, const uint8_t * oend, size_t length )
+{
+    while (length >= 255)
+    {
+        if (op >= oend)
+        {
+            return NULL;
+        }
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= oend)
+    {
+        return NULL;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Append one sequence: literals followed by an optional match (matchLength == 0 for the final sequence).
+static uint8_t * putSequence ( uint8_t * op, const uint8_t * oend, const uint8_t * literals, size_t literalLength, size_t offset, size_t matchLength )
+{
+    if (op >= oend)
+    {
+        return NULL;
+    }
+    uint8_t * token = op++;
+    size_t matchCode = (matchLength > 0) ? matchLength - MIN_MATCH : 0;
+
+    *token = (uint8_t)(((literalLength < 15) ? literalLength : 15) << 4);
+    if ((literalLength >= 15) && ((op = putLength(op, oend, literalLength - 15)) == NULL))
+    {
+        return NULL;
+    }
+    if ((size_t)(oend - op) < literalLength)
+    {
+        return NULL;
+    }
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    if (matchLength > 0)
+    {
+        if (oend - op < 2)
+        {
+            return NULL;
+        }
+        *op++ = (uint8_t)(offset & 0xff);
+        *op++ = (uint8_t)(offset >> 8);
+        *token |= (uint8_t)((matchCode < 15) ? matchCode : 15);
+        if ((matchCode >= 15) && ((op = putLength(op, oend, matchCode - 15)) == NULL))
+        {
+            return NULL;
+        }
+    }
+    return op;
+}
+
+/*static*/ size_t UMLRTCompressor::compress ( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstCapacity )
+{
+    uint32_t table[1 << HASH_LOG];
+    uint8_t * op = dst;
+    const uint8_t * const oend = dst + dstCapacity;
+    size_t anchor = 0;
+
+    if (srcSize > MF_LIMIT)
+    {
+        const size_t mfLimit = srcSize - MF_LIMIT;
+        const size_t matchLimit = srcSize - LAST_LITERALS;
+        size_t ip = 0;
+
+        memset(table, 0, sizeof(table));
+
+        while (ip < mfLimit)
+        {
+            uint32_t h = hash32(read32(src + ip));
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+
+            if ((ref >= ip) || ((ip - ref) > MAX_DISTANCE) || (read32(src + ref) != read32(src + ip)))
+            {
+                ++ip;
+                continue;
+            }
+            // Extend the match backwards into the pending literals, then forwards.
+            while ((ip > anchor) && (ref > 0) && (src[ip - 1] == src[ref - 1]))
+            {
+                --ip;
+                --ref;
+            }
+            size_t length = MIN_MATCH;
+            while (((ip + length) < matchLimit) && (src[ip + length] == src[ref + length]))
+            {
+                ++length;
+            }
+            if ((op = putSequence(op, oend, src + anchor, ip - anchor, ip - ref, length)) == NULL)
+            {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+
+            // Index a position inside the match so runs are found again quickly.
+            if (ip < mfLimit)
+            {
+                table[hash32(read32(src + ip - 2))] = (uint32_t)(ip - 2);
+            }
+        }
+    }
+    if ((op = putSequence(op, oend, src + anchor, srcSize - anchor, 0, 0)) == NULL)
+    {
+        return 0;
+    }
+    return op - dst;
+}
+
+/*static*/ bool UMLRTCompressor::decompress ( const uint8_t * src, size_t srcSize, uint8_t * dst, size_t dstSize )
+{
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < srcSize)
+    {
+        uint8_t token = src[ip++];
+        size_t length = token >> 4;
+
+        if (length == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= srcSize)
+                {
+                    return false;
+                }
+                b = src[ip++];
+                length += b;
+            } while (b == 255);
+        }
+        if ((length > (srcSize - ip)) || (length > (dstSize - op)))
+        {
+            return false;
+        }
+        memcpy(dst + op, src + ip, length);
+        ip += length;
+        op += length;
+
+        if (ip == srcSize)
+        {
+            break; // The final sequence has no match.
+        }
+        if ((srcSize - ip) < 2)
+        {
+            return false;
+        }
+        size_t offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > op))
+        {
+            return false;
+        }
+        length = token & 15;
+        if (length == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= srcSize)
+                {
+                    return false;
+                }
+                b = src[ip++];
+                length += b;
+            } while (b == 255);
+        }
+        length += MIN_MATCH;
+        if (length > (dstSize - op))
+        {
+            return false;
+        }
+        // Byte copy - the match may overlap the bytes it produces.
+        for (size_t i = 0; i < length; ++i, ++op)
+        {
+            dst[op] = dst[op - offset];
+        }
+    }
+    return op == dstSize;
+}
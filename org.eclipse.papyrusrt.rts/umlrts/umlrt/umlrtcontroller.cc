@@ -23,17 +23,22 @@
 #include "umlrtcommsportfarend.hh"
 #include "umlrtcommsportrole.hh"
 #include "umlrtcontrollercommand.hh"
+#include "umlrtcontrollerpool.hh"
 #include "umlrtframeservice.hh"
+#include "umlrtmessagepool.hh"
 #include "umlrtobjectclass.hh"
 #include "umlrtpriority.hh"
 #include "umlrtprotocol.hh"
 #include "umlrtsignal.hh"
+#include "umlrtsignalelementpool.hh"
 #include "umlrttimer.hh"
+#include "umlrttimerpool.hh"
 #include "umlrttimespec.hh"
 #include "umlrtqueue.hh"
 #include <stdlib.h>
 #include <stdio.h>
 #include "osselect.hh"
+#include "ostimerfd.hh"
 #include <string.h>
 #include <stdarg.h>
 #include <new>
@@ -47,24 +52,35 @@
 // The application-wide free timer pool.
 /*static*/ UMLRTTimerPool * UMLRTController::timerPool  = NULL;
 
+// Most consecutive messages to one capsule injected as a single run.
+/*static*/ size_t UMLRTController::capsuleRun = USER_CONFIG_CONTROLLER_CAPSULE_RUN;
+
 // Error codes to string
 static const char * errorToString[] = UMLRTCONTROLLER_ERROR_CODE_TO_STRING;
 
 
 UMLRTController::UMLRTController (const char * name__, size_t numSlots_, UMLRTSlot slots_[] )
-    : UMLRTBasicThread(name__), name_(name__), incomingQueue(name__), capsuleQueue(name__), numSlots(numSlots_), slots(slots_), _exit(false), exitValue(0), _abort(false), lastError(E_OK)
+    : UMLRTBasicThread(name__), name_(name__), incomingQueue(name__), capsuleQueue(name__), timerFd(new UMLRTTimerFd()), numSlots(numSlots_), slots(slots_), _exit(false), exitValue(0), _abort(false), lastError(E_OK), injectedCount(0),
+      residents(NULL), numResidents(0), maxResidents(0), poolState(0), poolNext(NULL), poolPrev(NULL), poolStarted(false), poolDone(0)
 {
     // Register the controller with the capsule-to-controller map.
     UMLRTDeploymentMap::addController(name__, this);
 }
 
 UMLRTController::UMLRTController ( const char * name__ )
-    : UMLRTBasicThread(name__), name_(name__), incomingQueue(name__), capsuleQueue(name__), numSlots(0), slots(NULL), _exit(false), exitValue(0), _abort(false), lastError(E_OK)
+    : UMLRTBasicThread(name__), name_(name__), incomingQueue(name__), capsuleQueue(name__), timerFd(new UMLRTTimerFd()), numSlots(0), slots(NULL), _exit(false), exitValue(0), _abort(false), lastError(E_OK), injectedCount(0),
+      residents(NULL), numResidents(0), maxResidents(0), poolState(0), poolNext(NULL), poolPrev(NULL), poolStarted(false), poolDone(0)
 {
     // Register the controller with the capsule-to-controller map.
     UMLRTDeploymentMap::addController(name__, this);
 }
 
+UMLRTController::~UMLRTController ( )
+{
+    delete timerFd;
+    delete[] residents;
+}
+
 bool UMLRTController::cancelTimer ( const UMLRTTimerId id )
 {
     if (id.isValid())
@@ -74,7 +90,7 @@ bool UMLRTController::cancelTimer ( const UMLRTTimerId id )
         char buf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
         BDEBUG(BD_TIMER, "cancel timer(%p) destPort(%s) isInterval(%d) priority(%d) payloadSize(%d) due(%s)\n",
                 timer, timer->sap()->getName(), timer->isInterval, timer->signal.getPriority(), timer->signal.getPayloadSize(),
-                timer->isInterval ? timer->due.toStringRelative(buf, sizeof(buf)) : timer->due.toString(buf, sizeof(buf)));
+                timer->isClockTime ? timer->due.toString(buf, sizeof(buf)) : timer->due.toStringRelative(buf, sizeof(buf)));
     }
     return timerQueue.cancel(id);
 }
@@ -92,6 +108,7 @@ bool UMLRTController::cancelTimer ( const UMLRTTimerId id )
             {
             case UMLRTControllerCommand::ABORT:
             case UMLRTControllerCommand::DEBUG_OUTPUT_MODEL:
+            case UMLRTControllerCommand::EXIT:
                 // Not a match.
                 break;
             case UMLRTControllerCommand::DESTROY:
@@ -115,6 +132,10 @@ bool UMLRTController::cancelTimer ( const UMLRTTimerId id )
                 // Deallocate INCARNATE if this is destroy-deallocate.
                 match = criteria->isDestroy && (command->capsule == criteria->capsule);
                 break;
+            case UMLRTControllerCommand::MIGRATE:
+                // A destroyed slot is not moved.
+                match = criteria->isDestroy && (command->slot == criteria->slot);
+                break;
             case UMLRTControllerCommand::UNDEFINED:
             default:
                 FATAL("unknown controller command (%d) being matched for deallocate", command->command);
@@ -150,6 +171,52 @@ bool UMLRTController::cancelTimer ( const UMLRTTimerId id )
     umlrt::TimerPutToPool(timer);
 }
 
+/*static*/ bool UMLRTController::migrateMsgMatchCompare ( UMLRTMessage * msg, t_migrate_list * list )
+{
+    if (!msg->isCommand)
+    {
+        return msg->destSlot == list->slot;
+    }
+    UMLRTControllerCommand * command = (UMLRTControllerCommand *)msg->signal.getPayload();
+
+    if (command != NULL)
+    {
+        switch (command->command)
+        {
+        case UMLRTControllerCommand::DEPORT:
+        case UMLRTControllerCommand::DESTROY:
+        case UMLRTControllerCommand::IMPORT:
+            // Slot operations are run by the slot's controller.
+            return command->slot == list->slot;
+        case UMLRTControllerCommand::INCARNATE:
+            return (list->slot->capsule != NULL) && (command->capsule == list->slot->capsule);
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+/*static*/ bool UMLRTController::migrateTimerMatchCompare ( UMLRTTimer * timer, t_migrate_list * list )
+{
+    return timer->destSlot == list->slot;
+}
+
+/*static*/ void UMLRTController::migrateMatchNotify ( UMLRTQueueElement * element, t_migrate_list * list )
+{
+    // Keep the order they were removed in - it is the order they were queued in for each priority.
+    element->next = NULL;
+    if (list->head == NULL)
+    {
+        list->head = element;
+    }
+    else
+    {
+        list->tail->next = element;
+    }
+    list->tail = element;
+}
+
 void UMLRTController::deallocateSlotResources ( UMLRTSlot * slot, UMLRTCapsule * deletedCapsule, bool isDestroy )
 {
     if (slot == NULL)
@@ -170,8 +237,34 @@ bool UMLRTController::deliver ( const UMLRTCommsPort * destPort, const UMLRTSign
 {
     // Assumes global RTS lock acquired.
 
+    UMLRTMessage * msg = prepareDelivery(destPort, signal, srcPortIndex);
+
+    if (msg != NULL)
+    {
+        if (isMyThread())
+        {
+            // If this is me delivering the message, I can deliver directly to my capsule queues.
+            capsuleQueue.enqueue(msg);
+        }
+        else
+        {
+            // Otherwise, I deliver to the remote capsule's incoming queue.
+            incomingQueue.enqueue(msg);
+            if (UMLRTControllerPool::isEnabled())
+            {
+                UMLRTControllerPool::schedule(this);
+            }
+        }
+    }
+    return msg != NULL;
+}
+
+// Allocate and format the message for a delivery.
+UMLRTMessage * UMLRTController::prepareDelivery ( const UMLRTCommsPort * destPort, const UMLRTSignal &signal, size_t srcPortIndex, bool referenceHeld )
+{
+    // Assumes global RTS lock acquired.
+
     UMLRTMessage * msg = umlrt::MessageGetFromPool();
-    bool ok = false;
 
     if (!msg)
     {
@@ -185,11 +278,19 @@ bool UMLRTController::deliver ( const UMLRTCommsPort * destPort, const UMLRTSign
     {
         // Look up sapIndex0 so receiver knows which index in their replicated port the message was received on.
         msg->sapIndex0_ = signal.getSrcPort()->farEnds[srcPortIndex].farEndIndex;
-        msg->signal = signal;
+        if (referenceHeld)
+        {
+            msg->signal.adoptReference(signal);
+        }
+        else
+        {
+            msg->signal = signal;
+        }
         msg->destPort = destPort;
         msg->destSlot = destPort->slot;
         msg->srcPortIndex = srcPortIndex;
         msg->isCommand = false;
+        msg->next = NULL;
 
         // Source port may not exist.
         BDEBUG(BD_SIGNALALLOC, "%s: deliver signal-qid[%d] id(%d) -> %s(%s[%d]) payloadSize(%d)\n",
@@ -198,20 +299,27 @@ bool UMLRTController::deliver ( const UMLRTCommsPort * destPort, const UMLRTSign
                 msg->signal.getId(),
                 msg->sap()->slotName(), msg->sap()->getName(), msg->sapIndex0(),
                 msg->signal.getPayloadSize());
+    }
+    return msg;
+}
 
-        if (isMyThread())
-        {
-            // If this is me delivering the message, I can deliver directly to my capsule queues.
-            capsuleQueue.enqueue(msg);
-        }
-        else
+// Queue a list of prepared messages with a single wakeup.
+void UMLRTController::deliverAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count )
+{
+    // Assumes global RTS lock acquired.
+
+    if (isMyThread())
+    {
+        capsuleQueue.enqueueAll(first, last, count);
+    }
+    else
+    {
+        incomingQueue.enqueueAll(first, last, count);
+        if (UMLRTControllerPool::isEnabled())
         {
-            // Otherwise, I deliver to the remote capsule's incoming queue.
-            incomingQueue.enqueue(msg);
+            UMLRTControllerPool::schedule(this);
         }
-        ok = true;
     }
-    return ok;
 }
 
 void UMLRTController::enqueueAbort ( )
@@ -224,6 +332,7 @@ void UMLRTController::enqueueAbort ( )
     command.slot = NULL;
     command.userMsg = NULL;
     command.wait = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::ABORT;
@@ -242,6 +351,10 @@ void UMLRTController::enqueueCommand ( const UMLRTControllerCommand & command )
 {
     UMLRTMessage *msg = umlrt::MessageGetFromPool();
 
+    if (msg == NULL)
+    {
+        FATAL("%s: message pool exhausted - could not queue controller command %d", name(), command.command);
+    }
     msg->signal.initialize("ControllerCommand", UMLRTSignal::invalidSignalId, sizeof(UMLRTControllerCommand));
     UMLRTControllerCommand * msgcmd;
 
@@ -267,6 +380,10 @@ void UMLRTController::enqueueCommand ( const UMLRTControllerCommand & command )
     {
         // Otherwise, I deliver to the remote capsule's incoming queue.
         incomingQueue.enqueue(msg);
+        if (UMLRTControllerPool::isEnabled())
+        {
+            UMLRTControllerPool::schedule(this);
+        }
     }
 }
 
@@ -280,6 +397,7 @@ void UMLRTController::enqueueDebugOutputModel ( const char * userMsg )
     command.slot = NULL;
     command.wait = NULL;
     command.exitValue = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::DEBUG_OUTPUT_MODEL;
@@ -297,6 +415,7 @@ void UMLRTController::enqueueDeport ( UMLRTSlot * slot, UMLRTCapsule * capsule )
     command.userMsg = NULL;
     command.wait = NULL;
     command.exitValue = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::DEPORT;
@@ -314,6 +433,7 @@ void UMLRTController::enqueueDestroy ( UMLRTSlot * slot, bool isTopSlot )
     command.capsule = NULL;
     command.userMsg = NULL;
     command.exitValue = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::DESTROY;
@@ -328,7 +448,9 @@ void UMLRTController::enqueueDestroy ( UMLRTSlot * slot, bool isTopSlot )
     if (isTopSlot)
     {
         BDEBUG(BD_DESTROY, "Waiting for controller '%s' to destroy slot '%s'.\n", getName(), slot->name);
+        UMLRTControllerPool::blockingBegin();
         command.wait->wait();
+        UMLRTControllerPool::blockingEnd();
         BDEBUG(BD_DESTROY, "Controller '%s' destroyed slot '%s'.\n", getName(), slot->name);
         delete command.wait;
     }
@@ -344,6 +466,7 @@ void UMLRTController::enqueueExit ( void * exitValue )
     command.slot = NULL;
     command.userMsg = NULL;
     command.wait = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::EXIT;
@@ -365,6 +488,7 @@ void UMLRTController::enqueueImport ( UMLRTSlot * slot, UMLRTCapsule * capsule )
     command.userMsg = NULL;
     command.wait = NULL;
     command.exitValue = NULL;
+    command.destination = NULL;
 
     // Format command and enqueue it.
     command.command = UMLRTControllerCommand::IMPORT;
@@ -386,6 +510,7 @@ void UMLRTController::enqueueIncarnate ( UMLRTCapsule * capsule, const UMLRTComm
     command.userMsg = NULL;
     command.wait = NULL;
     command.exitValue = NULL;
+    command.destination = NULL;
 
     if (type != NULL)
     {
@@ -406,6 +531,25 @@ void UMLRTController::enqueueIncarnate ( UMLRTCapsule * capsule, const UMLRTComm
 }
 
 // Return true if abort was received.
+void UMLRTController::enqueueMigrate ( UMLRTSlot * slot, UMLRTController * destination )
+{
+    UMLRTControllerCommand command;
+
+    // Explicitly reset unused command contents.
+    command.capsule = NULL;
+    command.isTopSlot = false;
+    command.userMsg = NULL;
+    command.wait = NULL;
+    command.exitValue = NULL;
+
+    // Format command and enqueue it.
+    command.command = UMLRTControllerCommand::MIGRATE;
+    command.slot = slot;
+    command.destination = destination;
+
+    enqueueCommand(command);
+}
+
 void UMLRTController::executeCommand ( UMLRTMessage * msg )
 {
     UMLRTControllerCommand * command = (UMLRTControllerCommand *)msg->signal.getPayload();
@@ -460,6 +604,11 @@ void UMLRTController::executeCommand ( UMLRTMessage * msg )
             UMLRTFrameService::controllerIncarnate(command->capsule, command->signal);
             break;
 
+        case UMLRTControllerCommand::MIGRATE:
+            BDEBUG(BD_COMMAND, "%s: MIGRATE slot %s to controller %s command received\n", name(), command->slot->name, command->destination->name());
+            migrateSlot(command->slot, command->destination);
+            break;
+
         case UMLRTControllerCommand::UNDEFINED:
         default:
             FATAL("%s:unknown controller (%d) command received", name(), command->command);
@@ -479,6 +628,11 @@ void UMLRTController::executeCommand ( UMLRTMessage * msg )
 // Wait for the controller thread to die.
 void * UMLRTController::join ( )
 {
+    if (UMLRTControllerPool::isEnabled())
+    {
+        poolDone.wait();
+        return exitValue;
+    }
     return UMLRTBasicThread::join();
 }
 
@@ -500,11 +654,219 @@ void * UMLRTController::join ( )
     return timerPool;
 }
 
+// Number of messages waiting to be injected.
+size_t UMLRTController::getQueueDepth ( )
+{
+    return capsuleQueue.count() + incomingQueue.count();
+}
+
+void UMLRTController::injectInvoke ( UMLRTMessage & msg )
+{
+    UMLRTCapsule * capsule = resident(msg.destSlot)->capsule;
+
+    BDEBUG(BD_INJECT, "%s: inject invoke signal-qid[%d] into %s(role %s, class %s) {%s[%d]} id %d(%s)\n",
+            name(), msg.signal.getQid(), capsule->name(), capsule->getName(), capsule->getTypeName(),
+            msg.sap()->getName(), msg.sapIndex0(), msg.signal.getId(), msg.getSignalName());
+    base::debugLogData( BD_SIGNALDATA, msg.signal.getPayload(), msg.signal.getPayloadSize());
+
+    // The message lives on the invoker's stack - don't leave the capsule referring to it.
+    const UMLRTMessage * current = capsule->getMsg();
+
+    // Counted before the inject - the transition may move the resident entries.
+    ++injectedCount;
+    ++resident(msg.destSlot)->injected;
+
+    capsule->msg = &msg;
+    capsule->logMsg();
+    capsule->inject(msg);
+    capsule->msg = current;
+}
+
+UMLRTController::Resident * UMLRTController::resident ( const UMLRTSlot * slot )
+{
+    Resident * r = findResident(slot);
+
+    return (r != NULL) ? r : adopt(slot);
+}
+
+UMLRTController::Resident * UMLRTController::findResident ( const UMLRTSlot * slot )
+{
+    size_t i = slot->resident;
+
+    return ((i > 0) && (i <= numResidents) && (residents[i - 1].slot == slot)) ? &residents[i - 1] : NULL;
+}
+
+UMLRTController::Resident * UMLRTController::adopt ( const UMLRTSlot * slot )
+{
+    UMLRTFrameService::rtsLock();
+
+    if (numResidents == maxResidents)
+    {
+        size_t newMax = (maxResidents == 0) ? 16 : maxResidents * 2;
+        Resident * newResidents = new Resident[newMax];
+        if (residents != NULL)
+        {
+            memcpy(newResidents, residents, numResidents * sizeof(Resident));
+            delete[] residents;
+        }
+        residents = newResidents;
+        maxResidents = newMax;
+    }
+    UMLRTSlot * s = const_cast<UMLRTSlot *>(slot);
+    Resident * r = &residents[numResidents++];
+    r->capsule = s->capsule;
+    r->slot = s;
+    r->injected = 0;
+    r->condemned = s->condemned;
+    s->resident = numResidents;
+
+    UMLRTFrameService::rtsUnlock();
+
+    BDEBUG(BD_CONTROLLER, "%s: slot %s resident[%lu]\n", name(), slot->name, (unsigned long)(numResidents - 1));
+
+    return r;
+}
+
+void UMLRTController::evict ( const UMLRTSlot * slot )
+{
+    // Assumes RTS lock held.
+    size_t i = slot->resident;
+
+    if ((i > 0) && (i <= numResidents) && (residents[i - 1].slot == slot))
+    {
+        // Move the last entry into the hole.
+        if (i < numResidents)
+        {
+            residents[i - 1] = residents[numResidents - 1];
+            residents[i - 1].slot->resident = i;
+        }
+        --numResidents;
+    }
+    const_cast<UMLRTSlot *>(slot)->resident = 0;
+}
+
+/*static*/ void UMLRTController::setCondemned ( UMLRTSlot * slot, bool condemned )
+{
+    // Assumes RTS lock held.
+    slot->condemned = condemned;
+
+    UMLRTController * controller = slot->controller;
+    size_t i = slot->resident;
+
+    if ((controller != NULL) && (i > 0) && (i <= controller->numResidents) && (controller->residents[i - 1].slot == slot))
+    {
+        controller->residents[i - 1].condemned = condemned;
+    }
+}
+
 bool UMLRTController::isMyThread ( )
 {
+    if (UMLRTControllerPool::isEnabled())
+    {
+        // Any worker may be running this controller.
+        return UMLRTControllerPool::current() == this;
+    }
     return UMLRTBasicThread::isMyThread();
 }
 
+// True if there are messages or expired timers waiting to be processed.
+bool UMLRTController::isReady ( )
+{
+    if ((capsuleQueue.count() > 0) || !incomingQueue.isEmpty())
+    {
+        return true;
+    }
+    now.invalidate();
+    return !timerQueue.isEmpty() && timerQueue.timeRemaining(now).isZeroOrNegative();
+}
+
+// Move a slot to another controller.
+/*static*/ bool UMLRTController::migrate ( UMLRTSlot * slot, UMLRTController * destination )
+{
+    if ((slot == NULL) || (destination == NULL))
+    {
+        BDEBUG(BD_ERROR, "migrate: slot(%p) destination(%p) must be defined\n", slot, destination);
+        return false;
+    }
+    UMLRTFrameService::rtsLock();
+
+    UMLRTController * source = slot->controller;
+    bool ok = (source != NULL) && !slot->remote && !slot->condemned;
+    if (!ok)
+    {
+        BDEBUG(BD_ERROR, "migrate: slot %s is not running on a local controller\n", slot->name);
+    }
+    else if (source != destination)
+    {
+        // Always queued - even for the calling controller - so the capsule is between injections when it moves.
+        BDEBUG(BD_CONTROLLER, "migrate: slot %s from controller %s to %s requested\n", slot->name, source->name(), destination->name());
+        source->enqueueMigrate(slot, destination);
+    }
+    UMLRTFrameService::rtsUnlock();
+
+    return ok;
+}
+
+// Move a slot from this controller to another - run from this controller.
+void UMLRTController::migrateSlot ( UMLRTSlot * slot, UMLRTController * destination )
+{
+    // Senders read the slot's controller with the RTS lock held, so holding it while the messages are
+    // moved means every message sent after the move is queued after those that were moved.
+    UMLRTFrameService::rtsLock();
+
+    if (slot->controller != this)
+    {
+        // Moved by an earlier request - pass the request on to the slot's current controller.
+        if ((slot->controller != NULL) && (slot->controller != destination) && !slot->condemned)
+        {
+            slot->controller->enqueueMigrate(slot, destination);
+        }
+        UMLRTFrameService::rtsUnlock();
+        return;
+    }
+    if (slot->condemned || (destination == this))
+    {
+        UMLRTFrameService::rtsUnlock();
+        return;
+    }
+    // The destination adds an entry when it first injects into the capsule.
+    evict(slot);
+    slot->controller = destination;
+
+    // Messages in the capsule queue were queued before those still in the incoming queue.
+    t_migrate_list messages = { slot, NULL, NULL };
+    capsuleQueue.remove( (UMLRTQueue::match_compare_t)migrateMsgMatchCompare, (UMLRTQueue::match_notify_t)migrateMatchNotify, &messages );
+    incomingQueue.remove( (UMLRTQueue::match_compare_t)migrateMsgMatchCompare, (UMLRTQueue::match_notify_t)migrateMatchNotify, &messages );
+
+    t_migrate_list timers = { slot, NULL, NULL };
+    timerQueue.remove( (UMLRTQueue::match_compare_t)migrateTimerMatchCompare, (UMLRTQueue::match_notify_t)migrateMatchNotify, &timers );
+
+    size_t messageCount = 0;
+    const UMLRTQueueElement * next;
+    for (const UMLRTQueueElement * element = messages.head; element != NULL; element = next)
+    {
+        next = element->next;
+        destination->incomingQueue.enqueue((UMLRTMessage *)element);
+        ++messageCount;
+    }
+    size_t timerCount = 0;
+    for (const UMLRTQueueElement * element = timers.head; element != NULL; element = next)
+    {
+        next = element->next;
+        destination->timerQueue.enqueue((const UMLRTTimer *)element);
+        ++timerCount;
+    }
+    UMLRTFrameService::rtsUnlock();
+
+    BDEBUG(BD_CONTROLLER, "%s: migrated slot %s to controller %s with %lu messages and %lu timers\n",
+            name(), slot->name, destination->name(), (unsigned long)messageCount, (unsigned long)timerCount);
+
+    if (UMLRTControllerPool::isEnabled())
+    {
+        UMLRTControllerPool::schedule(destination);
+    }
+}
+
 // Output an error containing a user-defined message and the 'strerror()' string.
 void UMLRTController::perror ( const char * fmt, ... ) const
 {
@@ -523,6 +885,25 @@ void UMLRTController::recall ( UMLRTMessage * msg, bool front )
 
 // Main loop
 void * UMLRTController::run ( void * args )
+{
+    startup();
+
+    while (!_abort && !_exit)
+    {
+        dispatch();
+
+        // Do not wait if we have queued capsule messages left to inject.
+        if (!_abort && !_exit && !capsuleQueue.count())
+        {
+            // Wait on the incoming queue or a timeout.
+            wait();
+        }
+    }
+    return shutdown();
+}
+
+// Initialization before the first message is injected.
+void UMLRTController::startup ( )
 {
     printf("Controller \"%s\" running.\n", name());
 
@@ -530,40 +911,40 @@ void * UMLRTController::run ( void * args )
     {
         numSlots = UMLRTDeploymentMap::getDefaultSlotList( &slots );
     }
+    // The generated capsules this controller runs are resident from the start, in slot list order.
     for (size_t i = 0; (i < numSlots) && (slots != NULL); ++i)
     {
-        if (slots[i].controller == this)
+        if ((slots[i].controller == this) && (slots[i].capsule != NULL) && (!slots[i].condemned))
         {
-            if ((slots[i].capsule != NULL) && (!slots[i].condemned))
-            {
-                if (   (slots[i].role() == NULL)
-                    || ((slots[i].role()->optional == 0) && (slots[i].role()->plugin == 0)))
-                {
-//                    BDEBUG(BD_INSTANTIATE, "%s: initialize capsule %s (class %s).\n", name(), slots[i].name, slots[i].capsuleClass->name );
-//                    UMLRTSignal emptySignal;
-//                    emptySignal.initialize("INITIALIZE", UMLRTSignal::invalidSignalId);
-//                    UMLRTFrameService::initializeCapsule(slots[i].capsule, emptySignal);
-                }
-            }
+            resident(&slots[i]);
         }
     }
-    while (!_abort && !_exit)
-    {
-        // Queue messages associated with all timed-out timers.
-        capsuleQueue.queueTimerMessages(&timerQueue);
+}
+
+// One pass of the main loop.
+void UMLRTController::dispatch ( )
+{
+    // Queue messages associated with all timed-out timers.
+    now.invalidate();
+    capsuleQueue.queueTimerMessages(&timerQueue, now);
 
-        // Transfer all incoming messages to capsule queues.
-        capsuleQueue.moveAll(incomingQueue);
+    // Transfer all incoming messages to capsule queues.
+    capsuleQueue.moveAll(incomingQueue);
 
-        // Inject all available messages, highest priority msgs first.
-        UMLRTMessage * msg;
+    // Inject all available messages, highest priority msgs first.
+    UMLRTMessage * msg;
+    Resident * r;
 
-        // Process only as many capsuleQueue messages as is currently queued before exiting the inner loop and checking the incomingQueue again.
-        // If additional capsuleQueue messages are queued while injecting these, they will be processed after the incomingQueue is checked.
-        size_t countBeforeInnerLoop = capsuleQueue.count();
-        size_t innerLoopCount = 0;
+    // Process only as many capsuleQueue messages as is currently queued before exiting the inner loop and checking the incomingQueue again.
+    // If additional capsuleQueue messages are queued while injecting these, they will be processed after the incomingQueue is checked.
+    size_t countBeforeInnerLoop = capsuleQueue.count();
+    size_t innerLoopCount = 0;
 
-        while (!_exit && !_abort && (innerLoopCount < countBeforeInnerLoop) && ((msg = capsuleQueue.dequeueHighestPriority()) != NULL))
+    // Messages are taken in batches of the highest priority. The batch ends early if a higher
+    // priority message is queued while injecting, so injection order is strictly by priority.
+    while (!_exit && !_abort && (innerLoopCount < countBeforeInnerLoop) && (capsuleQueue.dequeueBatch(countBeforeInnerLoop - innerLoopCount) > 0))
+    {
+        while (!_exit && !_abort && ((msg = capsuleQueue.nextInBatch()) != NULL))
         {
             ++innerLoopCount;
 
@@ -571,60 +952,89 @@ void * UMLRTController::run ( void * args )
             {
                 executeCommand(msg);
             }
-            else if (msg->destSlot->capsule == NULL)
+            else if ((r = resident(msg->destSlot))->capsule == NULL)
             {
                 FATAL("%s: signal id(%d) to slot %s (no capsule instance) should not occur\n",
                         name(), msg->signal.getId(), msg->destSlot->name);
             }
             else
             {
-                if (msg->destSlot->condemned)
-                {
-                    // Drop messages to a condemned slot.
-                    BDEBUG(BD_INJECT, "%s: dropping signal-qid[%d] id(%d)(%s) to slot %s (slot condemned)\n",
-                            name(), msg->signal.getQid(), msg->getSignalId(), msg->getSignalName(), msg->sap()->getName());
-                }
-                else
+                // Inject this message and those following it in the batch to the same capsule as a run.
+                // A message that preempts the batch (including a recalled one) ends the run.
+                const UMLRTSlot * slot = msg->destSlot;
+                UMLRTCapsule * capsule = r->capsule;
+                bool debugInject = base::debugTypeEnabled(BD_INJECT);
+                size_t run = 1;
+                UMLRTMessage * next;
+
+                for (;;)
                 {
-                    if (base::debugTypeEnabled(BD_INJECT))
+                    if (r->condemned)
                     {
-                        BDEBUG(BD_INJECT, "%s: countBeforeInnerLoop(%d) innerLoopCount(%d) signal(%s)\n",
-                                name(), countBeforeInnerLoop, innerLoopCount, msg->getSignalName());
-                        // Source port may no longer exist.
-                        BDEBUG(BD_INJECT, "%s: inject signal-qid[%d] into %s(role %s, class %s) {%s[%d]} id %d(%s) prio(%d)\n",
-                                name(), msg->signal.getQid(), msg->destSlot->capsule->name(), msg->destSlot->capsule->getName(),
-                                msg->destSlot->capsule->getTypeName(), msg->sap()->getName(), msg->sapIndex0(), msg->signal.getId(),
-                                msg->getSignalName(), msg->getPriority());
-                        size_t param_i = 0;
-                        const UMLRTObject_class * type = msg->getType(param_i++);
-                        while (type != NULL)
+                        // Drop messages to a condemned slot.
+                        BDEBUG(BD_INJECT, "%s: dropping signal-qid[%d] id(%d)(%s) to slot %s (slot condemned)\n",
+                                name(), msg->signal.getQid(), msg->getSignalId(), msg->getSignalName(), msg->sap()->getName());
+                    }
+                    else
+                    {
+                        if (debugInject)
                         {
-                            BDEBUG(BD_INJECT, "%s: signal %s param[%d] type %s\n", name(), msg->getSignalName(), param_i-1, type->name);
-                            type = msg->getType(param_i++);
+                            BDEBUG(BD_INJECT, "%s: countBeforeInnerLoop(%d) innerLoopCount(%d) run(%d) signal(%s)\n",
+                                    name(), countBeforeInnerLoop, innerLoopCount, run, msg->getSignalName());
+                            // Source port may no longer exist.
+                            BDEBUG(BD_INJECT, "%s: inject signal-qid[%d] into %s(role %s, class %s) {%s[%d]} id %d(%s) prio(%d)\n",
+                                    name(), msg->signal.getQid(), capsule->name(), capsule->getName(),
+                                    capsule->getTypeName(), msg->sap()->getName(), msg->sapIndex0(), msg->signal.getId(),
+                                    msg->getSignalName(), msg->getPriority());
+                            size_t param_i = 0;
+                            const UMLRTObject_class * type = msg->getType(param_i++);
+                            while (type != NULL)
+                            {
+                                BDEBUG(BD_INJECT, "%s: signal %s param[%d] type %s\n", name(), msg->getSignalName(), param_i-1, type->name);
+                                type = msg->getType(param_i++);
+                            }
                         }
-                    }
-                    base::debugLogData( BD_SIGNALDATA, msg->signal.getPayload(), msg->signal.getPayloadSize());
+                        base::debugLogData( BD_SIGNALDATA, msg->signal.getPayload(), msg->signal.getPayloadSize());
 
-                    // Set capsule message for this inject.
-                    msg->destPort->slot->capsule->msg = msg;
+                        // Counted before the inject - the transition may move the resident entries.
+                        ++injectedCount;
+                        ++r->injected;
 
-                    // Log the message (if enabled).
-                    msg->destPort->slot->capsule->logMsg();
+                        // Set capsule message for this inject.
+                        capsule->msg = msg;
 
-                    // Inject the signal into the capsule.
-                    msg->destPort->slot->capsule->inject(*msg);
+                        // Log the message (if enabled).
+                        capsule->logMsg();
+
+                        // Inject the signal into the capsule.
+                        capsule->inject(*msg);
+                    }
+                    // The transition may have moved the capsule's entry, or the capsule may have left the slot.
+                    if (   (run >= capsuleRun) || _exit || _abort
+                        || ((r = findResident(slot)) == NULL) || (r->capsule != capsule)
+                        || ((next = capsuleQueue.nextInBatchFor(slot)) == NULL))
+                    {
+                        break;
+                    }
+                    // Put the message back in the pool (handles signal allocation also).
+                    umlrt::MessagePutToPool(msg);
+
+                    msg = next;
+                    ++run;
+                    ++innerLoopCount;
                 }
             }
             // Put the message back in the pool (handles signal allocation also).
             umlrt::MessagePutToPool(msg);
         }
-        // Do not wait if we have queued capsule messages left to inject.
-        if (!_abort && !_exit && !capsuleQueue.count())
-        {
-            // Wait on the incoming queue or a timeout.
-            wait();
-        }
     }
+    // Leave any messages not injected (exit or abort) on the queue.
+    capsuleQueue.endBatch();
+}
+
+// Clean-up when the controller exits or aborts.
+void * UMLRTController::shutdown ( )
+{
     // Bug 468521 - must destroy owned capsules + slots here.
 
     // Remove this controller from the controller list.
@@ -654,8 +1064,26 @@ void UMLRTController::setError ( Error error )
 // Start the controller thread.
 void UMLRTController::spawn ( )
 {
-    // No arguments for this thread.
-    start(NULL);
+    const UMLRTThreadAttributes * attributes = UMLRTDeploymentMap::getControllerAttributes(name());
+
+    if (UMLRTControllerPool::isEnabled())
+    {
+        if (attributes != NULL)
+        {
+            BDEBUG(BD_CONTROLLER, "%s: thread attributes are not applied to controllers run by the worker pool\n", name());
+        }
+        // The pool's workers run the controller.
+        UMLRTControllerPool::add(this);
+    }
+    else
+    {
+        if (attributes != NULL)
+        {
+            setAttributes(*attributes);
+        }
+        // No arguments for this thread.
+        start(NULL);
+    }
 }
 
 // See umlrtcontroller.hh.
@@ -678,9 +1106,10 @@ void UMLRTController::startTimer ( const UMLRTTimer * timer )
     char buf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
     BDEBUG(BD_TIMER, "start timer(%p) destPort(%s) isInterval(%d) priority(%d) payloadSize(%d) due(%s)\n",
             timer, timer->sap()->getName(), timer->isInterval, timer->signal.getPriority(), timer->signal.getPayloadSize(),
-            timer->isInterval ? timer->due.toStringRelative(buf, sizeof(buf)) : timer->due.toString(buf, sizeof(buf)));
+            timer->isClockTime ? timer->due.toString(buf, sizeof(buf)) : timer->due.toStringRelative(buf, sizeof(buf)));
 
     timerQueue.enqueue(timer);
+    UMLRTControllerPool::timerStarted();
 }
 
 // Wait on an external message or a timeout.
@@ -688,7 +1117,8 @@ void UMLRTController::wait ( )
 {
     // Linux-specific implementation for the time-being.
 
-    // If there is a timer running, this holds the remaining time as the timeout of the select.
+    // If there is a timer running and the timer file descriptor is not supported, this holds the
+    // remaining time as the timeout of the select.
     struct timeval remainTimeval;
 
     // We default to 'wait forever', unless a timer is running.
@@ -699,7 +1129,8 @@ void UMLRTController::wait ( )
     // Get the time remaining on the first timer in the queue (if one exists).
     if (!timerQueue.isEmpty())
     {
-        UMLRTTimespec remainTimespec = timerQueue.timeRemaining();
+        now.invalidate();
+        UMLRTTimespec remainTimespec = timerQueue.timeRemaining(now);
 
         if (remainTimespec.isZeroOrNegative())
         {
@@ -709,17 +1140,31 @@ void UMLRTController::wait ( )
         }
         else
         {
-            // A timer is waiting but is not yet due. Set up the timeout. Will be non-zero.
-            remainTimeval.tv_sec = remainTimespec.tv_sec;
-            remainTimeval.tv_usec = remainTimespec.tv_nsec / 1000;
-
             char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
             BDEBUG(BD_TIMER, "%s: timer is not due - remain(%s)\n", name(), remainTimespec.toStringRelative(tmbuf, sizeof(tmbuf)));
 
-            // Select will not wait forever.
-            selectTimeval = &remainTimeval;
+            // A timer is waiting but is not yet due. Arm the timer file descriptor with the full resolution
+            // of the remaining time. If that is not supported, set up the select timeout, rounding up so
+            // we do not wake up just before the timer is due. Will be non-zero.
+            if (!timerFd->arm(remainTimespec))
+            {
+                remainTimeval.tv_sec = remainTimespec.tv_sec;
+                remainTimeval.tv_usec = (remainTimespec.tv_nsec + 999) / 1000;
+                if (remainTimeval.tv_usec >= 1000000)
+                {
+                    ++remainTimeval.tv_sec;
+                    remainTimeval.tv_usec -= 1000000;
+                }
+                // Select will not wait forever.
+                selectTimeval = &remainTimeval;
+            }
         }
     }
+    else
+    {
+        // The last timer may have been cancelled - avoid a spurious wakeup.
+        timerFd->disarm();
+    }
     if (!incomingQueue.isEmpty())
     {
         BDEBUG(BD_CONTROLLER, "%s: incoming q non-empty\n", name());
@@ -727,24 +1172,34 @@ void UMLRTController::wait ( )
     }
     if (wait)
     {
-        // selectTimeval remains NULL if no timers are running. In that case, select will wait
-        // forever until a message is delivered or a new timer is added to the timer-queue.
+        // selectTimeval remains NULL if no timers are running (or the timer file descriptor is armed).
+        // In that case, select will wait until a message is delivered, a new timer is added to the
+        // timer-queue or the timer file descriptor expires.
 
         // Get the queue notification file descriptors.
         int msgNotifyFd = incomingQueue.getNotifyFd();
-        int timerFd = timerQueue.getNotifyFd();
+        int timerNotifyFd = timerQueue.getNotifyFd();
+        int timerExpiryFd = timerFd->getFd();
 
         fd_set fds;
 
         FD_ZERO(&fds);
         FD_SET(msgNotifyFd, &fds);
-        FD_SET(timerFd, &fds);
+        FD_SET(timerNotifyFd, &fds);
 
         // select wants to know the highest-numbered fd + 1.
         int nfds = msgNotifyFd + 1;
-        if (timerFd > msgNotifyFd)
+        if (timerNotifyFd >= nfds)
         {
-            nfds = timerFd + 1;
+            nfds = timerNotifyFd + 1;
+        }
+        if (timerExpiryFd >= 0)
+        {
+            FD_SET(timerExpiryFd, &fds);
+            if (timerExpiryFd >= nfds)
+            {
+                nfds = timerExpiryFd + 1;
+            }
         }
 
         // TODO - Bug 238 - DEBUG - remove this later.
@@ -759,9 +1214,10 @@ void UMLRTController::wait ( )
         }
         // end DEBUG - remove this later
 
-        BDEBUG(BD_CONTROLLER, "%s: call select msgfd(%d) timeout[%d,%d]\n",
+        BDEBUG(BD_CONTROLLER, "%s: call select msgfd(%d) timerfd(%d) timeout[%d,%d]\n",
                 name(),
                 msgNotifyFd,
+                timerExpiryFd,
                 selectTimeval ? selectTimeval->tv_sec : -1,
                 selectTimeval ? selectTimeval->tv_usec : -1);
 
@@ -775,11 +1231,16 @@ void UMLRTController::wait ( )
             // Clear message notify-pending.
             incomingQueue.clearNotifyFd();
         }
-        if (FD_ISSET(timerFd, &fds))
+        if (FD_ISSET(timerNotifyFd, &fds))
         {
             // Clear message notify-pending.
             timerQueue.clearNotifyFd();
         }
+        if ((timerExpiryFd >= 0) && FD_ISSET(timerExpiryFd, &fds))
+        {
+            // Clear the timer expiry.
+            timerFd->clear();
+        }
     }
 }
 
@@ -1061,6 +1522,21 @@ void UMLRTController::debugOutputSlotContainment ( const UMLRTSlot * slot, size_
     }
 }
 
+static void debugOutputPool ( const char * name, const UMLRTPool * pool )
+{
+    if (pool == NULL)
+    {
+        BDEBUG(BD_MODEL, "    { %s, not defined }\n", name);
+    }
+    else
+    {
+        BDEBUG(BD_MODEL, "    { %s, %lu, %lu, %lu, %lu, %lu, %lu, %s }\n", name,
+                (unsigned long)pool->getSize(), (unsigned long)pool->getInUse(), (unsigned long)pool->getHighWater(),
+                (unsigned long)pool->getMaxSize(), (unsigned long)pool->getIncrement(), (unsigned long)pool->getExhausted(),
+                UMLRTMemoryRegion::backingName(pool->getBacking()));
+    }
+}
+
 void UMLRTController::debugOutputModel ( const char * userMsg )
 {
     // Acquire global RTS lock for this.
@@ -1078,6 +1554,11 @@ void UMLRTController::debugOutputModel ( const char * userMsg )
 
     UMLRTProtocol::debugOutputServiceRegistration();
 
+    BDEBUG(BD_MODEL, "Pools: { <pool>, <size>, <in use>, <high water>, <max (0 unbounded)>, <increment>, <exhausted>, <memory> }\n");
+    debugOutputPool("message", messagePool);
+    debugOutputPool("signal", signalElementPool);
+    debugOutputPool("timer", timerPool);
+
     const UMLRTCapsule * top = UMLRTDeploymentMap::getCapsuleFromName("Top");
 
     if (top == NULL)
@@ -1119,7 +1600,8 @@ void UMLRTController::debugOutputMessages ( )
 
     BDEBUG(BD_MODEL, "Messages queued for Controller %s:\n", name());
     // Queue messages associated with all timed-out timers.
-    capsuleQueue.queueTimerMessages(&timerQueue);
+    now.invalidate();
+    capsuleQueue.queueTimerMessages(&timerQueue, now);
 
     // Transfer all incoming messages to capsule queues.
     capsuleQueue.moveAll(incomingQueue);
@@ -0,0 +1,156 @@
+// umlrtcontrollerbalancer.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "basedebug.hh"
+#include "basefatal.hh"
+#include "umlrtcapsulepart.hh"
+#include "umlrtcontroller.hh"
+#include "umlrtcontrollerbalancer.hh"
+#include "umlrtdeploymentmap.hh"
+#include "umlrtframeservice.hh"
+#include "umlrtsemaphore.hh"
+#include "umlrtslot.hh"
+
+// See umlrtcontrollerbalancer.hh for documentation.
+
+UMLRTControllerBalancer::UMLRTControllerBalancer ( uint32_t periodMsec_ ) : UMLRTBasicThread("balancer"),
+        periodMsec(periodMsec_), numControllers(0), candidate(NULL), candidateDistance(0)
+{
+}
+
+/*static*/ void UMLRTControllerBalancer::spawn ( uint32_t periodMsec )
+{
+    if (periodMsec == 0)
+    {
+        FATAL("controller balancer period must be non-zero");
+    }
+    // Runs until the controllers have all exited.
+    UMLRTControllerBalancer * balancer = new UMLRTControllerBalancer(periodMsec);
+    balancer->start(NULL);
+}
+
+void * UMLRTControllerBalancer::run ( void * args )
+{
+    UMLRTSemaphore period(0);
+
+    BDEBUG(BD_CONTROLLER, "balancer running - period %u msec\n", periodMsec);
+
+    // The controllers may not have been created yet - stop once they have all exited.
+    bool seenControllers = false;
+    do
+    {
+        period.wait(periodMsec);
+        balance();
+        seenControllers = seenControllers || (numControllers > 0);
+    } while (!seenControllers || (numControllers > 0));
+
+    BDEBUG(BD_CONTROLLER, "balancer exiting - no controllers\n");
+
+    return NULL;
+}
+
+void UMLRTControllerBalancer::balance ( )
+{
+    UMLRTController * current[USER_CONFIG_BALANCER_MAX_CONTROLLERS];
+    size_t injected[USER_CONFIG_BALANCER_MAX_CONTROLLERS];
+    size_t load[USER_CONFIG_BALANCER_MAX_CONTROLLERS];
+
+    size_t count = UMLRTDeploymentMap::getControllers(current, USER_CONFIG_BALANCER_MAX_CONTROLLERS);
+    if (count > USER_CONFIG_BALANCER_MAX_CONTROLLERS)
+    {
+        count = USER_CONFIG_BALANCER_MAX_CONTROLLERS;
+    }
+    size_t busiest = 0;
+    size_t idlest = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        injected[i] = current[i]->getInjectedCount();
+
+        // A controller not seen before has no load history.
+        size_t prev = injected[i];
+        for (size_t j = 0; j < numControllers; ++j)
+        {
+            if (controllers[j] == current[i])
+            {
+                prev = previous[j];
+                break;
+            }
+        }
+        load[i] = (injected[i] - prev) + current[i]->getQueueDepth();
+
+        if (load[i] > load[busiest])
+        {
+            busiest = i;
+        }
+        if (load[i] < load[idlest])
+        {
+            idlest = i;
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        controllers[i] = current[i];
+        previous[i] = injected[i];
+    }
+    numControllers = count;
+
+    const UMLRTController * from = NULL;
+    size_t difference = 0;
+    if ((count > 1)
+        && (load[busiest] >= USER_CONFIG_BALANCER_MIN_LOAD)
+        && ((load[busiest] * 100) >= (load[idlest] * USER_CONFIG_BALANCER_IMBALANCE_PCT)))
+    {
+        from = current[busiest];
+        difference = load[busiest] - load[idlest];
+
+        BDEBUG(BD_CONTROLLER, "balancer: controller %s load %lu, controller %s load %lu\n",
+                current[busiest]->name(), (unsigned long)load[busiest], current[idlest]->name(), (unsigned long)load[idlest]);
+    }
+    // The capsule message counts are reset every period, even when the controllers are balanced.
+    candidate = NULL;
+    candidateDistance = 0;
+
+    UMLRTFrameService::rtsLock();
+    for (size_t i = 0; i < count; ++i)
+    {
+        visitResidents(current[i], from, difference / 2, difference);
+    }
+    UMLRTFrameService::rtsUnlock();
+
+    if (candidate != NULL)
+    {
+        BDEBUG(BD_CONTROLLER, "balancer: moving slot %s from controller %s to %s\n", candidate->name, current[busiest]->name(), current[idlest]->name());
+        UMLRTController::migrate(candidate, current[idlest]);
+    }
+}
+
+void UMLRTControllerBalancer::visitResidents ( const UMLRTController * controller, const UMLRTController * busiest, size_t target, size_t limit )
+{
+    UMLRTController::Resident * residents = controller->getResidents();
+    size_t numResidents = controller->getNumResidents();
+
+    for (size_t i = 0; i < numResidents; ++i)
+    {
+        size_t injected = residents[i].injected;
+        residents[i].injected = 0;
+
+        // Moving a capsule that accounts for all of the difference (or more) would only reverse the imbalance.
+        if ((controller == busiest) && (residents[i].capsule != NULL) && !residents[i].condemned && !residents[i].slot->remote
+            && (injected > 0) && (injected < limit))
+        {
+            size_t distance = (injected > target) ? (injected - target) : (target - injected);
+            if ((candidate == NULL) || (distance < candidateDistance))
+            {
+                candidate = residents[i].slot;
+                candidateDistance = distance;
+            }
+        }
+    }
+}
@@ -0,0 +1,416 @@
+// umlrtcontrollerpool.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "basedebug.hh"
+#include "basefatal.hh"
+#include "osatomic.hh"
+#include "umlrtcontroller.hh"
+#include "umlrtcontrollerpool.hh"
+#include "umlrtguard.hh"
+#include "umlrttimespec.hh"
+#include "umlrtuserconfig.hh"
+
+/*static*/ UMLRTControllerPool::Worker * UMLRTControllerPool::workers[USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS];
+/*static*/ volatile int UMLRTControllerPool::numWorkers = 0;
+/*static*/ UMLRTMutex UMLRTControllerPool::workersMutex;
+
+/*static*/ UMLRTController * * UMLRTControllerPool::controllers = NULL;
+/*static*/ size_t UMLRTControllerPool::numControllers = 0;
+/*static*/ size_t UMLRTControllerPool::maxControllers = 0;
+/*static*/ UMLRTMutex UMLRTControllerPool::controllersMutex;
+
+/*static*/ volatile int UMLRTControllerPool::liveControllers = 0;
+
+/*static*/ UMLRTSemaphore UMLRTControllerPool::wakeup(0);
+/*static*/ volatile int UMLRTControllerPool::idleWorkers = 0;
+/*static*/ volatile int UMLRTControllerPool::blockedWorkers = 0;
+/*static*/ volatile unsigned int UMLRTControllerPool::nextWorker = 0;
+/*static*/ volatile bool UMLRTControllerPool::stopping = false;
+
+// The worker running on this thread (NULL if not a worker thread).
+static OS_THREAD_LOCAL void * currentWorker = NULL;
+
+// The controller the worker on this thread is running.
+static OS_THREAD_LOCAL void * currentController = NULL;
+
+UMLRTControllerPool::Worker::Worker ( int index_, const char * name_ ) : UMLRTBasicThread(name_), index(index_), head(NULL), tail(NULL)
+{
+}
+
+void UMLRTControllerPool::Worker::push ( UMLRTController * controller )
+{
+    UMLRTGuard g(mutex);
+
+    controller->poolNext = NULL;
+    controller->poolPrev = tail;
+    if (tail == NULL)
+    {
+        head = controller;
+    }
+    else
+    {
+        tail->poolNext = controller;
+    }
+    tail = controller;
+}
+
+UMLRTController * UMLRTControllerPool::Worker::pop ( )
+{
+    UMLRTGuard g(mutex);
+
+    UMLRTController * controller = head;
+    if (controller != NULL)
+    {
+        head = controller->poolNext;
+        if (head == NULL)
+        {
+            tail = NULL;
+        }
+        else
+        {
+            head->poolPrev = NULL;
+        }
+        controller->poolNext = NULL;
+    }
+    return controller;
+}
+
+UMLRTController * UMLRTControllerPool::Worker::steal ( )
+{
+    UMLRTGuard g(mutex);
+
+    UMLRTController * controller = tail;
+    if (controller != NULL)
+    {
+        tail = controller->poolPrev;
+        if (tail == NULL)
+        {
+            head = NULL;
+        }
+        else
+        {
+            tail->poolNext = NULL;
+        }
+        controller->poolPrev = NULL;
+    }
+    return controller;
+}
+
+void * UMLRTControllerPool::Worker::run ( void * args )
+{
+    currentWorker = this;
+
+    BDEBUG(BD_CONTROLLER, "%s: worker running\n", getName());
+
+    unsigned int passes = 0;
+    while (!OSAtomic::load(&stopping))
+    {
+        if ((++passes % USER_CONFIG_CONTROLLER_POOL_TIMER_CHECK) == 0)
+        {
+            // Busy workers may not go idle for a while - idle controllers with expired timers must still run.
+            uint32_t msec;
+            checkTimers(&msec);
+        }
+        UMLRTController * controller = findWork(this);
+
+        if (controller == NULL)
+        {
+            // Announce we are going idle before the final check for work, so a controller scheduled
+            // after the check posts the wakeup semaphore.
+            OSAtomic::fetchAdd(&idleWorkers, 1);
+
+            uint32_t msec = USER_CONFIG_CONTROLLER_POOL_IDLE_MSEC;
+            checkTimers(&msec);
+
+            if (((controller = findWork(this)) == NULL) && !OSAtomic::load(&stopping))
+            {
+                BDEBUG(BD_CONTROLLER, "%s: idle - wait %u msec\n", getName(), msec);
+                wakeup.wait(msec);
+            }
+            OSAtomic::fetchAdd(&idleWorkers, -1);
+        }
+        if (controller != NULL)
+        {
+            execute(this, controller);
+        }
+    }
+    BDEBUG(BD_CONTROLLER, "%s: worker exiting\n", getName());
+
+    return NULL;
+}
+
+/*static*/ void UMLRTControllerPool::start ( int numWorkers_ )
+{
+    if (numWorkers > 0)
+    {
+        FATAL("controller pool already started");
+    }
+    if ((numWorkers_ <= 0) || (numWorkers_ > USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS))
+    {
+        FATAL("controller pool worker count %d must be between 1 and %d", numWorkers_, USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS);
+    }
+    for (int i = 0; i < numWorkers_; ++i)
+    {
+        addWorker();
+    }
+}
+
+/*static*/ bool UMLRTControllerPool::isEnabled ( )
+{
+    return OSAtomic::load(&numWorkers) > 0;
+}
+
+/*static*/ bool UMLRTControllerPool::addWorker ( )
+{
+    UMLRTGuard g(workersMutex);
+
+    int index = OSAtomic::load(&numWorkers);
+    if (index >= USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS)
+    {
+        return false;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "worker-%d", index);
+
+    Worker * worker = new Worker(index, name);
+    workers[index] = worker;
+
+    // Publish the worker before it can be stolen from.
+    OSAtomic::store(&numWorkers, index + 1);
+
+    worker->start(NULL);
+
+    return true;
+}
+
+/*static*/ void UMLRTControllerPool::add ( UMLRTController * controller )
+{
+    if (!isEnabled())
+    {
+        FATAL("controller %s added to a pool that was not started", controller->name());
+    }
+    {
+        UMLRTGuard g(controllersMutex);
+
+        if (numControllers == maxControllers)
+        {
+            size_t newMax = (maxControllers == 0) ? 16 : maxControllers * 2;
+            UMLRTController * * newControllers = (UMLRTController * *)realloc(controllers, newMax * sizeof(UMLRTController *));
+            if (newControllers == NULL)
+            {
+                FATAL("controller pool - controller list allocation failed");
+            }
+            controllers = newControllers;
+            maxControllers = newMax;
+        }
+        controllers[numControllers++] = controller;
+    }
+    OSAtomic::fetchAdd(&liveControllers, 1);
+
+    BDEBUG(BD_CONTROLLER, "%s: added to controller pool\n", controller->name());
+
+    // Run it the first time to start it up.
+    schedule(controller);
+}
+
+/*static*/ void UMLRTControllerPool::schedule ( UMLRTController * controller )
+{
+    for (;;)
+    {
+        int state = OSAtomic::load(&controller->poolState);
+
+        if (state == IDLE)
+        {
+            if (OSAtomic::compareAndSwap(&controller->poolState, (int)IDLE, (int)QUEUED))
+            {
+                break;
+            }
+        }
+        else if (state == RUNNING)
+        {
+            // The worker running it will queue it again when it finishes its current pass.
+            if (OSAtomic::compareAndSwap(&controller->poolState, (int)RUNNING, (int)RERUN))
+            {
+                return;
+            }
+        }
+        else
+        {
+            // Already queued, already marked to re-run or done.
+            return;
+        }
+    }
+    // Favour the calling worker - the controller is likely to be receiving from the controller it just ran.
+    Worker * worker = (Worker *)currentWorker;
+    if (worker == NULL)
+    {
+        unsigned int count = (unsigned int)OSAtomic::load(&numWorkers);
+        worker = workers[OSAtomic::fetchAdd(&nextWorker, 1U) % count];
+    }
+    worker->push(controller);
+
+    // Order the push before the check for idle workers (see Worker::run).
+    OSAtomic::fence();
+    if (OSAtomic::load(&idleWorkers) > 0)
+    {
+        wakeup.post();
+    }
+}
+
+/*static*/ void UMLRTControllerPool::timerStarted ( )
+{
+    // Idle workers compute their sleep from the timers running when they went idle.
+    if (isEnabled() && (OSAtomic::load(&idleWorkers) > 0))
+    {
+        wakeup.post();
+    }
+}
+
+/*static*/ UMLRTController * UMLRTControllerPool::current ( )
+{
+    return (UMLRTController *)currentController;
+}
+
+/*static*/ void UMLRTControllerPool::blockingBegin ( )
+{
+    if (currentWorker == NULL)
+    {
+        return;
+    }
+    // If this was the last worker able to run controllers, add one so the controller being waited on can run.
+    if ((OSAtomic::fetchAdd(&blockedWorkers, 1) + 1) >= OSAtomic::load(&numWorkers))
+    {
+        if (!addWorker())
+        {
+            FATAL("controller pool - all %d workers blocked", USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS);
+        }
+        BDEBUG(BD_CONTROLLER, "controller pool - all workers blocked - added worker %d\n", OSAtomic::load(&numWorkers) - 1);
+    }
+}
+
+/*static*/ void UMLRTControllerPool::blockingEnd ( )
+{
+    if (currentWorker != NULL)
+    {
+        OSAtomic::fetchAdd(&blockedWorkers, -1);
+    }
+}
+
+/*static*/ UMLRTController * UMLRTControllerPool::findWork ( Worker * worker )
+{
+    UMLRTController * controller = worker->pop();
+
+    if (controller == NULL)
+    {
+        int count = OSAtomic::load(&numWorkers);
+        for (int i = 1; (i < count) && (controller == NULL); ++i)
+        {
+            controller = workers[(worker->index + i) % count]->steal();
+        }
+        if (controller != NULL)
+        {
+            BDEBUG(BD_CONTROLLER, "%s: stole controller %s\n", worker->getName(), controller->name());
+        }
+    }
+    return controller;
+}
+
+/*static*/ void UMLRTControllerPool::execute ( Worker * worker, UMLRTController * controller )
+{
+    OSAtomic::store(&controller->poolState, (int)RUNNING);
+    currentController = controller;
+
+    if (!controller->poolStarted)
+    {
+        controller->poolStarted = true;
+        controller->startup();
+    }
+    controller->dispatch();
+
+    currentController = NULL;
+
+    if (controller->_exit || controller->_abort)
+    {
+        OSAtomic::store(&controller->poolState, (int)DONE);
+
+        // Run the exit processing as the controller - it outputs its own queues.
+        currentController = controller;
+        controller->shutdown();
+        currentController = NULL;
+
+        controller->poolDone.post();
+
+        if (OSAtomic::fetchAdd(&liveControllers, -1) == 1)
+        {
+            stop();
+        }
+    }
+    else if (controller->isReady())
+    {
+        // Still has work - go to the back of the queue so other controllers get their turn.
+        OSAtomic::store(&controller->poolState, (int)QUEUED);
+        worker->push(controller);
+    }
+    else if (!OSAtomic::compareAndSwap(&controller->poolState, (int)RUNNING, (int)IDLE))
+    {
+        // Scheduled again while it was running.
+        OSAtomic::store(&controller->poolState, (int)QUEUED);
+        worker->push(controller);
+    }
+}
+
+/*static*/ int UMLRTControllerPool::checkTimers ( uint32_t * msec )
+{
+    UMLRTGuard g(controllersMutex);
+
+    // One reading of the clock serves all the controllers.
+    UMLRTClockCache now;
+
+    int scheduled = 0;
+    for (size_t i = 0; i < numControllers; ++i)
+    {
+        UMLRTController * controller = controllers[i];
+
+        if ((OSAtomic::load(&controller->poolState) == IDLE) && !controller->timerQueue.isEmpty())
+        {
+            UMLRTTimespec remain = controller->timerQueue.timeRemaining(now);
+            if (remain.isZeroOrNegative())
+            {
+                schedule(controller);
+                ++scheduled;
+            }
+            else
+            {
+                // Round up so we do not wake up just before the timer is due.
+                uint32_t remainMsec = remain.tv_sec * 1000 + (remain.tv_nsec + 999999) / 1000000;
+                if (remainMsec < *msec)
+                {
+                    *msec = remainMsec;
+                }
+            }
+        }
+    }
+    return scheduled;
+}
+
+/*static*/ void UMLRTControllerPool::stop ( )
+{
+    BDEBUG(BD_CONTROLLER, "controller pool - all controllers done - stopping workers\n");
+
+    OSAtomic::store(&stopping, true);
+
+    int count = OSAtomic::load(&numWorkers);
+    for (int i = 0; i < count; ++i)
+    {
+        wakeup.post();
+    }
+}
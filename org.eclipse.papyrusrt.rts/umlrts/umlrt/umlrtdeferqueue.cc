@@ -0,0 +1,173 @@
+// umlrtdeferqueue.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "basefatal.hh"
+#include "umlrtdeferqueue.hh"
+#include "umlrtguard.hh"
+#include "umlrtmessage.hh"
+
+// See umlrtdeferqueue.hh for documentation.
+
+UMLRTDeferQueue::UMLRTDeferQueue ( size_t numFarEnd )
+    : buckets(NULL), numBuckets((numFarEnd > 0) ? numFarEnd : 1), ownBuckets(true), head(NULL), tail(NULL), _count(0)
+{
+    buckets = new Bucket[numBuckets];
+    initBuckets();
+}
+
+UMLRTDeferQueue::UMLRTDeferQueue ( size_t numFarEnd, void * bucketStorage )
+    : buckets((Bucket *)bucketStorage), numBuckets((numFarEnd > 0) ? numFarEnd : 1), ownBuckets(false), head(NULL), tail(NULL), _count(0)
+{
+    initBuckets();
+}
+
+UMLRTDeferQueue::~UMLRTDeferQueue ( )
+{
+    if (ownBuckets)
+    {
+        delete[] buckets;
+    }
+}
+
+void UMLRTDeferQueue::initBuckets ( )
+{
+    for (size_t i = 0; i < numBuckets; ++i)
+    {
+        buckets[i].head = buckets[i].tail = NULL;
+    }
+}
+
+void UMLRTDeferQueue::enqueue ( UMLRTMessage * msg )
+{
+    UMLRTGuard g(mutex);
+
+    Bucket & b = bucket(msg->sapIndex0());
+
+    msg->next = NULL;
+    msg->deferPrev = tail;
+    if (tail == NULL)
+    {
+        head = msg;
+    }
+    else
+    {
+        tail->next = msg;
+    }
+    tail = msg;
+
+    msg->deferIndexNext = NULL;
+    msg->deferIndexPrev = b.tail;
+    if (b.tail == NULL)
+    {
+        b.head = msg;
+    }
+    else
+    {
+        b.tail->deferIndexNext = msg;
+    }
+    b.tail = msg;
+
+    ++_count;
+}
+
+void UMLRTDeferQueue::unlink ( UMLRTMessage * msg )
+{
+    UMLRTMessage * next = (UMLRTMessage *)msg->next;
+
+    if (msg->deferPrev == NULL)
+    {
+        head = next;
+    }
+    else
+    {
+        msg->deferPrev->next = next;
+    }
+    if (next == NULL)
+    {
+        tail = msg->deferPrev;
+    }
+    else
+    {
+        next->deferPrev = msg->deferPrev;
+    }
+
+    Bucket & b = bucket(msg->sapIndex0());
+
+    if (msg->deferIndexPrev == NULL)
+    {
+        b.head = msg->deferIndexNext;
+    }
+    else
+    {
+        msg->deferIndexPrev->deferIndexNext = msg->deferIndexNext;
+    }
+    if (msg->deferIndexNext == NULL)
+    {
+        b.tail = msg->deferIndexPrev;
+    }
+    else
+    {
+        msg->deferIndexNext->deferIndexPrev = msg->deferIndexPrev;
+    }
+    msg->next = NULL;
+    msg->deferPrev = msg->deferIndexNext = msg->deferIndexPrev = NULL;
+
+    if (!_count)
+    {
+        FATAL("defer q(%p) count already zero", this);
+    }
+    --_count;
+}
+
+int UMLRTDeferQueue::remove ( int index, int id, bool one, match_notify_t notify, void * userData )
+{
+    UMLRTGuard g(mutex);
+
+    int count = 0;
+
+    // A single port instance only needs its own bucket.
+    UMLRTMessage * msg = (index < 0) ? head : bucket(index).head;
+
+    while (msg != NULL)
+    {
+        // Remember the successor - the message is unlinked before 'notify' re-queues or frees it.
+        UMLRTMessage * next = (index < 0) ? (UMLRTMessage *)msg->next : msg->deferIndexNext;
+
+        if (((index < 0) || ((int)msg->sapIndex0() == index)) && ((id < 0) || (msg->getSignalId() == id)))
+        {
+            unlink(msg);
+            notify(msg, userData);
+            ++count;
+            if (one)
+            {
+                break;
+            }
+        }
+        msg = next;
+    }
+    return count;
+}
+
+int UMLRTDeferQueue::walk ( UMLRTQueue::walk_callback_t callback, void * userData ) const
+{
+    UMLRTGuard g(mutex);
+
+    int count = 0;
+
+    for (const UMLRTMessage * msg = head; msg != NULL; msg = (const UMLRTMessage *)msg->next)
+    {
+        ++count;
+        if (callback(msg, userData))
+        {
+            break;
+        }
+    }
+    return count;
+}
@@ -5,11 +5,16 @@
 *******************************************************************************/
 
 #include "umlrtcapsule.hh"
+#include "umlrtcapsulepart.hh"
 #include "umlrtdeploymentmap.hh"
 #include "umlrtcontroller.hh"
 #include "umlrtslot.hh"
 #include "umlrthost.hh"
 #include "umlrthashmap.hh"
+#include "umlrtthreadattributes.hh"
+#include "umlrtmessagepool.hh"
+#include "umlrtsignalelementpool.hh"
+#include "umlrttimerpool.hh"
 #include "basefatal.hh"
 #include "basedebug.hh"
 #include "basedebugtype.hh"
@@ -22,9 +27,15 @@
 #include "osutil.hh"
 
 #include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/schema.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <algorithm>
 
 UMLRTHashMap * UMLRTDeploymentMap::capsuleToControllerMap = NULL;
 UMLRTHashMap * UMLRTDeploymentMap::controllerToHostMap = NULL;
+UMLRTHashMap * UMLRTDeploymentMap::controllerAttributesMap = NULL;
 UMLRTHashMap * UMLRTDeploymentMap::controllerNameMap = NULL;
 UMLRTHashMap * UMLRTDeploymentMap::capsuleNameMap = NULL;
 UMLRTHashMap * UMLRTDeploymentMap::hostNameMap = NULL;
@@ -33,7 +44,7 @@ UMLRTHashMap * UMLRTDeploymentMap::slotNameMap = NULL;
 UMLRTSlot * UMLRTDeploymentMap::defaultSlotList = NULL;
 int UMLRTDeploymentMap::numDefaultSlotList = 0;
 
-const char * UMLRTDeploymentMap::payload = NULL;
+char * UMLRTDeploymentMap::payload = NULL;
 
 // The 3 maps above are created dynamically and persist forever.
 // capsuleToControllerMap
@@ -76,6 +87,15 @@ const char * UMLRTDeploymentMap::payload = NULL;
     return controllerToHostMap;
 }
 
+/*static*/ UMLRTHashMap * UMLRTDeploymentMap::getControllerAttributesMap()
+{
+    if (controllerAttributesMap == NULL)
+    {
+        controllerAttributesMap = new UMLRTHashMap("controllerAttributesMap", UMLRTHashMap::compareString, false/*objectIsString*/);
+    }
+    return controllerAttributesMap;
+}
+
 /*static*/ UMLRTHashMap * UMLRTDeploymentMap::getCapsuleNameMap()
 {
     if (capsuleNameMap == NULL)
@@ -254,6 +274,27 @@ const char * UMLRTDeploymentMap::payload = NULL;
     getControllerNameMap()->unlock();
 }
 
+/*static*/ size_t UMLRTDeploymentMap::getControllers ( UMLRTController * controllers[], size_t max )
+{
+    size_t count = 0;
+
+    getControllerNameMap()->lock();
+    UMLRTHashMap::Iterator iter = getControllerNameMap()->getIterator();
+
+    while (iter != iter.end())
+    {
+        if (count < max)
+        {
+            controllers[count] = (UMLRTController *)iter.getObject();
+        }
+        ++count;
+        iter = iter.next();
+    }
+    getControllerNameMap()->unlock();
+
+    return count;
+}
+
 /*static*/ void UMLRTDeploymentMap::spawnAllControllers ( )
 {
     getControllerNameMap()->lock();
@@ -311,6 +352,11 @@ const char * UMLRTDeploymentMap::payload = NULL;
     return NULL;
 }
 
+/*static*/ const UMLRTThreadAttributes * UMLRTDeploymentMap::getControllerAttributes ( const char * controllerName )
+{
+    return (const UMLRTThreadAttributes *)getControllerAttributesMap()->getObject(controllerName);
+}
+
 /*static*/ UMLRTHost * UMLRTDeploymentMap::getHostForController ( const char * controllerName )
 {
     const char * hostName = getHostNameForController( controllerName );
@@ -394,10 +440,200 @@ const char * UMLRTDeploymentMap::payload = NULL;
    return false;
 }
 
+// Optional controller members: "cpus" (list "0-3,8" or array of CPU numbers), "policy" ("fifo", "rr" or "other"),
+// "priority" (real-time priority), "stacksize" (bytes) and "numanode".
+// Returns true if any attribute was defined.
+static bool parseControllerAttributes( const char * controllerName, const rapidjson::Value & controller, UMLRTThreadAttributes & attributes )
+{
+    if (controller.HasMember("cpus"))
+    {
+        const rapidjson::Value & cpus = controller["cpus"];
+        if (cpus.IsString())
+        {
+            if (!attributes.parseCpuList(cpus.GetString()))
+                FATAL("controller %s: invalid cpu list '%s'\n", controllerName, cpus.GetString());
+        }
+        else if (cpus.IsArray())
+        {
+            for (rapidjson::Value::ConstValueIterator cpu = cpus.Begin(); cpu != cpus.End(); ++cpu)
+            {
+                if (!cpu->IsInt() || (cpu->GetInt() < 0) || (cpu->GetInt() >= UMLRTThreadAttributes::MAX_CPUS))
+                    FATAL("controller %s: invalid cpu in cpu list\n", controllerName);
+                attributes.addCpu(cpu->GetInt());
+            }
+        }
+        else
+        {
+            FATAL("controller %s: cpus must be a string or an array\n", controllerName);
+        }
+    }
+    if (controller.HasMember("policy"))
+    {
+        if (!controller["policy"].IsString() || !attributes.parsePolicy(controller["policy"].GetString()))
+            FATAL("controller %s: policy must be 'fifo', 'rr' or 'other'\n", controllerName);
+    }
+    if (controller.HasMember("priority"))
+    {
+        if (!controller["priority"].IsInt())
+            FATAL("controller %s: priority must be an integer\n", controllerName);
+        attributes.priority = controller["priority"].GetInt();
+        if (attributes.policy == UMLRTThreadAttributes::POLICY_DEFAULT)
+        {
+            // A priority on its own implies the real-time FIFO policy.
+            attributes.policy = UMLRTThreadAttributes::POLICY_FIFO;
+        }
+    }
+    if (controller.HasMember("stacksize"))
+    {
+        if (!controller["stacksize"].IsUint())
+            FATAL("controller %s: stacksize must be a positive integer\n", controllerName);
+        attributes.stackSize = controller["stacksize"].GetUint();
+    }
+    if (controller.HasMember("numanode"))
+    {
+        if (!controller["numanode"].IsInt() || (controller["numanode"].GetInt() < 0))
+            FATAL("controller %s: numanode must be a non-negative integer\n", controllerName);
+        attributes.numaNode = controller["numanode"].GetInt();
+    }
+    return attributes.isDefined();
+}
+
+// The "pools" member as it was loaded, passed on to the hosts the map is sent to. NULL if none.
+static char * poolsJson = NULL;
+
+// Optional "pools" members: "message", "signal" and "timer", each with optional "initial" (elements reserved
+// up front), "max" (0 is unbounded) and "increment"; and "memory" ("pages", "thp" or "huge") for all of them.
+// Sizes that are not given are left as they are.
+static void parsePools( const rapidjson::Value & pools )
+{
+    static const char * poolNames[] = { "message", "signal", "timer" };
+    UMLRTPool * poolList[] = { UMLRTController::getMessagePool(), UMLRTController::getSignalElementPool(), UMLRTController::getTimerPool() };
+
+    bool hasBacking = pools.HasMember("memory");
+    UMLRTMemoryRegion::Backing backing = UMLRTMemoryRegion::BACKING_PAGES;
+    if (hasBacking && !UMLRTMemoryRegion::parseBacking(pools["memory"].GetString(), backing))
+        FATAL("pools: memory must be 'pages', 'thp' or 'huge'\n");
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!pools.HasMember(poolNames[i]) && !hasBacking)
+            continue;
+        UMLRTPool * pool = poolList[i];
+        if (pool == NULL)
+            FATAL("pools: %s pool is not defined yet\n", poolNames[i]);
+
+        size_t initial = pool->getSize();
+        size_t max = pool->getMaxSize();
+        size_t increment = pool->getIncrement();
+        if (pools.HasMember(poolNames[i]))
+        {
+            const rapidjson::Value & spec = pools[poolNames[i]];
+            if (spec.HasMember("initial"))
+                initial = spec["initial"].GetUint64();
+            if (spec.HasMember("max"))
+                max = spec["max"].GetUint64();
+            if (spec.HasMember("increment"))
+                increment = spec["increment"].GetUint64();
+            if ((max != 0) && (max < initial))
+                FATAL("pools: %s max must be 0 or at least initial\n", poolNames[i]);
+        }
+        if (!pool->configure(initial, max, increment, hasBacking ? backing : pool->getBacking()))
+            FATAL("pools: could not reserve %lu %s pool elements\n", (unsigned long)initial, poolNames[i]);
+
+        BDEBUG(BD_CONTROLLERMAP, "%s pool: %lu elements reserved, max %lu, increment %lu, %s\n", poolNames[i], (unsigned long)pool->getSize(),
+                (unsigned long)pool->getMaxSize(), (unsigned long)pool->getIncrement(), UMLRTMemoryRegion::backingName(pool->getBacking()));
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    pools.Accept(writer);
+    poolsJson = strdup(buffer.GetString());
+}
+
+// Schema of the deployment map. The controller attributes are checked further by parseControllerAttributes.
+static const char * deploymentSchema =
+    "{"
+    " \"type\": \"object\","
+    " \"required\": [ \"hosts\", \"controllers\", \"capsules\" ],"
+    " \"definitions\": {"
+    "  \"name\": { \"type\": \"string\", \"minLength\": 1 },"
+    "  \"pool\": { \"type\": \"object\", \"properties\": {"
+    "   \"initial\": { \"type\": \"integer\", \"minimum\": 0 },"
+    "   \"max\": { \"type\": \"integer\", \"minimum\": 0 },"
+    "   \"increment\": { \"type\": \"integer\", \"minimum\": 1 }"
+    "  } }"
+    " },"
+    " \"properties\": {"
+    "  \"hosts\": { \"type\": \"array\", \"items\": {"
+    "   \"type\": \"object\","
+    "   \"required\": [ \"name\", \"address\" ],"
+    "   \"properties\": {"
+    "    \"name\": { \"$ref\": \"#/definitions/name\" },"
+    "    \"address\": { \"$ref\": \"#/definitions/name\" }"
+    "   }"
+    "  } },"
+    "  \"controllers\": { \"type\": \"array\", \"items\": {"
+    "   \"type\": \"object\","
+    "   \"required\": [ \"name\", \"host\" ],"
+    "   \"properties\": {"
+    "    \"name\": { \"$ref\": \"#/definitions/name\" },"
+    "    \"host\": { \"$ref\": \"#/definitions/name\" },"
+    "    \"cpus\": { \"type\": [ \"string\", \"array\" ], \"items\": { \"type\": \"integer\", \"minimum\": 0 } },"
+    "    \"policy\": { \"type\": \"string\" },"
+    "    \"priority\": { \"type\": \"integer\" },"
+    "    \"stacksize\": { \"type\": \"integer\", \"minimum\": 0 },"
+    "    \"numanode\": { \"type\": \"integer\", \"minimum\": 0 }"
+    "   }"
+    "  } },"
+    "  \"capsules\": { \"type\": \"array\", \"items\": {"
+    "   \"type\": \"object\","
+    "   \"required\": [ \"name\", \"controller\" ],"
+    "   \"properties\": {"
+    "    \"name\": { \"$ref\": \"#/definitions/name\" },"
+    "    \"controller\": { \"$ref\": \"#/definitions/name\" }"
+    "   }"
+    "  } },"
+    "  \"pools\": { \"type\": \"object\", \"properties\": {"
+    "   \"message\": { \"$ref\": \"#/definitions/pool\" },"
+    "   \"signal\": { \"$ref\": \"#/definitions/pool\" },"
+    "   \"timer\": { \"$ref\": \"#/definitions/pool\" },"
+    "   \"memory\": { \"enum\": [ \"pages\", \"thp\", \"huge\" ] }"
+    "  } }"
+    " }"
+    "}";
+
+static void validate( const rapidjson::Document & document )
+{
+	if(document.HasParseError())
+		FATAL("deployment map: %s (offset %lu)\n", rapidjson::GetParseError_En(document.GetParseError()), (unsigned long)document.GetErrorOffset());
+
+	rapidjson::Document schemaDocument;
+	schemaDocument.Parse(deploymentSchema);
+	rapidjson::SchemaDocument schema(schemaDocument);
+	rapidjson::SchemaValidator validator(schema);
+
+	if(!document.Accept(validator))
+	{
+		rapidjson::StringBuffer documentPointer, schemaPointer;
+		validator.GetInvalidDocumentPointer().StringifyUriFragment(documentPointer);
+		validator.GetInvalidSchemaPointer().StringifyUriFragment(schemaPointer);
+		FATAL("deployment map: invalid at '%s' - fails '%s' of schema '%s'\n",
+				documentPointer.GetString(), validator.GetInvalidSchemaKeyword(), schemaPointer.GetString());
+	}
+}
+
+// The map is parsed in-situ: names are not copied, the map entries point into 'payload', which persists
+// forever (like the maps). The capsule-to-controller and controller-to-host maps are each loaded in one
+// sorted pass rather than one O(n) insert per entry.
 /*static*/ void UMLRTDeploymentMap::decode( const char* json )
 {
+	if(payload != NULL)
+		FATAL("Deployment map already loaded\n");
+
+	payload = strdup(json);
+
 	rapidjson::Document document;
-	document.Parse(json);
+	document.ParseInsitu(payload);
+	validate(document);
 
 	const rapidjson::Value& hosts = document["hosts"];
 	for (rapidjson::Value::ConstValueIterator itr = hosts.Begin(); itr != hosts.End(); ++itr) {
@@ -417,37 +653,197 @@ const char * UMLRTDeploymentMap::payload = NULL;
 	}
 
 	const rapidjson::Value& controllers = document["controllers"];
-	for (rapidjson::Value::ConstValueIterator itr = controllers.Begin(); itr != controllers.End(); ++itr) {
-		const char * controllerName = (*itr)["name"].GetString();
-		const char * hostName = (*itr)["host"].GetString();
-
-        UMLRTHost* host = UMLRTDeploymentMap::getHostFromName( hostName );
-        if(host == NULL)
+	std::vector<const void *> keys(controllers.Size());
+	std::vector<void *> objects(controllers.Size());
+	for (rapidjson::SizeType i = 0; i < controllers.Size(); ++i) {
+		const rapidjson::Value& controller = controllers[i];
+		const char * controllerName = controller["name"].GetString();
+		const char * hostName = controller["host"].GetString();
+
+        if(getHostFromName( hostName ) == NULL)
             FATAL("No such host: %s\n", hostName);
 
-        UMLRTDeploymentMap::addControllerToHost( (char*)controllerName, (char*)hostName );
+        keys[i] = controllerName;
+        objects[i] = (void *)hostName;
+
+        UMLRTThreadAttributes attributes;
+        if (parseControllerAttributes( controllerName, controller, attributes ))
+            setControllerAttributes( controllerName, attributes );
+	}
+	if(!keys.empty())
+	{
+		const void * duplicate = getControllerToHostMap()->insertAll(&keys[0], &objects[0], (int)keys.size());
+		if(duplicate != NULL)
+			FATAL("controller-to-host-map already had an entry for controller '%s'", (const char *)duplicate);
 	}
 
 	const rapidjson::Value& capsules = document["capsules"];
-	for (rapidjson::Value::ConstValueIterator itr = capsules.Begin(); itr != capsules.End(); ++itr) {
-		const char * capsuleName = (*itr)["name"].GetString();
-		const char * controllerName = (*itr)["controller"].GetString();
+	keys.resize(capsules.Size());
+	objects.resize(capsules.Size());
+	for (rapidjson::SizeType i = 0; i < capsules.Size(); ++i) {
+		const char * capsuleName = capsules[i]["name"].GetString();
+		const char * controllerName = capsules[i]["controller"].GetString();
+
+		if(getHostNameForController(controllerName) == NULL)
+			FATAL("capsule %s: no such controller: %s\n", capsuleName, controllerName);
 
-		//TODO: check that controller exists
-		UMLRTDeploymentMap::addCapsuleToController( (char*)capsuleName, (char*)controllerName );
+		keys[i] = capsuleName;
+		objects[i] = (void *)controllerName;
+	}
+	if(!keys.empty())
+	{
+		const void * duplicate = getCapsuleToControllerMap()->insertAll(&keys[0], &objects[0], (int)keys.size());
+		if(duplicate != NULL)
+			FATAL("capsule-to-controller-map already had an entry for capsule '%s'", (const char *)duplicate);
 	}
 
-	if(payload != NULL)
-		free((void*)payload);
-	payload = strdup(json);
+	if(document.HasMember("pools"))
+		parsePools(document["pools"]);
+}
+
+/*static*/ void UMLRTDeploymentMap::setControllerAttributes( const char * controllerName, const UMLRTThreadAttributes & attributes )
+{
+    char buf[256];
+    BDEBUG(BD_CONTROLLERMAP, "controller %s attributes %s\n", controllerName, attributes.toString(buf, sizeof(buf)));
+
+    UMLRTThreadAttributes * existing = (UMLRTThreadAttributes *)getControllerAttributesMap()->getObject(controllerName);
+    if (existing != NULL)
+        *existing = attributes;
+    else
+        getControllerAttributesMap()->insert(strdup(controllerName), (void *)new UMLRTThreadAttributes(attributes));
+}
+
+// Add the hosts deployed from the slots of 'host' - and, in turn, the hosts they deploy - to 'deployed'.
+static void addDeployedHosts( const UMLRTHost * host, const UMLRTSlot * slots, int numSlots, std::vector<const UMLRTHost *> & deployed )
+{
+	deployed.push_back(host);
+
+	for (int i = 0; i < numSlots; ++i)
+	{
+		// A capsule that is not in the map is instantiated on every host.
+		const UMLRTHost * slotHost = UMLRTDeploymentMap::getHostForCapsule(slots[i].name);
+		if((slotHost != NULL) && (slotHost != host))
+			continue;
+
+		for (size_t j = 0; j < slots[i].numParts; ++j)
+		{
+			for (size_t k = 0; k < slots[i].parts[j].numSlot; ++k)
+			{
+				const UMLRTHost * childHost = UMLRTDeploymentMap::getHostForCapsule(slots[i].parts[j].slots[k]->name);
+				if((childHost != NULL) && (std::find(deployed.begin(), deployed.end(), childHost) == deployed.end()))
+					addDeployedHosts(childHost, slots, numSlots, deployed);
+			}
+		}
+	}
 }
 
-/*static*/ const char * UMLRTDeploymentMap::encode( )
+static void encodeControllerAttributes( rapidjson::Writer<rapidjson::StringBuffer> & writer, const UMLRTThreadAttributes & attributes )
 {
-    if( payload == NULL )
-        FATAL("Deployment map not encoded yet\n");
+    static const char * policyNames[] = { "other", "fifo", "rr" };
+
+    if (attributes.numCpus > 0)
+    {
+        writer.Key("cpus");
+        writer.StartArray();
+        for (int cpu = 0; cpu < UMLRTThreadAttributes::MAX_CPUS; ++cpu)
+        {
+            if (attributes.hasCpu(cpu))
+                writer.Int(cpu);
+        }
+        writer.EndArray();
+    }
+    if (attributes.policy != UMLRTThreadAttributes::POLICY_DEFAULT)
+    {
+        writer.Key("policy");
+        writer.String(policyNames[attributes.policy]);
+        writer.Key("priority");
+        writer.Int(attributes.priority);
+    }
+    if (attributes.stackSize != 0)
+    {
+        writer.Key("stacksize");
+        writer.Uint64(attributes.stackSize);
+    }
+    if (attributes.numaNode >= 0)
+    {
+        writer.Key("numanode");
+        writer.Int(attributes.numaNode);
+    }
+}
+
+// Every host instantiates all the slots and routes to remote ones by the capsule-to-controller-to-host
+// map, so all hosts, controllers and capsules are sent. Controller attributes are only sent for the
+// controllers of 'receiver' and of the hosts it deploys in turn.
+/*static*/ char * UMLRTDeploymentMap::encode( const UMLRTHost * receiver )
+{
+	if( payload == NULL )
+		FATAL("Deployment map not loaded yet\n");
+
+	std::vector<const UMLRTHost *> deployed;
+	addDeployedHosts(receiver, defaultSlotList, numDefaultSlotList, deployed);
+
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	writer.StartObject();
+
+	writer.Key("hosts");
+	writer.StartArray();
+	getHostNameMap()->lock();
+	for (UMLRTHashMap::Iterator iter = getHostNameMap()->getIterator(); iter != iter.end(); iter = iter.next())
+	{
+		const UMLRTHost * host = (const UMLRTHost *)iter.getObject();
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(host->name);
+		writer.Key("address");
+		writer.String(host->address);
+		writer.EndObject();
+	}
+	getHostNameMap()->unlock();
+	writer.EndArray();
+
+	writer.Key("controllers");
+	writer.StartArray();
+	getControllerToHostMap()->lock();
+	for (UMLRTHashMap::Iterator iter = getControllerToHostMap()->getIterator(); iter != iter.end(); iter = iter.next())
+	{
+		const char * controllerName = (const char *)iter.getKey();
+		const char * hostName = (const char *)iter.getObject();
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(controllerName);
+		writer.Key("host");
+		writer.String(hostName);
+		const UMLRTThreadAttributes * attributes = getControllerAttributes(controllerName);
+		if((attributes != NULL) && (std::find(deployed.begin(), deployed.end(), getHostFromName(hostName)) != deployed.end()))
+			encodeControllerAttributes(writer, *attributes);
+		writer.EndObject();
+	}
+	getControllerToHostMap()->unlock();
+	writer.EndArray();
+
+	writer.Key("capsules");
+	writer.StartArray();
+	getCapsuleToControllerMap()->lock();
+	for (UMLRTHashMap::Iterator iter = getCapsuleToControllerMap()->getIterator(); iter != iter.end(); iter = iter.next())
+	{
+		writer.StartObject();
+		writer.Key("name");
+		writer.String((const char *)iter.getKey());
+		writer.Key("controller");
+		writer.String((const char *)iter.getObject());
+		writer.EndObject();
+	}
+	getCapsuleToControllerMap()->unlock();
+	writer.EndArray();
 
-    return payload;
+	if(poolsJson != NULL)
+	{
+		writer.Key("pools");
+		writer.RawValue(poolsJson, strlen(poolsJson), rapidjson::kObjectType);
+	}
+	writer.EndObject();
+	return strdup(buffer.GetString());
 }
 
 /*static*/ bool UMLRTDeploymentMap::isLoaded( )
@@ -518,7 +914,26 @@ const char * UMLRTDeploymentMap::payload = NULL;
     {
         while (iter != iter.end())
         {
-            BDEBUG(BD_MODEL, "    { %s, %p }\n", ((UMLRTHost *)((char *)iter.getObject()))->name, (UMLRTHost *)((char *)iter.getObject()));
+            UMLRTHost * host = (UMLRTHost *)((char *)iter.getObject());
+            BDEBUG(BD_MODEL, "    { %s, %p }\n", host->name, host);
+            if (host->compress)
+            {
+                BDEBUG(BD_MODEL, "        compressed %llu of %llu frames sent, ratio %.2f, %llu nsec; decompressed %llu frames, %llu nsec\n",
+                        (unsigned long long)host->framesCompressed,
+                        (unsigned long long)host->framesSent,
+                        (host->bytesAfterCompression > 0) ? (double)host->bytesBeforeCompression / host->bytesAfterCompression : 1.0,
+                        (unsigned long long)host->compressNsec,
+                        (unsigned long long)host->framesDecompressed,
+                        (unsigned long long)host->decompressNsec);
+            }
+            if ((host->framesRefused > 0) || (host->framesDropped > 0) || (host->sendsBlocked > 0))
+            {
+                BDEBUG(BD_MODEL, "        link out of credit: %llu frames refused, %llu dropped, %llu sends blocked; %lu frames queued\n",
+                        (unsigned long long)host->framesRefused,
+                        (unsigned long long)host->framesDropped,
+                        (unsigned long long)host->sendsBlocked,
+                        (unsigned long)host->queued);
+            }
             iter = iter.next();
         }
     }
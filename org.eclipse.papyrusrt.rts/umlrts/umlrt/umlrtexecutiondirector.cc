@@ -18,6 +18,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <string>
+#include <vector>
 
 /*static*/ UMLRTExecutionDirector* UMLRTExecutionDirector::instance = NULL;
 
@@ -32,20 +33,13 @@ UMLRTExecutionDirector::UMLRTExecutionDirector ( const char * _localaddr )
     slotsCount = UMLRTDeploymentMap::getDefaultSlotList(&slots);
 }    
 
-/*static*/ bool UMLRTExecutionDirector::sendSignal ( const UMLRTCommsPort * destPort, const UMLRTSignal &signal, size_t srcPortIndex )
+/*static*/ UMLRTCommunicator::Message * UMLRTExecutionDirector::newMessage ( UMLRTHost * destHost, const UMLRTSignal &signal, const std::string &json )
 {
-    if (instance->communicator == NULL)
-        FATAL("Destination slot %s is remote but no communicator instance found.", destPort->slot);
-
     UMLRTCommunicator::Message* msg = new UMLRTCommunicator::Message;
-    msg->destHost = destPort->slot->host;
+    msg->destHost = destHost;
 
-    msg->destSlot = destPort->slot->name;
     msg->srcSlot = signal.getSrcPort()->slot->name;
-
-    msg->destPort = destPort->roleIndex;
     msg->srcPort = signal.getSrcPort()->roleIndex;
-    msg->destInternal = destPort->border ? 0 : 1;
     msg->srcInternal = signal.getSrcPort()->border ? 0 : 1;
 
     msg->protocolName = signal.getSrcPort()->role()->protocol;
@@ -53,12 +47,95 @@ UMLRTExecutionDirector::UMLRTExecutionDirector ( const char * _localaddr )
 
     //msg->payload = (uint8_t*) malloc(signal.getPayloadSize());
     //memcpy(msg->payload, signal.getPayload(), signal.getPayloadSize());
-    std::string json = UMLRTSignalRegistry::getRegistry().toJSON(signal);
     msg->payload = strdup(json.c_str());
     msg->payloadSize = json.length()+1;
 
-    instance->communicator->queueMessage( msg );    
-    return true;
+    return msg;
+}
+
+/*static*/ void UMLRTExecutionDirector::addDestination ( UMLRTCommunicator::Message * msg, const UMLRTCommsPort * destPort, size_t srcPortIndex )
+{
+    UMLRTCommunicator::Message::Destination dest;
+    dest.slot = destPort->slot->name;
+    dest.port = destPort->roleIndex;
+    dest.internal = destPort->border ? 0 : 1;
+    dest.srcPortIndex = srcPortIndex;
+    msg->dests.push_back(dest);
+}
+
+/*static*/ bool UMLRTExecutionDirector::sendSignal ( const UMLRTCommsPort * destPort, const UMLRTSignal &signal, size_t srcPortIndex )
+{
+    if (instance->communicator == NULL)
+        FATAL("Destination slot %s is remote but no communicator instance found.", destPort->slot);
+
+    std::string json = UMLRTSignalRegistry::getRegistry().toJSON(signal);
+    UMLRTCommunicator::Message* msg = newMessage(destPort->slot->host, signal, json);
+    addDestination(msg, destPort, srcPortIndex);
+
+    return queueFrame( msg, signal.getSrcPort() );
+}
+
+/*static*/ bool UMLRTExecutionDirector::queueFrame ( UMLRTCommunicator::Message * msg, const UMLRTCommsPort * srcPort )
+{
+    // Assumes global RTS lock acquired. A blocking send releases it while it waits for link credit -
+    // the frame is complete, so nothing the lock protects is used meanwhile.
+    UMLRTCommunicator::QueueResult result = instance->communicator->queueMessage( msg, srcPort->linkPolicy );
+
+    if (result == UMLRTCommunicator::WOULD_BLOCK)
+    {
+        UMLRTFrameService::rtsUnlock();
+        result = instance->communicator->queueMessageWait( msg );
+        UMLRTFrameService::rtsLock();
+    }
+    if (result == UMLRTCommunicator::REFUSED)
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_SEND_LINK_FULL);
+        return false;
+    }
+    return true; // Queued, or dropped by the port's policy.
+}
+
+/*static*/ bool UMLRTExecutionDirector::sendSignalAll ( const UMLRTSignal &signal )
+{
+    const UMLRTCommsPort * srcPort = signal.getSrcPort();
+    std::vector<UMLRTCommunicator::Message*> frames; // One per destination host.
+    std::string json;
+
+    for (size_t i = 0; i < srcPort->numFarEnd; ++i)
+    {
+        const UMLRTCommsPort * destPort = srcPort->farEnds[i].port;
+
+        if ((destPort == NULL) || !destPort->slot->remote || destPort->slot->condemned)
+        {
+            continue; // Local far ends and errors are handled by the sender.
+        }
+        if (instance->communicator == NULL)
+            FATAL("Destination slot %s is remote but no communicator instance found.", destPort->slot);
+
+        if (frames.empty())
+        {
+            // Encode the payload once for all hosts.
+            json = UMLRTSignalRegistry::getRegistry().toJSON(signal);
+        }
+        size_t f = 0;
+        while ((f < frames.size()) && (frames[f]->destHost != destPort->slot->host))
+        {
+            ++f;
+        }
+        if (f == frames.size())
+        {
+            frames.push_back(newMessage(destPort->slot->host, signal, json));
+        }
+        addDestination(frames[f], destPort, i);
+    }
+    bool ok = false;
+    for (size_t f = 0; f < frames.size(); ++f)
+    {
+        BDEBUG(BD_SEND, "signal '%s' multicast to %d destinations on host %s\n", signal.getName(), frames[f]->dests.size(), frames[f]->destHost->name);
+
+        ok |= queueFrame( frames[f], srcPort );
+    }
+    return ok;
 }
 
 /*static*/void UMLRTExecutionDirector::spawn ( )
@@ -84,11 +161,10 @@ void  UMLRTExecutionDirector::joinThread ( )
 
 void  UMLRTExecutionDirector::deploy ( )
 {
+    // Place every slot before creating any capsule: the generated 'create' gives remote slots a
+    // proxy (ports only - see UMLRTProxyCapsule) instead of an instance of the capsule.
     for( int i=0; i<slotsCount; i++ )
     {
-        // [FIXME] we should only init capsules of non-remote slots!!
-        slots[i].capsuleClass->create(&slots[i]);
-
         const char* controllerName = UMLRTDeploymentMap::getControllerNameForCapsule(slots[i].name);
         if( controllerName != NULL )
         {
@@ -112,6 +188,11 @@ void  UMLRTExecutionDirector::deploy ( )
         }
     }
 
+    for( int i=0; i<slotsCount; i++ )
+    {
+        slots[i].capsuleClass->create(&slots[i]);
+    }
+
     for( int i=0; i<slotsCount; i++ )
     {
 		UMLRTSignal emptySignal;
@@ -297,10 +378,6 @@ void * UMLRTExecutionDirector::run ( void * args )
             continue;
         }
 
-        UMLRTSlot* destSlot = UMLRTDeploymentMap::getSlotFromName(msg->destSlot);
-        if(destSlot == NULL)
-         FATAL("Invalid destination slot %s", msg->destSlot);
-
         UMLRTSlot* srcSlot = UMLRTDeploymentMap::getSlotFromName(msg->srcSlot);
         if(srcSlot == NULL)
          FATAL("Invalid source slot %s", msg->srcSlot);
@@ -311,24 +388,34 @@ void * UMLRTExecutionDirector::run ( void * args )
         else
         		srcPort = srcSlot->capsule->getBorderPorts()[msg->srcPort];
 
+        // Decode the payload once and fan out to every destination listed in the frame.
         UMLRTSignal signal;
         UMLRTSignalRegistry::getRegistry().fromJSON(msg->payload, srcPort, signal);
 
-        if(destSlot->capsule == NULL)
-            FATAL("No capsule in destination slot");
+        // The slot's controller may change (see UMLRTController::migrate) - deliver with the RTS lock held.
+        UMLRTFrameService::rtsLock();
+        for( size_t i = 0; i < msg->dests.size(); i++ )
+        {
+            UMLRTSlot* destSlot = UMLRTDeploymentMap::getSlotFromName(msg->dests[i].slot.c_str());
+            if(destSlot == NULL)
+             FATAL("Invalid destination slot %s", msg->dests[i].slot.c_str());
 
-        if(destSlot->controller == NULL)
-            FATAL("No controller for capsule %s", destSlot->capsule->getName());
+            if(destSlot->capsule == NULL)
+                FATAL("No capsule in destination slot");
 
-        const UMLRTCommsPort * destPort;
-        if(msg->destInternal)
-            destPort = destSlot->capsule->getInternalPorts()[msg->destPort];
-        else
-            destPort = destSlot->capsule->getBorderPorts()[msg->destPort];
+            if(destSlot->controller == NULL)
+                FATAL("No controller for capsule %s", destSlot->capsule->getName());
 
-        bool ok = destSlot->controller->deliver(destPort, signal,  msg->srcPort);
-        if(!ok)
-            FATAL("Error delivering signal to controller");
+            const UMLRTCommsPort * destPort;
+            if(msg->dests[i].internal)
+                destPort = destSlot->capsule->getInternalPorts()[msg->dests[i].port];
+            else
+                destPort = destSlot->capsule->getBorderPorts()[msg->dests[i].port];
+
+            if(!destSlot->controller->deliver(destPort, signal, msg->dests[i].srcPortIndex))
+                FATAL("Error delivering signal to controller");
+        }
+        UMLRTFrameService::rtsUnlock();
 
         // don't release to keep msg->signalName && msg->payload
         delete msg;
@@ -15,13 +15,14 @@
 #include "umlrtcommsport.hh"
 #include "umlrtcommsportfarend.hh"
 #include "umlrtframeservice.hh"
+#include "umlrtfreeslots.hh"
 #include "umlrtmessage.hh"
 #include "umlrtprotocol.hh"
 #include "umlrtslot.hh"
+#include "umlrtsubstructure.hh"
 #include "basedebugtype.hh"
 #include "basedebug.hh"
 #include "basefatal.hh"
-#include <sstream>
 
 // Use a global lock on the RTS for now for modifying ports and access far-end ports during message delivery.
 /*static*/ UMLRTMutex UMLRTFrameService::rtsGlobalLock;
@@ -478,7 +479,7 @@
 
 /*static*/ void UMLRTFrameService::condemnParts ( UMLRTSlot * slot )
 {
-    slot->condemned = true;
+    UMLRTController::setCondemned(slot, true);
     for (size_t i = 0; i < slot->numParts; ++i)
     {
         for (size_t j = 0; j < slot->parts[i].numSlot; ++j)
@@ -718,7 +719,9 @@ void UMLRTFrameService::connectFarEnds ( const UMLRTCommsPort * p1, size_t p1Ind
         slot->controller->deallocateSlotResources( slot, slot->capsule, false/*isDestroy*/ );
 
         slot->capsuleClass = slot->role()->capsuleClass; // restore the original capsuleClass
+        slot->controller->evict(slot);
         slot->capsule = NULL; // Removes record of this instance, but the instance lives on in its original optional slot.
+        vacateSlot(slot);
     }
     // Get lock if we don't have it.
     if (!lockAcquired)
@@ -870,11 +873,13 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
         destroyPortList(borderPorts, capsuleClass->numPortRolesBorder, true/*proxiesOnly*/);
         destroyPortList(internalPorts, capsuleClass->numPortRolesInternal, false/*proxiesOnly*/);
 
+        slot->controller->evict(slot);
         slot->capsule = NULL;
         slot->capsuleClass = slot->role()->capsuleClass; // restore the original capsuleClass
+        vacateSlot(slot);
 
         // Destroy parts data-structures. The destroy requests have already been enqueued for sub-slots, but need to clean up this slot's part structures.
-        destroyPartsBookkeeping(slot->numParts, slot->parts);
+        UMLRTSubstructure::releaseParts(slot);
         slot->parts = NULL;
         slot->numParts = 0;
     }
@@ -894,14 +899,12 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
 
     if (!isTopSlot)
     {
-        // Is a sub-slot in a condemned sub-capsule structure - delete the slot itself.
-        destroyPortArray(slot->ports, slot->numPorts);
-        free((void*)slot->name);
-        delete slot;
+        // Is a sub-slot in a condemned sub-capsule structure - release the slot (and its ports) to the sub-structure block.
+        UMLRTSubstructure::releaseSlot(slot);
     }
     else
     {
-        slot->condemned = false; // Top capsule slot no longer 'condemned' - it has no instance, but is not condemned.
+        UMLRTController::setCondemned(slot, false); // Top capsule slot no longer 'condemned' - it has no instance, but is not condemned.
     }
     // Unlock RTS if we locked it here.
     if (!lockAcquired)
@@ -971,6 +974,7 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
             slot->controller = capsule->getSlot()->controller;
             slot->capsule = capsule;
             slot->capsuleClass = slot->capsule->getSlot()->capsuleClass;
+            occupySlot(slot);
             ok = true;
         }
         if (!lockAcquired)
@@ -1002,82 +1006,6 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     return ports;
 }
 
-/*static*/ char * UMLRTFrameService::createName ( const char * prefix, const char * suffix, size_t index, bool appendIndex )
-{
-    char ind[23]; // 18,446,744,073,709,551,615 is largest possible index in a 64-bit architecture.
-    ind[0] = '\0';
-    if (appendIndex)
-    {
-        std::ostringstream oss;
-        oss << "[" << index << "]";
-        strncpy(ind, oss.str().c_str(), sizeof(ind));
-    }
-    char * name = (char*)malloc(strlen(prefix) + strlen(suffix) + strlen(ind) + 2);
-
-    if (!name)
-    {
-        FATAL("could not allocate part name prefix(%s) suffix(%s) index(%d) appendIndex(%d)", prefix, suffix, index, appendIndex);
-    }
-    strcpy(name, prefix);
-    strcat(name, ".");
-    strcat(name, suffix);
-    if (appendIndex)
-    {
-        strcat(name, ind);
-    }
-    return name;
-}
-
-/*static*/ UMLRTCapsulePart * UMLRTFrameService::createParts ( const char * containerName, const UMLRTCapsuleClass * containerClass )
-{
-    UMLRTCapsulePart * parts = NULL;
-
-    if (containerClass->numSubcapsuleRoles)
-    {
-        parts = new UMLRTCapsulePart[containerClass->numSubcapsuleRoles];
-
-        for (size_t i = 0; i < containerClass->numSubcapsuleRoles; ++i)
-        {
-            const UMLRTCapsuleRole * role = &containerClass->subcapsuleRoles[i];
-            parts[i].containerClass = containerClass;
-            parts[i].numSlot = role->multiplicityUpper;
-            parts[i].slots = new UMLRTSlot * [role->multiplicityUpper];
-            parts[i].roleIndex = i;
-
-            for (size_t j = 0; j < role->multiplicityUpper; ++j)
-            {
-                // define the slot for this part
-                char * name = createName(containerName, role->name, j, (role->multiplicityUpper > 1)/*appendIndex*/);
-
-                // Create the sub-structure
-                const UMLRTCapsulePart * subcapsuleParts = createParts( name, role->capsuleClass );
-
-                UMLRTSlot templateSlot = {
-                        name,
-                        j, // capsuleIndex
-                        role->capsuleClass,
-                        containerClass,
-                        i,
-                        NULL, // capsule,
-                        NULL, // controller
-                        false, // remote
-                        NULL, // remoteHost
-                        role->capsuleClass->numSubcapsuleRoles, // numParts
-                        subcapsuleParts,
-                        role->capsuleClass->numPortRolesBorder,
-                        NULL, // ports
-                        NULL, // slotToBorderMap
-                        0, // generated
-                        0, // condemned
-                };
-                parts[i].slots[j] = new UMLRTSlot(templateSlot);
-                parts[i].slots[j]->ports = createPortArray(parts[i].slots[j], role->capsuleClass);
-            }
-        }
-    }
-    return parts;
-}
-
 /*static*/ const UMLRTCommsPort * UMLRTFrameService::createPort ( UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass, int roleIndex,
         bool border, bool importProxy, bool isUnbound )
 {
@@ -1086,17 +1014,6 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     return new const UMLRTCommsPort(templatePort);
 }
 
-/*static*/ const UMLRTCommsPort * UMLRTFrameService::createPortArray ( UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass )
-{
-    UMLRTCommsPort * ports = new UMLRTCommsPort[capsuleClass->numPortRolesBorder];
-
-    for (size_t i = 0; i < capsuleClass->numPortRolesBorder; ++i)
-    {
-        definePort( &ports[i], slot, capsuleClass, i, true/*border*/, false/*importProxy*/, false/*isUnbound*/);
-    }
-    return ports;
-}
-
 /*static*/ const UMLRTCommsPort * * UMLRTFrameService::createBorderPorts ( UMLRTSlot * slot, size_t numPorts )
 {
     const UMLRTCommsPort * * borderPorts = new const UMLRTCommsPort * [numPorts];
@@ -1108,7 +1025,8 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     return borderPorts;
 }
 
-/*static*/ void UMLRTFrameService::definePort ( UMLRTCommsPort * port, UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass, int roleIndex, bool border, bool importProxy, bool isUnbound )
+/*static*/ void UMLRTFrameService::definePort ( UMLRTCommsPort * port, UMLRTSlot * slot, const UMLRTCapsuleClass * capsuleClass, int roleIndex, bool border, bool importProxy, bool isUnbound,
+        UMLRTCommsPortFarEnd * farEnds, UMLRTDeferQueue * deferQueue )
 {
     const UMLRTCommsPortRole * portRole = border ? &capsuleClass->portRolesBorder[roleIndex] : &capsuleClass->portRolesInternal[roleIndex];
 
@@ -1128,6 +1046,7 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     port->spp = portRole->spp;
     port->unbound = isUnbound;
     port->wired = portRole->wired;
+    port->linkPolicy = LINK_POLICY_ERROR;
     port->registeredName = NULL;
     port->registrationOverride = portRole->registrationOverride;
     if (port->numFarEnd == 0)
@@ -1137,8 +1056,8 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     }
     else
     {
-        port->farEnds = new UMLRTCommsPortFarEnd[portRole->numFarEnd];
-        port->deferQueue = new UMLRTMessageQueue();
+        port->farEnds = (farEnds != NULL) ? farEnds : new UMLRTCommsPortFarEnd[portRole->numFarEnd];
+        port->deferQueue = (deferQueue != NULL) ? deferQueue : new UMLRTDeferQueue(portRole->numFarEnd);
     }
     // Leave all ports disconnected for now. We connect them after the structure is built.
     for (size_t j = 0; j < port->numFarEnd; ++j)
@@ -1190,18 +1109,6 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     }
 }
 
-/*static*/ void UMLRTFrameService::destroyPartsBookkeeping ( size_t numParts, const UMLRTCapsulePart * parts )
-{
-    // Assumes global RTS lock already acquired.
-
-    // Deletes the array of slot pointers, but the not the slots themselves.
-    for (size_t i = 0; i < numParts; ++i)
-    {
-        delete[] parts[i].slots;
-    }
-    delete[] parts;
-}
-
 /*static*/ void UMLRTFrameService::destroyPort ( const UMLRTCommsPort * port, bool deletePort )
 {
     // Assumes global RTS lock already acquired.
@@ -1235,20 +1142,6 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     }
 }
 
-/*static*/ void UMLRTFrameService::destroyPortArray ( const UMLRTCommsPort * ports, const size_t numPorts )
-{
-    // Assumes global RTS lock already acquired.
-
-    if (ports != NULL)
-    {
-        for (size_t i = 0; i < numPorts; ++i)
-        {
-            destroyPort(&ports[i], false/*deletePort*/); // The ports are part of the array and not individual objects.
-        }
-        delete[] ports;
-    }
-}
-
 /*static*/ void UMLRTFrameService::destroyPortList ( const UMLRTCommsPort * * ports, size_t numPorts, bool proxiesOnly )
 {
     // Assumes global RTS lock already acquired.
@@ -1371,21 +1264,50 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     return capsuleController;
 }
 
+/*static*/ UMLRTFreeSlots * UMLRTFrameService::getFreeSlots ( const UMLRTCapsulePart * part )
+{
+    // Assumes global RTS lock already acquired.
+
+    if (part->freeSlots == NULL)
+    {
+        // A generated part - start tracking its free slots from their current occupancy.
+        part->freeSlots = new UMLRTFreeSlots(part->numSlot);
+
+        for (size_t i = 0; i < part->numSlot; ++i)
+        {
+            part->slots[i]->part = part;
+            if (part->slots[i]->capsule != NULL)
+            {
+                part->freeSlots->occupy(part->slots[i]->capsuleIndex);
+            }
+        }
+    }
+    return part->freeSlots;
+}
+
 // Get the next free capsule slot - return -1 if there's none.
 /*static*/ int UMLRTFrameService::getNextFreeCapsuleSlot ( const UMLRTCapsulePart * part )
 {
-    int nextFree = -1;
+    // Assumes global RTS lock already acquired.
+    return getFreeSlots(part)->first();
+}
 
-    // Look for a slot with no controller assigned.
+/*static*/ void UMLRTFrameService::occupySlot ( UMLRTSlot * slot )
+{
+    // Assumes global RTS lock already acquired.
+    if (slot->part != NULL)
+    {
+        slot->part->freeSlots->occupy(slot->capsuleIndex);
+    }
+}
 
-    for (size_t i = 0; (i < part->numSlot) && (nextFree == -1); ++i)
+/*static*/ void UMLRTFrameService::vacateSlot ( UMLRTSlot * slot )
+{
+    // Assumes global RTS lock already acquired.
+    if (slot->part != NULL)
     {
-        if (part->slots[i]->capsule == NULL)
-        {
-            nextFree = i;
-        }
+        slot->part->freeSlots->vacate(slot->capsuleIndex);
     }
-    return nextFree;
 }
 
 /*static*/ const UMLRTRtsInterface * UMLRTFrameService::getRtsInterface ( )
@@ -1413,6 +1335,9 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     }
     else
     {
+        // Obtain RTS lock.
+        rtsLock();
+
         if (index < 0)
         {
             index = getNextFreeCapsuleSlot(destPart);
@@ -1428,9 +1353,6 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
         }
         else
         {
-            // Obtain RTS lock.
-            rtsLock();
-
             UMLRTSlot * destSlot = destPart->slots[index];
 
             const UMLRTCommsPort * * borderPorts = NULL; // Not used to modify capsule instance - only used to check binding.
@@ -1462,15 +1384,14 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
                 ok = requestControllerImport(destSlot, capsule, true/*lockAcquired*/);
             }
 
-            // Unlock RTS
-            rtsUnlock();
-
             // We don't need this copy of the border ports - it was used to check port binding success only.
             if (borderPorts != NULL)
             {
                 delete[] borderPorts;
             }
         }
+        // Unlock RTS
+        rtsUnlock();
     }
     return ok;
 }
@@ -1503,93 +1424,145 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     }
     else
     {
-        if (index < 0)
-        {
-            index = getNextFreeCapsuleSlot(part);
-        }
-        if (index < 0)
-        {
-            // Returned id will be the 'invalid capsule id'.
-            srcPort->slot->controller->setError(UMLRTController::E_INC_NO_FREE_SLOT);
-        }
-        else if (index >= (int)part->numSlot)
-        {
-            FATAL("internal error obtaining next free capsule index(%d) max(%d)", index, part->numSlot);
-        }
-        else
-        {
-            // Obtain global RTS lock
-            rtsLock();
+        UMLRTSlot * slot = incarnateReserveSlot(srcPort, part, index);
 
-            UMLRTSlot * slot = part->slots[index];
-
-            const UMLRTCommsPort * * borderPorts = NULL; // Defines the border port mapping.
-
-            bool compatible = false;
+        if (slot != NULL)
+        {
+            // Build the sub-structure and assign its controllers without the global RTS lock - nothing else can reach
+            // them until they are published. The reservation keeps other incarnations out of the slot.
+            UMLRTCapsulePart * parts = UMLRTSubstructure::create(slot->name, capsuleClass);
+            UMLRTController * controller = getCapsuleController(slot, part, logThread, assignedController, srcPort->slot->controller, index);
 
-            if (slot == NULL)
-            {
-                FATAL("slot %s has NULL part slot[%d]", srcPort->slotName(), index);
-            }
-            if (slot->capsule != NULL)
-            {
-                srcPort->slot->controller->setError(UMLRTController::E_INC_SLOT_OCC);
-            }
-            else if (slot->parts != NULL)
-            {
-                srcPort->slot->controller->setError(UMLRTController::E_INC_PARTS_ERROR);
-            }
-            else if (slot->capsuleClass == capsuleClass)
-            {
-                compatible = true; // The border ports are the slot ports.
-                borderPorts = createBorderPorts(slot, capsuleClass->numPortRolesBorder);
-            }
-            else if ((borderPorts  = bindPorts(slot, NULL, capsuleClass, part->role()->capsuleClass, NULL /*borderPorts*/, true/*bind*/, false/*import*/)) != NULL)
-            {
-                // Bound OK - and the capsule's borderPorts are defined.
-                compatible = true;
-            }
-            else
+            for (size_t i = 0; i < capsuleClass->numSubcapsuleRoles; ++i)
             {
-                srcPort->slot->controller->setError(UMLRTController::E_INC_COMPAT);
-            }
-            if (!compatible)
-            {
-                // Error already set - occupied, parts error, requested capsule type does not have port-compatibility.
-                if (borderPorts)
+                for (size_t j = 0; j < parts[i].numSlot; ++j)
                 {
-                    delete[] borderPorts;
+                    defineSlotControllers(parts[i].slots[j], &parts[i], parts[i].slots[j]->capsuleClass, logThread, assignedController, controller, j);
                 }
             }
-            else
-            {
-               // Over-write with occupier's type.
-                slot->capsuleClass = capsuleClass;
+            // Bind the slot ports and publish with the lock held.
+            rtsLock();
 
-                // Recurse into sub-structure creating parts.
-                slot->parts = createParts(slot->name, capsuleClass);
-                slot->numParts = capsuleClass->numSubcapsuleRoles;
+            id = incarnatePublish(srcPort, part, slot, capsuleClass, parts, controller, userData, type);
+            UMLRTSubstructure::unpin(slot);
 
-                // Recurse into sub-structure assigning the controllers to the capsule and parts.
-                defineSlotControllers(slot, part, capsuleClass, logThread, assignedController, srcPort->slot->controller, index);
+            rtsUnlock();
+        }
+    }
+    return id;
+}
 
-                BDEBUG(BD_INSTANTIATE, "instantiate capsule class %s into slot %s\n", slot->capsuleClass->name, slot->name);
+/*static*/ UMLRTSlot * UMLRTFrameService::incarnateReserveSlot ( const UMLRTCommsPort * srcPort, const UMLRTCapsulePart * part, int & index )
+{
+    UMLRTSlot * slot = NULL;
 
-                slot->capsuleClass->instantiate(&rtsifUmlrt, slot, borderPorts);
+    // Obtain global RTS lock
+    rtsLock();
 
-                if (slot->capsule)
-                {
-                    // Recurse into sub-structure requesting the associated controllers to send the capsule initialize messages.
-                    requestControllerIncarnate(slot, srcPort, userData, type);
-                }
-                // Send rtBound to slot far-ends that are not relay ports.
-                incarnateSendBoundSlotFarEnd(slot);
-                id = UMLRTCapsuleId(slot->capsule);
-            }
-            rtsUnlock();
+    UMLRTFreeSlots * freeSlots = getFreeSlots(part);
+
+    if (index < 0)
+    {
+        index = freeSlots->first();
+    }
+    if (index < 0)
+    {
+        // Returned id will be the 'invalid capsule id'.
+        srcPort->slot->controller->setError(UMLRTController::E_INC_NO_FREE_SLOT);
+    }
+    else if (index >= (int)part->numSlot)
+    {
+        FATAL("internal error obtaining next free capsule index(%d) max(%d)", index, part->numSlot);
+    }
+    else if (part->slots[index] == NULL)
+    {
+        FATAL("slot %s has NULL part slot[%d]", srcPort->slotName(), index);
+    }
+    else if ((part->slots[index]->capsule != NULL) || !freeSlots->isFree(index))
+    {
+        // Occupied, or another incarnation into the slot is being prepared.
+        srcPort->slot->controller->setError(UMLRTController::E_INC_SLOT_OCC);
+    }
+    else if (part->slots[index]->parts != NULL)
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_INC_PARTS_ERROR);
+    }
+    else
+    {
+        slot = part->slots[index];
+        occupySlot(slot);
+
+        // The slot may be in an incarnated sub-structure that is destroyed before the incarnation is published.
+        UMLRTSubstructure::pin(slot);
+    }
+    rtsUnlock();
+
+    return slot;
+}
+
+/*static*/ UMLRTCapsuleId UMLRTFrameService::incarnatePublish ( const UMLRTCommsPort * srcPort, const UMLRTCapsulePart * part, UMLRTSlot * slot,
+        const UMLRTCapsuleClass * capsuleClass, UMLRTCapsulePart * parts, UMLRTController * controller, const void * userData, const UMLRTObject_class * type )
+{
+    // Assumes global RTS lock already acquired.
+
+    const UMLRTCommsPort * * borderPorts = NULL; // Defines the border port mapping.
+
+    bool compatible = false;
+
+    if (slot->condemned)
+    {
+        // The slot's container was destroyed while the incarnation was prepared.
+        srcPort->slot->controller->setError(UMLRTController::E_INC_SLOT_DSTR);
+    }
+    else if (slot->capsuleClass == capsuleClass)
+    {
+        compatible = true; // The border ports are the slot ports.
+        borderPorts = createBorderPorts(slot, capsuleClass->numPortRolesBorder);
+    }
+    else if ((borderPorts  = bindPorts(slot, NULL, capsuleClass, part->role()->capsuleClass, NULL /*borderPorts*/, true/*bind*/, false/*import*/)) != NULL)
+    {
+        // Bound OK - and the capsule's borderPorts are defined.
+        compatible = true;
+    }
+    else
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_INC_COMPAT);
+    }
+    if (!compatible)
+    {
+        // Error already set - condemned or requested capsule type does not have port-compatibility. Release the reservation.
+        UMLRTSubstructure::discard(parts);
+        vacateSlot(slot);
+    }
+    else
+    {
+        // Over-write with occupier's type.
+        slot->capsuleClass = capsuleClass;
+
+        slot->parts = parts;
+        slot->numParts = capsuleClass->numSubcapsuleRoles;
+
+        if ((slot->controller = controller) == NULL)
+        {
+            FATAL("slot %s controller NULL", slot->name);
+        }
+        BDEBUG(BD_INSTANTIATE, "instantiate capsule class %s into slot %s\n", slot->capsuleClass->name, slot->name);
+
+        slot->capsuleClass->instantiate(&rtsifUmlrt, slot, borderPorts);
+
+        if (slot->capsule)
+        {
+            // Recurse into sub-structure requesting the associated controllers to send the capsule initialize messages.
+            requestControllerIncarnate(slot, srcPort, userData, type);
         }
+        else
+        {
+            vacateSlot(slot);
+        }
+        // Send rtBound to slot far-ends that are not relay ports.
+        incarnateSendBoundSlotFarEnd(slot);
     }
-    return id;
+    return UMLRTCapsuleId(compatible ? slot->capsule : NULL);
 }
 
 /*static*/ void UMLRTFrameService::incarnateSendBoundSlotFarEnd ( UMLRTSlot * slot )
@@ -1719,7 +1692,7 @@ void UMLRTFrameService::controllerDeportUnbind ( UMLRTSlot * slot, const UMLRTCo
     {
         if ((port->deferQueue == NULL) && !port->unbound && (port->wired || port->sap || port->spp))
         {
-            port->deferQueue = new UMLRTMessageQueue();
+            port->deferQueue = new UMLRTDeferQueue(port->numFarEnd);
         }
         // Handle automatic service port registration.
         if (port->sap && port->automatic)
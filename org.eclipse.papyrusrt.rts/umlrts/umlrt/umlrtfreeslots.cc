@@ -0,0 +1,107 @@
+// umlrtfreeslots.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtfreeslots.hh"
+#include "basefatal.hh"
+#include "osutil.hh"
+
+// See umlrtfreeslots.hh for documentation.
+
+UMLRTFreeSlots::UMLRTFreeSlots ( size_t numSlot_ )
+    : numSlot(numSlot_), words(NULL), summary(NULL), ownStorage(true)
+{
+    words = new word_t[wordsFor(numSlot) + wordsFor(wordsFor(numSlot))];
+    summary = words + wordsFor(numSlot);
+    init();
+}
+
+UMLRTFreeSlots::UMLRTFreeSlots ( size_t numSlot_, void * storage )
+    : numSlot(numSlot_), words((word_t *)storage), summary(NULL), ownStorage(false)
+{
+    summary = words + wordsFor(numSlot);
+    init();
+}
+
+UMLRTFreeSlots::~UMLRTFreeSlots ( )
+{
+    if (ownStorage)
+    {
+        delete[] words;
+    }
+}
+
+/*static*/ size_t UMLRTFreeSlots::storageSize ( size_t numSlot )
+{
+    return (wordsFor(numSlot) + wordsFor(wordsFor(numSlot))) * sizeof(word_t);
+}
+
+void UMLRTFreeSlots::init ( )
+{
+    // Every slot free. Bits past the last slot (and the last word) stay clear so #first never returns them.
+    size_t numWords = wordsFor(numSlot);
+
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        words[i] = ~(word_t)0;
+    }
+    if ((numSlot % WORD_BITS) != 0)
+    {
+        words[numWords - 1] = ((word_t)1 << (numSlot % WORD_BITS)) - 1;
+    }
+    for (size_t i = 0; i < wordsFor(numWords); ++i)
+    {
+        summary[i] = ~(word_t)0;
+    }
+    if ((numWords % WORD_BITS) != 0)
+    {
+        summary[wordsFor(numWords) - 1] = ((word_t)1 << (numWords % WORD_BITS)) - 1;
+    }
+}
+
+int UMLRTFreeSlots::first ( ) const
+{
+    size_t numSummary = wordsFor(wordsFor(numSlot));
+
+    for (size_t i = 0; i < numSummary; ++i)
+    {
+        if (summary[i] != 0)
+        {
+            size_t word = i * WORD_BITS + osCountTrailingZeros(summary[i]);
+            return word * WORD_BITS + osCountTrailingZeros(words[word]);
+        }
+    }
+    return -1;
+}
+
+void UMLRTFreeSlots::occupy ( size_t index )
+{
+    if (index >= numSlot)
+    {
+        FATAL("slot index %lu out of range (%lu slots)", (unsigned long)index, (unsigned long)numSlot);
+    }
+    size_t word = index / WORD_BITS;
+
+    if ((words[word] &= ~((word_t)1 << (index % WORD_BITS))) == 0)
+    {
+        summary[word / WORD_BITS] &= ~((word_t)1 << (word % WORD_BITS));
+    }
+}
+
+void UMLRTFreeSlots::vacate ( size_t index )
+{
+    if (index >= numSlot)
+    {
+        FATAL("slot index %lu out of range (%lu slots)", (unsigned long)index, (unsigned long)numSlot);
+    }
+    size_t word = index / WORD_BITS;
+
+    words[word] |= (word_t)1 << (index % WORD_BITS);
+    summary[word / WORD_BITS] |= (word_t)1 << (word % WORD_BITS);
+}
@@ -17,6 +17,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "osutil.hh"
+#include <algorithm>
 
 UMLRTHashMap::~UMLRTHashMap ( )
 {
@@ -213,6 +214,61 @@ void UMLRTHashMap::insert ( const void * key, void * object )
     }
 }
 
+// Orders map entries by key for the sort in #insertAll.
+struct UMLRTHashMapEntryLess
+{
+    UMLRTHashMapEntryLess ( UMLRTHashMap::key_compare_t compare_ ) : compare(compare_) {}
+    template <typename Entry>
+    bool operator() ( const Entry & e1, const Entry & e2 ) const { return compare(e1.key, e2.key) < 0; }
+    UMLRTHashMap::key_compare_t compare;
+};
+
+const void * UMLRTHashMap::insertAll ( const void * const keys[], void * const objects[], int count )
+{
+    UMLRTGuard g(mutex);
+
+    if (count <= 0)
+    {
+        return NULL;
+    }
+    MapEntry * merged = (MapEntry *)malloc((mapSize + count) * sizeof(MapEntry));
+    if (merged == NULL)
+    {
+        FATAL("map %s: failed to allocate %d entries", name, mapSize + count);
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        merged[i].key = keys[i];
+        merged[i].object = objects[i];
+    }
+    std::sort(merged, merged + count, UMLRTHashMapEntryLess(compare));
+
+    // Merge with the existing (sorted) entries, rejecting duplicates.
+    if (mapSize > 0)
+    {
+        memcpy(&merged[count], map, mapSize * sizeof(MapEntry));
+        std::inplace_merge(merged, merged + count, merged + count + mapSize, UMLRTHashMapEntryLess(compare));
+    }
+    for (int i = 1; i < (mapSize + count); ++i)
+    {
+        if (compare(merged[i - 1].key, merged[i].key) == 0)
+        {
+            const void * duplicate = merged[i].key;
+            free(merged);
+            return duplicate;
+        }
+    }
+    if (mapSize > 0)
+    {
+        free(map);
+    }
+    map = merged;
+    mapSize += count;
+    debugOutput("UMLRTHashMap::insertAll", NULL, "count", count, false, "", "");
+
+    return NULL;
+}
+
 int UMLRTHashMap::locate ( const void * key ) const
 {
     // Assumes mutex is taken.
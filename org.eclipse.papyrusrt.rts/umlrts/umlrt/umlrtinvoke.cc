@@ -0,0 +1,333 @@
+// umlrtinvoke.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtcapsule.hh"
+#include "umlrtcommsport.hh"
+#include "umlrtcommsportfarend.hh"
+#include "umlrtcontroller.hh"
+#include "umlrtcontrollerpool.hh"
+#include "umlrtframeservice.hh"
+#include "umlrtguard.hh"
+#include "umlrtinvoke.hh"
+#include "umlrtmessage.hh"
+#include "umlrtmutex.hh"
+#include "umlrtsemaphore.hh"
+#include "umlrtslot.hh"
+#include "umlrtuserconfig.hh"
+#include "osatomic.hh"
+#include "basefatal.hh"
+#include "basedebugtype.hh"
+#include "basedebug.hh"
+
+// See umlrtinvoke.hh for documentation.
+
+// Innermost same-controller invoke running on this thread.
+static OS_THREAD_LOCAL UMLRTInvoke * localInvoke = NULL;
+
+// This thread's reply slot.
+static OS_THREAD_LOCAL UMLRTInvoke * threadSlot = NULL;
+
+UMLRTInvoke::UMLRTInvoke ( ) : srcPort(NULL), srcPortIndex(0), replyMsg(NULL), numReply(0), generation(0), pending(false),
+        outer(NULL), mutex(NULL), done(NULL)
+{
+
+}
+
+/*static*/ UMLRTInvoke * UMLRTInvoke::getThreadSlot ( )
+{
+    if (threadSlot == NULL)
+    {
+        threadSlot = new UMLRTInvoke();
+        threadSlot->mutex = new UMLRTMutex();
+        threadSlot->done = new UMLRTSemaphore(0);
+    }
+    return threadSlot;
+}
+
+/*static*/ bool UMLRTInvoke::isReentrant ( const UMLRTCommsPort * srcPort, const UMLRTCommsPort * destPort )
+{
+    // The invoker is mid-transition, as is every invoker further up the stack.
+    if (destPort->slot->capsule == srcPort->slot->capsule)
+    {
+        return true;
+    }
+    for (const UMLRTInvoke * invoke = localInvoke; invoke != NULL; invoke = invoke->outer)
+    {
+        if (destPort->slot->capsule == invoke->srcPort->slot->capsule)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*static*/ int UMLRTInvoke::invokeAt ( const UMLRTSignal & signal, int index, UMLRTMessage * replyMsg )
+{
+    const UMLRTCommsPort * srcPort = signal.getSrcPort();
+    UMLRTController * controller = srcPort->slot->controller;
+    const UMLRTCommsPort * destPort = NULL;
+    bool local = false;
+
+    // Lock the RTS to validate the destination.
+    UMLRTFrameService::rtsLock();
+
+    if (srcPort->slot->condemned)
+    {
+        controller->setError(UMLRTController::E_SEND_FROM_DSTR);
+    }
+    else if ((index < 0) || ((size_t)index >= srcPort->numFarEnd))
+    {
+        controller->setError(UMLRTController::E_SEND_NO_PORT_INST);
+    }
+    else if ((destPort = srcPort->farEnds[index].port) == NULL)
+    {
+        controller->setError(UMLRTController::E_SEND_PRT_NOT_CON);
+    }
+    else if (destPort->slot->condemned)
+    {
+        controller->setError(UMLRTController::E_SEND_TO_DSTR);
+    }
+    else if (destPort->slot->remote)
+    {
+        controller->setError(UMLRTController::E_INVOKE_REMOTE);
+    }
+    else if (destPort->slot->capsule == NULL)
+    {
+        controller->setError(UMLRTController::E_SEND_NO_CAP_INST);
+    }
+    else if (destPort->slot->controller == NULL)
+    {
+        FATAL("Destination slot %s has no controller when invoking from capsule %s via port %s[%d].",
+                destPort->slot->name,
+                srcPort->slotName(),
+                srcPort->getName(),
+                index);
+    }
+    else if ((destPort->slot->controller == controller) && controller->isMyThread())
+    {
+        if (isReentrant(srcPort, destPort))
+        {
+            controller->setError(UMLRTController::E_INVOKE_REENTRANT);
+        }
+        else
+        {
+            local = true;
+        }
+    }
+    else
+    {
+        // Returns with the RTS unlocked.
+        return invokeQueued(signal, srcPort, index, replyMsg);
+    }
+    // Unlock the RTS
+    UMLRTFrameService::rtsUnlock();
+
+    // Only this controller can destroy the destination capsule, so it outlives the lock.
+    return local ? invokeLocal(signal, srcPort, index, replyMsg) : 0;
+}
+
+/*static*/ int UMLRTInvoke::invokeLocal ( const UMLRTSignal & signal, const UMLRTCommsPort * srcPort, int index, UMLRTMessage * replyMsg )
+{
+    const UMLRTCommsPort * destPort = srcPort->farEnds[index].port;
+
+    UMLRTInvoke invoke;
+    invoke.srcPort = srcPort;
+    invoke.srcPortIndex = index;
+    invoke.replyMsg = replyMsg;
+    invoke.outer = localInvoke;
+
+    // The message never reaches a queue, so it is not taken from the pool.
+    UMLRTMessage msg;
+    msg.sapIndex0_ = srcPort->farEnds[index].farEndIndex;
+    msg.signal = signal;
+    msg.destPort = destPort;
+    msg.destSlot = destPort->slot;
+    msg.srcPortIndex = index;
+    msg.invoke = &invoke;
+
+    BDEBUG(BD_SEND, "Controller '%s' capsule '%s' invoke signal '%s' from port '%s[%d]' to capsule '%s' port '%s' directly\n",
+            srcPort->slot->controller->getName(),
+            srcPort->slot->capsule->name(),
+            signal.getName(),
+            srcPort->getName(),
+            index,
+            destPort->slot->capsule->getName(),
+            destPort->getName());
+
+    localInvoke = &invoke;
+    destPort->slot->controller->injectInvoke(msg);
+    localInvoke = invoke.outer;
+
+    msg.invoke = NULL;
+
+    if (invoke.numReply > 0)
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_OK);
+    }
+    return invoke.numReply;
+}
+
+/*static*/ int UMLRTInvoke::invokeQueued ( const UMLRTSignal & signal, const UMLRTCommsPort * srcPort, int index, UMLRTMessage * replyMsg )
+{
+    // Assumes global RTS lock acquired - released here.
+    UMLRTController * controller = srcPort->slot->controller;
+    const UMLRTCommsPort * destPort = srcPort->farEnds[index].port;
+    UMLRTInvoke * slot = getThreadSlot();
+
+    UMLRTMessage * msg = destPort->slot->controller->prepareDelivery(destPort, signal, index);
+
+    if (msg == NULL)
+    {
+        // Error code set by 'prepareDelivery'.
+        UMLRTFrameService::rtsUnlock();
+        return 0;
+    }
+    {
+        UMLRTGuard g(*slot->mutex);
+
+        ++slot->generation;
+        slot->srcPort = srcPort;
+        slot->srcPortIndex = index;
+        slot->replyMsg = replyMsg;
+        slot->numReply = 0;
+        slot->pending = true;
+    }
+    msg->invoke = slot;
+    msg->invokeGeneration = slot->generation;
+
+    BDEBUG(BD_SEND, "Controller '%s' capsule '%s' invoke signal '%s' from port '%s[%d]' to capsule '%s' port '%s' via controller '%s'\n",
+            controller->getName(),
+            srcPort->slot->capsule->name(),
+            signal.getName(),
+            srcPort->getName(),
+            index,
+            destPort->slot->capsule->getName(),
+            destPort->getName(),
+            destPort->slot->controller->getName());
+
+    destPort->slot->controller->deliverAll(msg, msg, 1);
+
+    // Unlock the RTS before blocking.
+    UMLRTFrameService::rtsUnlock();
+
+    int numReply;
+
+    // In a worker pool, another worker runs the destination controller while this one waits.
+    UMLRTControllerPool::blockingBegin();
+    bool completed = slot->done->wait(USER_CONFIG_INVOKE_TIMEOUT_MSEC);
+    UMLRTControllerPool::blockingEnd();
+
+    if (completed)
+    {
+        numReply = slot->numReply;
+    }
+    else
+    {
+        bool timedOut;
+        {
+            UMLRTGuard g(*slot->mutex);
+
+            if ((timedOut = slot->pending))
+            {
+                // Orphan the message - a late reply or completion sees a different generation.
+                ++slot->generation;
+                slot->pending = false;
+            }
+            numReply = slot->numReply;
+        }
+        if (!timedOut)
+        {
+            // Completed while the wait was timing out - consume the post.
+            UMLRTControllerPool::blockingBegin();
+            slot->done->wait();
+            UMLRTControllerPool::blockingEnd();
+        }
+        else if (numReply == 0)
+        {
+            controller->setError(UMLRTController::E_INVOKE_TIMEOUT);
+        }
+    }
+    if (numReply > 0)
+    {
+        controller->setError(UMLRTController::E_OK);
+    }
+    return numReply;
+}
+
+/*static*/ bool UMLRTInvoke::reply ( const UMLRTSignal & signal )
+{
+    const UMLRTCommsPort * srcPort = signal.getSrcPort();
+    const UMLRTMessage * msg = (srcPort->slot->capsule != NULL) ? srcPort->slot->capsule->getMsg() : NULL;
+    UMLRTInvoke * invoke = (msg != NULL) ? msg->invoke : NULL;
+    bool ok = false;
+
+    // Reply is only allowed from the port the invoke being handled arrived on.
+    if ((invoke != NULL) && (msg->destPort == srcPort))
+    {
+        if (invoke->mutex != NULL)
+        {
+            // A queued invoke - the invoker may time out concurrently.
+            UMLRTGuard g(*invoke->mutex);
+
+            if (invoke->pending && (invoke->generation == msg->invokeGeneration))
+            {
+                ok = invoke->store(msg, signal);
+            }
+        }
+        else
+        {
+            ok = invoke->store(msg, signal);
+        }
+    }
+    BDEBUG(BD_SEND, "Capsule '%s' reply signal '%s' on port '%s' %s\n",
+            srcPort->slotName(),
+            signal.getName(),
+            srcPort->getName(),
+            ok ? "delivered" : "failed - no invoke to reply to");
+
+    srcPort->slot->controller->setError(ok ? UMLRTController::E_OK : UMLRTController::E_REPLY_NO_INVOKE);
+
+    return ok;
+}
+
+bool UMLRTInvoke::store ( const UMLRTMessage * msg, const UMLRTSignal & signal )
+{
+    if (numReply > 0)
+    {
+        return false;
+    }
+    // The invoker is blocked until the invoke completes, so its reply message can be written here.
+    replyMsg->signal = signal;
+    replyMsg->destPort = srcPort;
+    replyMsg->destSlot = srcPort->slot;
+    replyMsg->sapIndex0_ = srcPortIndex;
+    replyMsg->srcPortIndex = msg->sapIndex0_;
+    replyMsg->isCommand = false;
+    ++numReply;
+
+    return true;
+}
+
+/*static*/ void UMLRTInvoke::complete ( const UMLRTMessage * msg )
+{
+    UMLRTInvoke * invoke = msg->invoke;
+
+    if (invoke->mutex == NULL)
+    {
+        FATAL("same-controller invoke message of signal %s returned to the pool", msg->getSignalName());
+    }
+    UMLRTGuard g(*invoke->mutex);
+
+    if (invoke->pending && (invoke->generation == msg->invokeGeneration))
+    {
+        invoke->pending = false;
+        invoke->done->post();
+    }
+}
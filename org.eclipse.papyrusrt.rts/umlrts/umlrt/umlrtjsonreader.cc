@@ -0,0 +1,348 @@
+// umlrtjsonreader.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtjsonreader.hh"
+#include <limits>
+#include <string.h>
+
+// See umlrtjsonreader.hh for documentation.
+
+typedef UMLRTJsonReader::Scalar Scalar;
+
+// Convert an integer scalar to 'T', rejecting other kinds and values out of range.
+template <typename T>
+static bool toInteger ( const Scalar & s, T & v )
+{
+    if (s.kind == Scalar::INT)
+    {
+        if (!std::numeric_limits<T>::is_signed || (s.i < (int64_t)std::numeric_limits<T>::min()))
+        {
+            return false;
+        }
+        v = (T)s.i;
+        return true;
+    }
+    if ((s.kind == Scalar::UINT) && (s.u <= (uint64_t)std::numeric_limits<T>::max()))
+    {
+        v = (T)s.u;
+        return true;
+    }
+    return false;
+}
+
+template <typename T>
+static bool storeInteger ( const UMLRTObject_class * desc, const Scalar & s, void * dst )
+{
+    T v;
+    if (!toInteger(s, v))
+    {
+        return false;
+    }
+    desc->copy(desc, &v, dst);
+    return true;
+}
+
+template <typename T>
+static bool storeReal ( const UMLRTObject_class * desc, const Scalar & s, void * dst )
+{
+    T v;
+    switch (s.kind)
+    {
+    case Scalar::INT:  v = (T)s.i; break;
+    case Scalar::UINT: v = (T)s.u; break;
+    case Scalar::REAL: v = (T)s.d; break;
+    default:
+        return false;
+    }
+    desc->copy(desc, &v, dst);
+    return true;
+}
+
+// Store one scalar into an element of the primitive type 'desc'.
+static bool store ( const UMLRTObject_class * desc, const Scalar & s, void * dst )
+{
+    if (desc == &UMLRTType_bool)
+    {
+        if (s.kind != Scalar::BOOL)
+        {
+            return false;
+        }
+        bool b = s.b;
+        desc->copy(desc, &b, dst);
+        return true;
+    }
+    if (desc == &UMLRTType_char)
+    {
+        if ((s.kind != Scalar::STRING) || (s.length != 1))
+        {
+            return false;
+        }
+        desc->copy(desc, s.str, dst);
+        return true;
+    }
+    if (desc == &UMLRTType_charptr)
+    {
+        if (s.kind == Scalar::NUL)
+        {
+            *(char * *)dst = NULL;
+            return true;
+        }
+        if (s.kind != Scalar::STRING)
+        {
+            return false;
+        }
+        desc->copy(desc, &s.str, dst); // Duplicates the string.
+        return true;
+    }
+    if (desc == &UMLRTType_int)       return storeInteger<int>(desc, s, dst);
+    if (desc == &UMLRTType_uint)      return storeInteger<unsigned int>(desc, s, dst);
+    if (desc == &UMLRTType_short)     return storeInteger<short>(desc, s, dst);
+    if (desc == &UMLRTType_ushort)    return storeInteger<unsigned short>(desc, s, dst);
+    if (desc == &UMLRTType_uchar)     return storeInteger<unsigned char>(desc, s, dst);
+    if (desc == &UMLRTType_long)      return storeInteger<long>(desc, s, dst);
+    if (desc == &UMLRTType_ulong)     return storeInteger<unsigned long>(desc, s, dst);
+    if (desc == &UMLRTType_longlong)  return storeInteger<long long>(desc, s, dst);
+    if (desc == &UMLRTType_ulonglong) return storeInteger<unsigned long long>(desc, s, dst);
+    if (desc == &UMLRTType_double)    return storeReal<double>(desc, s, dst);
+    if (desc == &UMLRTType_float)     return storeReal<float>(desc, s, dst);
+    if (desc == &UMLRTType_longdouble) return storeReal<long double>(desc, s, dst);
+
+    return false; // No JSON form for this type.
+}
+
+static bool keyIs ( const char * str, SizeType length, const char * name )
+{
+    return (length == strlen(name)) && (memcmp(str, name, length) == 0);
+}
+
+void UMLRTJsonReader::begin ( const UMLRTObject_class * desc, void * dst, int arraySize )
+{
+    depth = 0;
+    done = false;
+    push(desc, dst, arraySize);
+}
+
+bool UMLRTJsonReader::push ( const UMLRTObject_class * desc, void * dst, int arraySize )
+{
+    if (depth == MAX_NEST)
+    {
+        return false;
+    }
+    Frame & f = stack[depth++];
+    f.desc = desc;
+    f.dst = (uint8_t *)dst;
+    f.arraySize = arraySize;
+    f.state = Frame::OBJECT;
+    f.element = 0;
+    f.field = 0;
+    f.gotValue = false;
+    return true;
+}
+
+bool UMLRTJsonReader::scalar ( const Scalar & s )
+{
+    if (done)
+    {
+        return false;
+    }
+    Frame & f = stack[depth - 1];
+
+    if (f.state == Frame::SKIP)
+    {
+        f.state = Frame::MEMBER;
+        return s.kind == Scalar::STRING;
+    }
+    if ((f.state != Frame::PRIMITIVES) || (f.element >= f.arraySize))
+    {
+        return false;
+    }
+    if (!store(f.desc, s, f.dst + f.element * f.desc->object.sizeOf))
+    {
+        return false;
+    }
+    ++f.element;
+    return true;
+}
+
+bool UMLRTJsonReader::Null ( )
+{
+    Scalar s;
+    s.kind = Scalar::NUL;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::Bool ( bool b )
+{
+    Scalar s;
+    s.kind = Scalar::BOOL;
+    s.b = b;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::Int ( int i )
+{
+    return Int64(i);
+}
+
+bool UMLRTJsonReader::Uint ( unsigned u )
+{
+    return Uint64(u);
+}
+
+bool UMLRTJsonReader::Int64 ( int64_t i )
+{
+    if (i >= 0)
+    {
+        return Uint64((uint64_t)i);
+    }
+    Scalar s;
+    s.kind = Scalar::INT;
+    s.i = i;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::Uint64 ( uint64_t u )
+{
+    Scalar s;
+    s.kind = Scalar::UINT;
+    s.u = u;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::Double ( double d )
+{
+    Scalar s;
+    s.kind = Scalar::REAL;
+    s.d = d;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::String ( const char * str, SizeType length, bool copy )
+{
+    Scalar s;
+    s.kind = Scalar::STRING;
+    s.str = str;
+    s.length = length;
+    return scalar(s);
+}
+
+bool UMLRTJsonReader::StartObject ( )
+{
+    if (done)
+    {
+        return false;
+    }
+    Frame & f = stack[depth - 1];
+
+    if (f.state == Frame::OBJECT)
+    {
+        f.state = Frame::MEMBER;
+        return true;
+    }
+    if ((f.state != Frame::FIELDS) || (f.field >= f.desc->object.numFields))
+    {
+        return false;
+    }
+    const UMLRTObject_field * fld = &f.desc->object.fields[f.field];
+    if (!push(fld->desc, f.dst + f.element * f.desc->object.sizeOf + fld->offset, fld->arraySize))
+    {
+        return false;
+    }
+    stack[depth - 1].state = Frame::MEMBER;
+    return true;
+}
+
+bool UMLRTJsonReader::Key ( const char * str, SizeType length, bool copy )
+{
+    if (done || (stack[depth - 1].state != Frame::MEMBER))
+    {
+        return false;
+    }
+    Frame & f = stack[depth - 1];
+
+    if (keyIs(str, length, "value"))
+    {
+        if (f.gotValue)
+        {
+            return false;
+        }
+        f.gotValue = true;
+        f.state = Frame::VALUE;
+        return true;
+    }
+    if (keyIs(str, length, "type") || keyIs(str, length, "name"))
+    {
+        f.state = Frame::SKIP;
+        return true;
+    }
+    return false;
+}
+
+bool UMLRTJsonReader::EndObject ( SizeType memberCount )
+{
+    if (done || (stack[depth - 1].state != Frame::MEMBER) || !stack[depth - 1].gotValue)
+    {
+        return false;
+    }
+    if (--depth == 0)
+    {
+        done = true;
+    }
+    else
+    {
+        ++stack[depth - 1].field;
+    }
+    return true;
+}
+
+bool UMLRTJsonReader::StartArray ( )
+{
+    if (done)
+    {
+        return false;
+    }
+    Frame & f = stack[depth - 1];
+
+    if (f.state == Frame::VALUE)
+    {
+        f.state = (f.desc->object.numFields == 0) ? Frame::PRIMITIVES : Frame::ELEMENTS;
+        return true;
+    }
+    if ((f.state == Frame::ELEMENTS) && (f.element < f.arraySize))
+    {
+        f.state = Frame::FIELDS;
+        f.field = 0;
+        return true;
+    }
+    return false;
+}
+
+bool UMLRTJsonReader::EndArray ( SizeType elementCount )
+{
+    if (done)
+    {
+        return false;
+    }
+    Frame & f = stack[depth - 1];
+
+    switch (f.state)
+    {
+    case Frame::PRIMITIVES:
+    case Frame::ELEMENTS:
+        f.state = Frame::MEMBER;
+        return f.element == f.arraySize;
+    case Frame::FIELDS:
+        ++f.element;
+        f.state = Frame::ELEMENTS;
+        return f.field == f.desc->object.numFields;
+    default:
+        return false;
+    }
+}
@@ -8,14 +8,22 @@
 * http://www.eclipse.org/legal/epl-v10.html
 *******************************************************************************/
 
+#include <string.h>
+#include "osatomic.hh"
 #include "umlrtobjectclass.hh"
 #include "umlrtlogprotocol.hh"
+#include "umlrtlogwriter.hh"
+#include "umlrtmappedfile.hh"
 #include "umlrtmutex.hh"
+#include "umlrtuserconfig.hh"
 
 // Avoid concurrent output stdout and stderr. The application is responsible for mutual exclusion all other streams.
 /*static*/ UMLRTMutex UMLRTLogProtocol_baserole::stdoutMutex;
 /*static*/ UMLRTMutex UMLRTLogProtocol_baserole::stderrMutex;
 
+// Scratch stream used to format typed values (via their descriptor's fprintf) when output is asynchronous.
+static OS_THREAD_LOCAL FILE * scratchStream = NULL;
+
 // Gain exclusive access to stdout or stderr - return NULL if stream is not one of these two.
 UMLRTMutex * UMLRTLogProtocol_baserole::takeMutex() const
 {
@@ -44,178 +52,181 @@ void UMLRTLogProtocol_baserole::giveMutex ( UMLRTMutex * mutex ) const
     }
 }
 
-// Output data with the new-line appended.
-int UMLRTLogProtocol_baserole::log ( const char * fmt, ... ) const
+// Output formatted data - queued to the log writer if it is running.
+int UMLRTLogProtocol_baserole::output ( const char * data, size_t length ) const
 {
-    int nchar = 0;
+    int nchar = -1;
 
-    if (ostream != NULL)
+    if (UMLRTLogWriter::isRunning() && ((ostream != NULL) || (mappedFile != NULL)))
     {
-        va_list ap;
-        va_start(ap, fmt);
-        UMLRTMutex * mutex = takeMutex();
-        nchar = vfprintf(ostream, fmt, ap);
-        nchar += fprintf(ostream, "\n");
-        giveMutex(mutex);
-        va_end(ap);
+        // -1 if the log writer was shut down meanwhile.
+        nchar = UMLRTLogWriter::submit(ostream, mappedFile, data, length);
+    }
+    if (nchar < 0)
+    {
+        nchar = 0;
+
+        if (mappedFile != NULL)
+        {
+            // Only after the log writer has been shut down.
+            nchar = (int)mappedFile->write(data, length);
+        }
+        else if (ostream != NULL)
+        {
+            UMLRTMutex * mutex = takeMutex();
+            nchar = (int)fwrite(data, 1, length, ostream);
+            giveMutex(mutex);
+        }
     }
     return nchar;
 }
 
-int UMLRTLogProtocol_baserole::log ( char c ) const
+int UMLRTLogProtocol_baserole::write ( const char * fmt, ... ) const
 {
-    int nchar = 0;
+    va_list ap;
+    va_start(ap, fmt);
+    int nchar = vwrite(fmt, ap, false);
+    va_end(ap);
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%c\n", c);
-        giveMutex(mutex);
-    }
     return nchar;
 }
 
-int UMLRTLogProtocol_baserole::log ( short s ) const
+int UMLRTLogProtocol_baserole::vwrite ( const char * fmt, va_list ap, bool newline ) const
 {
     int nchar = 0;
 
-    if (ostream != NULL)
+    if (UMLRTLogWriter::isRunning() || (mappedFile != NULL))
+    {
+        // Format into a single record. Most records fit on the stack.
+        char record[USER_CONFIG_LOG_RECORD_SIZE];
+        char * data = record;
+        va_list aq;
+        va_copy(aq, ap);
+        int length = vsnprintf(record, sizeof(record), fmt, ap);
+        if ((length + 1) >= (int)sizeof(record))
+        {
+            data = new char[length + 2];
+            vsnprintf(data, length + 1, fmt, aq);
+        }
+        va_end(aq);
+        if (length >= 0)
+        {
+            if (newline)
+            {
+                data[length++] = '\n';
+            }
+            nchar = output(data, length);
+        }
+        if (data != record)
+        {
+            delete[] data;
+        }
+    }
+    else if (ostream != NULL)
     {
         UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%d\n", s);
+        nchar = vfprintf(ostream, fmt, ap);
+        if (newline)
+        {
+            nchar += fprintf(ostream, "\n");
+        }
         giveMutex(mutex);
     }
     return nchar;
 }
 
-int UMLRTLogProtocol_baserole::log ( int i ) const
+int UMLRTLogProtocol_baserole::repeat ( const char * prefix, char c, int count ) const
 {
-    int nchar = 0;
+    char record[USER_CONFIG_LOG_RECORD_SIZE];
+    char * data = record;
+    size_t prefixlen = strlen(prefix);
+    size_t length = prefixlen + ((count > 0) ? count : 0);
 
-    if (ostream != NULL)
+    if (length > sizeof(record))
     {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%d\n", i);
-        giveMutex(mutex);
+        data = new char[length];
     }
-    return nchar;
-}
+    memcpy(data, prefix, prefixlen);
+    memset(data + prefixlen, c, length - prefixlen);
 
-int UMLRTLogProtocol_baserole::log ( long l ) const
-{
-    int nchar = 0;
+    int nchar = output(data, length);
 
-    if (ostream != NULL)
+    if (data != record)
     {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%ld\n", l);
-        giveMutex(mutex);
+        delete[] data;
     }
     return nchar;
 }
 
-int UMLRTLogProtocol_baserole::log ( long long ll ) const
+// Output data with the new-line appended.
+int UMLRTLogProtocol_baserole::log ( const char * fmt, ... ) const
 {
-    int nchar = 0;
+    va_list ap;
+    va_start(ap, fmt);
+    int nchar = vwrite(fmt, ap, true);
+    va_end(ap);
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%lld\n", ll);
-        giveMutex(mutex);
-    }
     return nchar;
 }
 
-int UMLRTLogProtocol_baserole::log ( unsigned char uc ) const
+int UMLRTLogProtocol_baserole::log ( char c ) const
 {
-    int nchar = 0;
+    return write("%c\n", c);
+}
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%c\n", uc);
-        giveMutex(mutex);
-    }
-    return nchar;
+int UMLRTLogProtocol_baserole::log ( short s ) const
+{
+    return write("%d\n", s);
 }
 
-int UMLRTLogProtocol_baserole::log ( unsigned short us ) const
+int UMLRTLogProtocol_baserole::log ( int i ) const
 {
-    int nchar = 0;
+    return write("%d\n", i);
+}
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%u\n", us);
-        giveMutex(mutex);
-    }
-    return nchar;
+int UMLRTLogProtocol_baserole::log ( long l ) const
+{
+    return write("%ld\n", l);
 }
 
-int UMLRTLogProtocol_baserole::log ( unsigned int ui ) const
+int UMLRTLogProtocol_baserole::log ( long long ll ) const
 {
-    int nchar = 0;
+    return write("%lld\n", ll);
+}
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%u\n", ui);
-        giveMutex(mutex);
-    }
-    return nchar;
+int UMLRTLogProtocol_baserole::log ( unsigned char uc ) const
+{
+    return write("%c\n", uc);
 }
 
-int UMLRTLogProtocol_baserole::log ( unsigned long ul ) const
+int UMLRTLogProtocol_baserole::log ( unsigned short us ) const
 {
-    int nchar = 0;
+    return write("%u\n", us);
+}
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%lu\n", ul);
-        giveMutex(mutex);
-    }
-    return nchar;
+int UMLRTLogProtocol_baserole::log ( unsigned int ui ) const
+{
+    return write("%u\n", ui);
 }
 
-int UMLRTLogProtocol_baserole::log ( unsigned long long ull ) const
+int UMLRTLogProtocol_baserole::log ( unsigned long ul ) const
 {
-    int nchar = 0;
+    return write("%lu\n", ul);
+}
 
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%llu\n", ull);
-        giveMutex(mutex);
-    }
-    return nchar;
+int UMLRTLogProtocol_baserole::log ( unsigned long long ull ) const
+{
+    return write("%llu\n", ull);
 }
 
 int UMLRTLogProtocol_baserole::log ( float f ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%f\n", f);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%f\n", f);
 }
 
 int UMLRTLogProtocol_baserole::log ( double d ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%f\n", d);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%f\n", d);
 }
 
 int UMLRTLogProtocol_baserole::log ( const void * userData, const UMLRTObject_class * type, int arraySize ) const
@@ -236,181 +247,102 @@ int UMLRTLogProtocol_baserole::log ( const UMLRTTypedValue & value ) const
 // Output data with no new-line appended.
 int UMLRTLogProtocol_baserole::show ( const char * fmt, ... ) const
 {
-    int nchar = 0;
+    va_list ap;
+    va_start(ap, fmt);
+    int nchar = vwrite(fmt, ap, false);
+    va_end(ap);
 
-    if (ostream != NULL)
-    {
-        va_list ap;
-        va_start(ap, fmt);
-        UMLRTMutex * mutex = takeMutex();
-        nchar = vfprintf(ostream, fmt, ap);
-        giveMutex(mutex);
-        va_end(ap);
-    }
     return nchar;
 }
 
 int UMLRTLogProtocol_baserole::show ( char c ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%c", c);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%c", c);
 }
 
 int UMLRTLogProtocol_baserole::show ( short s ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%d", s);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%d", s);
 }
 
 int UMLRTLogProtocol_baserole::show ( int i ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%d", i);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%d", i);
 }
 
 int UMLRTLogProtocol_baserole::show ( long l ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%ld", l);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%ld", l);
 }
 
 int UMLRTLogProtocol_baserole::show ( long long ll ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%lld", ll);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%lld", ll);
 }
 
 int UMLRTLogProtocol_baserole::show ( unsigned char uc ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%c", uc);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%c", uc);
 }
 
 int UMLRTLogProtocol_baserole::show ( unsigned short us ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%u", us);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%u", us);
 }
 
 int UMLRTLogProtocol_baserole::show ( unsigned int ui ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%u", ui);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%u", ui);
 }
 
 int UMLRTLogProtocol_baserole::show ( unsigned long ul ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%lu", ul);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%lu", ul);
 }
 
 int UMLRTLogProtocol_baserole::show ( unsigned long long ull ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%llu", ull);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%llu", ull);
 }
 
 int UMLRTLogProtocol_baserole::show ( float f ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%f", f);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%f", f);
 }
 
 int UMLRTLogProtocol_baserole::show ( double d ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "%f", d);
-        giveMutex(mutex);
-    }
-    return nchar;
+    return write("%f", d);
 }
 
 int UMLRTLogProtocol_baserole::show ( const void * userData, const UMLRTObject_class * type, int arraySize ) const
 {
     int nchar = 0;
 
-    if (ostream != NULL)
+    if (UMLRTLogWriter::isRunning() || (mappedFile != NULL))
+    {
+        // The type descriptors only know how to output to a stream - format via a per-thread
+        // scratch file and queue the result as a single record.
+        if (scratchStream == NULL)
+        {
+            scratchStream = tmpfile();
+        }
+        if (scratchStream != NULL)
+        {
+            rewind(scratchStream);
+            UMLRTObject_fprintf(scratchStream, type, userData, 0/*nest*/, arraySize);
+            long length = ftell(scratchStream);
+            if (length > 0)
+            {
+                char * data = new char[length];
+                rewind(scratchStream);
+                length = fread(data, 1, length, scratchStream);
+                nchar = output(data, length);
+                delete[] data;
+            }
+        }
+    }
+    else if (ostream != NULL)
     {
         UMLRTMutex * mutex = takeMutex();
         nchar = UMLRTObject_fprintf(ostream, type, userData, 0/*nest*/, arraySize);
@@ -426,90 +358,62 @@ int UMLRTLogProtocol_baserole::show ( const UMLRTTypedValue & value ) const
 
 int UMLRTLogProtocol_baserole::cr ( int numCr ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        while (numCr > 0)
-        {
-            nchar += fprintf(ostream, "\n");
-            --numCr;
-        }
-        giveMutex(mutex);
-    }
-    return nchar;
+    return repeat("", '\n', numCr);
 }
 
 int UMLRTLogProtocol_baserole::crtab ( int numTab ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        nchar = fprintf(ostream, "\n");
-        while (numTab > 0)
-        {
-            nchar += fprintf(ostream, "\t");
-            --numTab;
-        }
-        giveMutex(mutex);
-    }
-    return nchar;
+    return repeat("\n", '\t', numTab);
 }
 
 int UMLRTLogProtocol_baserole::space ( int numSpace ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        while (numSpace > 0)
-        {
-            nchar = fprintf(ostream, " ");
-            --numSpace;
-        }
-        giveMutex(mutex);
-    }
-    return nchar;
+    return repeat("", ' ', numSpace);
 }
 
 int UMLRTLogProtocol_baserole::tab ( int numTab ) const
 {
-    int nchar = 0;
-
-    if (ostream != NULL)
-    {
-        UMLRTMutex * mutex = takeMutex();
-        while (numTab > 0)
-        {
-            nchar += fprintf(ostream, "\t");
-            --numTab;
-        }
-        giveMutex(mutex);
-    }
-    return nchar;
+    return repeat("", '\t', numTab);
 }
 
 int UMLRTLogProtocol_baserole::commit ( ) const
 {
-    if (ostream != NULL)
+    // Wait for queued output to be written before flushing the stream.
+    UMLRTLogWriter::flush();
+
+    if (mappedFile != NULL)
+    {
+        mappedFile->sync();
+    }
+    else if (ostream != NULL)
     {
         fflush(ostream);
     }
     return 0;
 }
 
-// Redirect logging output - closes previous output stream if it was opened via redirect(fname). Returns false if error.
-bool UMLRTLogProtocol_baserole::redirect ( FILE * ostream_ ) const
+void UMLRTLogProtocol_baserole::closeFile ( ) const
 {
+    // Queued output may still refer to the file.
+    UMLRTLogWriter::flush();
+
     if (isOpenFile)
     {
         fclose(ostream);
         isOpenFile = false;
     }
+    if (mappedFile != NULL)
+    {
+        UMLRTLogWriter::removeMappedFile(mappedFile);
+        delete mappedFile;
+        mappedFile = NULL;
+    }
+}
+
+// Redirect logging output - closes previous output stream if it was opened via redirect(fname). Returns false if error.
+bool UMLRTLogProtocol_baserole::redirect ( FILE * ostream_ ) const
+{
+    closeFile();
     ostream = ostream_;
     return true;
 }
@@ -518,14 +422,27 @@ bool UMLRTLogProtocol_baserole::redirect ( FILE * ostream_ ) const
 bool UMLRTLogProtocol_baserole::redirect ( const char * fname ) const
 {
     bool ok = false;
-    if (isOpenFile)
-    {
-        fclose(ostream);
-        isOpenFile = false;
-    }
+    closeFile();
     if (fname)
     {
-        if ((ostream = fopen(fname, "w")) == NULL)
+        if (UMLRTLogWriter::useMappedFiles())
+        {
+            mappedFile = new UMLRTMappedFile();
+            if (mappedFile->open(fname, USER_CONFIG_LOG_MAPPED_FILE_SIZE))
+            {
+                UMLRTLogWriter::addMappedFile(mappedFile);
+                ostream = NULL;
+                ok = true;
+            }
+            else
+            {
+                // Redirect to stderr in case file open fails.
+                delete mappedFile;
+                mappedFile = NULL;
+                ostream = stderr;
+            }
+        }
+        else if ((ostream = fopen(fname, "w")) == NULL)
         {
             // Redirect to stderr in case file open fails.
             ostream = stderr;
@@ -538,4 +455,3 @@ bool UMLRTLogProtocol_baserole::redirect ( const char * fname ) const
     }
     return ok;
 }
-
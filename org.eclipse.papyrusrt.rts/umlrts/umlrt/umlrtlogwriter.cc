@@ -0,0 +1,380 @@
+// umlrtlogwriter.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "basedebug.hh"
+#include "umlrtguard.hh"
+#include "osatomic.hh"
+#include "umlrtlogwriter.hh"
+#include "umlrtmappedfile.hh"
+#include "umlrtuserconfig.hh"
+
+// See umlrtlogwriter.hh for documentation.
+
+/*static*/ UMLRTLogWriter * UMLRTLogWriter::instance = NULL;
+/*static*/ UMLRTLogWriter::Buffer * volatile UMLRTLogWriter::buffers = NULL;
+/*static*/ UMLRTLogWriter::MappedFileEntry * UMLRTLogWriter::mappedFileList = NULL;
+/*static*/ UMLRTMutex UMLRTLogWriter::mappedFileListMutex;
+/*static*/ UMLRTLogWriter::Policy UMLRTLogWriter::policy = UMLRTLogWriter::POLICY_DROP;
+/*static*/ size_t UMLRTLogWriter::bufferSize = USER_CONFIG_LOG_BUFFER_SIZE;
+/*static*/ bool UMLRTLogWriter::mappedFiles = false;
+/*static*/ volatile bool UMLRTLogWriter::running = false;
+/*static*/ volatile bool UMLRTLogWriter::stopping = false;
+/*static*/ volatile int UMLRTLogWriter::submitters = 0;
+/*static*/ volatile size_t UMLRTLogWriter::dropCount = 0;
+/*static*/ UMLRTSemaphore UMLRTLogWriter::wakeup(0);
+/*static*/ UMLRTSemaphore UMLRTLogWriter::drained(0);
+/*static*/ volatile int UMLRTLogWriter::drainWaiters = 0;
+
+// The calling thread's buffer (a UMLRTLogWriter::Buffer).
+static OS_THREAD_LOCAL void * threadBuffer = NULL;
+
+UMLRTLogWriter::UMLRTLogWriter ( ) : UMLRTBasicThread("logwriter")
+{
+}
+
+UMLRTLogWriter::~UMLRTLogWriter ( )
+{
+}
+
+/*static*/ void UMLRTLogWriter::spawn ( Policy policy_, size_t bufferSize_, bool useMappedFiles_ )
+{
+    if (instance != NULL)
+    {
+        return;
+    }
+    // Must hold at least one record header and be a power of 2 for masking.
+    size_t size = 1024;
+    while (size < bufferSize_)
+    {
+        size <<= 1;
+    }
+    policy = policy_;
+    bufferSize = size;
+    mappedFiles = useMappedFiles_;
+
+    BDEBUG(BD_MAIN, "spawn log writer policy(%s) bufferSize(%lu) mappedFiles(%d)\n",
+            (policy == POLICY_DROP) ? "drop" : "block", (unsigned long)bufferSize, mappedFiles);
+
+    instance = new UMLRTLogWriter();
+    OSAtomic::store(&running, true);
+    instance->start(NULL);
+
+    atexit(atExit);
+}
+
+/*static*/ void UMLRTLogWriter::shutdown ( )
+{
+    if (instance == NULL)
+    {
+        return;
+    }
+    // Stop new records, then wait for producers already in 'submit' - the writer keeps draining
+    // meanwhile, so a blocked producer gets room (or sees the writer is no longer running).
+    OSAtomic::fetchAdd(&submitters, (int)SUBMIT_CLOSED);
+    OSAtomic::store(&running, false);
+
+    UMLRTSemaphore pause(0);
+    while (OSAtomic::load(&submitters) != SUBMIT_CLOSED)
+    {
+        wakeup.post();
+        pause.wait(1);
+    }
+    OSAtomic::store(&stopping, true);
+    wakeup.post();
+    instance->join();
+
+    // The writer has exited and no producer can queue more, so this thread is now the only consumer.
+    drainAll();
+
+    // Any later output to these files is discarded.
+    mappedFileListMutex.take();
+    for (MappedFileEntry * entry = mappedFileList; entry != NULL; entry = entry->next)
+    {
+        entry->mapped->close();
+    }
+    mappedFileListMutex.give();
+
+    delete instance;
+    instance = NULL;
+    OSAtomic::store(&stopping, false);
+    OSAtomic::store(&submitters, 0);
+
+    if (OSAtomic::load(&dropCount) > 0)
+    {
+        BDEBUG(BD_MAIN, "log writer dropped %lu records\n", (unsigned long)OSAtomic::load(&dropCount));
+    }
+}
+
+/*static*/ void UMLRTLogWriter::atExit ( )
+{
+    shutdown();
+}
+
+/*static*/ bool UMLRTLogWriter::isRunning ( )
+{
+    return OSAtomic::load(&running);
+}
+
+/*static*/ bool UMLRTLogWriter::useMappedFiles ( )
+{
+    return isRunning() && mappedFiles;
+}
+
+/*static*/ void UMLRTLogWriter::addMappedFile ( UMLRTMappedFile * mapped )
+{
+    UMLRTGuard g(mappedFileListMutex);
+
+    MappedFileEntry * entry = new MappedFileEntry;
+    entry->mapped = mapped;
+    entry->next = mappedFileList;
+    mappedFileList = entry;
+}
+
+/*static*/ void UMLRTLogWriter::removeMappedFile ( UMLRTMappedFile * mapped )
+{
+    UMLRTGuard g(mappedFileListMutex);
+
+    for (MappedFileEntry * * link = &mappedFileList; *link != NULL; link = &(*link)->next)
+    {
+        if ((*link)->mapped == mapped)
+        {
+            MappedFileEntry * entry = *link;
+            *link = entry->next;
+            delete entry;
+            break;
+        }
+    }
+}
+
+/*static*/ size_t UMLRTLogWriter::getDropCount ( )
+{
+    return OSAtomic::load(&dropCount);
+}
+
+/*static*/ UMLRTLogWriter::Buffer * UMLRTLogWriter::getThreadBuffer ( )
+{
+    Buffer * buffer = (Buffer *)threadBuffer;
+
+    if (buffer == NULL)
+    {
+        buffer = new Buffer;
+        buffer->data = new char[bufferSize];
+        buffer->mask = bufferSize - 1;
+        buffer->head = 0;
+        buffer->tail = 0;
+        do
+        {
+            buffer->next = OSAtomic::load(&buffers);
+        } while (!OSAtomic::compareAndSwap(&buffers, buffer->next, buffer));
+
+        threadBuffer = buffer;
+    }
+    return buffer;
+}
+
+/*static*/ void UMLRTLogWriter::copyIn ( Buffer * buffer, size_t pos, const void * src, size_t length )
+{
+    size_t index = pos & buffer->mask;
+    size_t first = buffer->mask + 1 - index;
+
+    if (first >= length)
+    {
+        memcpy(buffer->data + index, src, length);
+    }
+    else
+    {
+        memcpy(buffer->data + index, src, first);
+        memcpy(buffer->data, (const char *)src + first, length - first);
+    }
+}
+
+/*static*/ void UMLRTLogWriter::copyOut ( const Buffer * buffer, size_t pos, void * dest, size_t length )
+{
+    size_t index = pos & buffer->mask;
+    size_t first = buffer->mask + 1 - index;
+
+    if (first >= length)
+    {
+        memcpy(dest, buffer->data + index, length);
+    }
+    else
+    {
+        memcpy(dest, buffer->data + index, first);
+        memcpy((char *)dest + first, buffer->data, length - first);
+    }
+}
+
+/*static*/ int UMLRTLogWriter::submit ( FILE * ostream, UMLRTMappedFile * mapped, const char * data, size_t length )
+{
+    if ((OSAtomic::fetchAdd(&submitters, 1) & SUBMIT_CLOSED) != 0)
+    {
+        // Shut down since the caller checked #isRunning.
+        OSAtomic::fetchAdd(&submitters, -1);
+        return -1;
+    }
+    int nchar = queue(ostream, mapped, data, length);
+
+    OSAtomic::fetchAdd(&submitters, -1);
+
+    return nchar;
+}
+
+/*static*/ int UMLRTLogWriter::queue ( FILE * ostream, UMLRTMappedFile * mapped, const char * data, size_t length )
+{
+    Buffer * buffer = getThreadBuffer();
+    size_t capacity = buffer->mask + 1;
+
+    if ((sizeof(RecordHeader) + length) > capacity)
+    {
+        // Truncate records that could never fit.
+        length = capacity - sizeof(RecordHeader);
+    }
+    size_t need = sizeof(RecordHeader) + length;
+    size_t tail = buffer->tail; // Only this thread writes 'tail'.
+
+    for (;;)
+    {
+        size_t used = tail - OSAtomic::load(&buffer->head);
+
+        if ((capacity - used) >= need)
+        {
+            RecordHeader header;
+            header.ostream = ostream;
+            header.mapped = mapped;
+            header.length = length;
+
+            copyIn(buffer, tail, &header, sizeof(header));
+            copyIn(buffer, tail + sizeof(header), data, length);
+            OSAtomic::store(&buffer->tail, tail + need);
+
+            // Wake the writer early once the buffer is half full.
+            if ((used < (capacity / 2)) && ((used + need) >= (capacity / 2)))
+            {
+                wakeup.post();
+            }
+            return (int)length;
+        }
+        if ((policy == POLICY_DROP) || !isRunning())
+        {
+            OSAtomic::fetchAdd(&dropCount, (size_t)1);
+            return 0;
+        }
+        wakeup.post();
+        waitForDrain();
+    }
+}
+
+/*static*/ void UMLRTLogWriter::waitForDrain ( )
+{
+    OSAtomic::fetchAdd(&drainWaiters, 1);
+    drained.wait(USER_CONFIG_LOG_FLUSH_MSEC);
+    OSAtomic::fetchAdd(&drainWaiters, -1);
+}
+
+/*static*/ void UMLRTLogWriter::flush ( )
+{
+    if (!isRunning() || instance->isMyThread())
+    {
+        return;
+    }
+    for (Buffer * buffer = OSAtomic::load(&buffers); buffer != NULL; buffer = buffer->next)
+    {
+        size_t target = OSAtomic::load(&buffer->tail);
+
+        while (isRunning() && ((ptrdiff_t)(target - OSAtomic::load(&buffer->head)) > 0))
+        {
+            wakeup.post();
+            waitForDrain();
+        }
+    }
+}
+
+/*static*/ int UMLRTLogWriter::drain ( Buffer * buffer )
+{
+    int count = 0;
+    size_t head = buffer->head; // Only the writer writes 'head'.
+    size_t tail = OSAtomic::load(&buffer->tail);
+    FILE * last = NULL;
+
+    while (head != tail)
+    {
+        RecordHeader header;
+        copyOut(buffer, head, &header, sizeof(header));
+
+        size_t pos = head + sizeof(header);
+        size_t index = pos & buffer->mask;
+        size_t first = buffer->mask + 1 - index;
+        if (first > header.length)
+        {
+            first = header.length;
+        }
+        if (header.mapped != NULL)
+        {
+            header.mapped->write(buffer->data + index, first);
+            header.mapped->write(buffer->data, header.length - first);
+        }
+        else if (header.ostream != NULL)
+        {
+            if ((last != NULL) && (last != header.ostream))
+            {
+                fflush(last);
+            }
+            last = header.ostream;
+            fwrite(buffer->data + index, 1, first, header.ostream);
+            fwrite(buffer->data, 1, header.length - first, header.ostream);
+        }
+        head = pos + header.length;
+        ++count;
+    }
+    if (last != NULL)
+    {
+        fflush(last);
+    }
+    // Space is released only after the data has been handed to the stream so that #flush
+    // guarantees the output has left the process.
+    OSAtomic::store(&buffer->head, head);
+
+    return count;
+}
+
+/*static*/ int UMLRTLogWriter::drainAll ( )
+{
+    int count = 0;
+
+    for (Buffer * buffer = OSAtomic::load(&buffers); buffer != NULL; buffer = buffer->next)
+    {
+        count += drain(buffer);
+    }
+    return count;
+}
+
+void * UMLRTLogWriter::run ( void * args )
+{
+    BDEBUG(BD_MAIN, "log writer running\n");
+
+    while (!OSAtomic::load(&stopping))
+    {
+        wakeup.wait(USER_CONFIG_LOG_FLUSH_MSEC);
+        drainAll();
+
+        for (int waiters = OSAtomic::load(&drainWaiters); waiters > 0; --waiters)
+        {
+            drained.post();
+        }
+    }
+    drainAll();
+
+    BDEBUG(BD_MAIN, "log writer exiting\n");
+
+    return NULL;
+}
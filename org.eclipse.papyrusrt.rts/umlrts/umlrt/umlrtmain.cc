@@ -11,12 +11,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "osutil.hh"
 #include "umlrtmain.hh"
 #include "basefatal.hh"
 #include "basedebug.hh"
 #include "umlrtgetopt.hh"
+#include "umlrtcommunicator.hh"
 #include "umlrtdeploymentmap.hh"
 #include "umlrtcontroller.hh"
+#include "umlrtcontrollerbalancer.hh"
+#include "umlrtcontrollerpool.hh"
+#include "umlrtlogwriter.hh"
+#include "umlrtmessagepool.hh"
+#include "umlrtsignalelementpool.hh"
+#include "umlrttimerpool.hh"
+#include "umlrtuserconfig.hh"
 
 // See umlrtmain.hh for documentation.
 
@@ -36,6 +45,21 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
         { "logmsg",         'l', "",            "Enable capsule logMsg output of injected signals." },
         { "controllers",    'c', "<controllers-file>", "Specify a capsule-to-controller map file." },
         { "address",        'i', "<address>",   "Specify the local address" },
+        { "compress",       'z', "<bytes>",     "Compress remote signal payloads of at least <bytes> on links where the other host also compresses." },
+        { "linkcredit",     'q', "<high>[,<low>]", "Stop queuing signals for a remote host once <high> frames wait, until <low> remain. (0 disables.)" },
+        { "workers",        'w', "<workers>",   "Run the controllers on a pool of worker threads. (Default: a thread per controller.)" },
+        { "balance",        'B', "<msec>",      "Move capsules from busy controllers to idle ones, sampling the load every <msec>." },
+        { "timerslack",     'k', "<usec>",      "Batch timeouts due within <usec> of each other into one wakeup. They may be delivered up to <usec> late." },
+        { "capsulerun",     'R', "<count>",     "Inject up to <count> consecutive messages to one capsule as a run. (1 disables runs.)" },
+        { "Pool options", 0, "", "" },
+        { "messagepool",    'P', "<initial>[,<max>[,<incr>]]", "Reserve <initial> messages at startup, growing by <incr> up to <max>. (<max> 0 is unbounded.)" },
+        { "signalpool",     'G', "<initial>[,<max>[,<incr>]]", "Reserve <initial> signal elements at startup, growing by <incr> up to <max>." },
+        { "timerpool",      'O', "<initial>[,<max>[,<incr>]]", "Reserve <initial> timers at startup, growing by <incr> up to <max>." },
+        { "poolmemory",     'H', "pages/thp/huge", "Back the pools with default pages, transparent huge pages or reserved huge pages." },
+        { "Log port options", 0, "", "" },
+        { "logasync",       'a', "drop/block",  "Write log port output from a separate thread. Full buffers drop or block." },
+        { "logbuffer",      'b', "<bytes>",     "Per-thread asynchronous log buffer size." },
+        { "logmmap",        'p', "",            "Memory-map files that log ports are redirected to. (Implies asynchronous output.)" },
         { "Debug feature enable options", 0, "", "" },
         { "debug",          'D', "0/1",         "Overall debug log enable." },
         { "debugcolor",     'C', "0/1",         "Disable/enable terminal text color escape sequences." },
@@ -54,6 +78,62 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
         { NULL, 0, NULL, NULL } // MUST BE LAST to terminate loop
 };
 
+// The free pools configurable from the command-line.
+typedef enum { POOL_MESSAGE, POOL_SIGNAL, POOL_TIMER, POOL_MAXPLUS1 } PoolKind;
+
+static const char * poolOptionNames[POOL_MAXPLUS1] = { "messagepool", "signalpool", "timerpool" };
+
+typedef struct
+{
+    const char * spec; // <initial>[,<max>[,<incr>]]
+    bool set;
+} PoolOption;
+
+// Apply a pool option. Sizes missing from 'spec' (or all of them, if 'spec' is NULL) and
+// the backing, if 'backing' is NULL, are left as they are. Returns false if error.
+static bool configurePool( PoolKind kind, const char * spec, const UMLRTMemoryRegion::Backing * backing )
+{
+    UMLRTPool * pool = (kind == POOL_MESSAGE) ? (UMLRTPool *)UMLRTController::getMessagePool()
+            : (kind == POOL_SIGNAL) ? (UMLRTPool *)UMLRTController::getSignalElementPool()
+            : (UMLRTPool *)UMLRTController::getTimerPool();
+
+    if (pool == NULL)
+    {
+        printf("ERROR: --%s given, but the pool is not defined yet.\n", poolOptionNames[kind]);
+        return false;
+    }
+    size_t initial = pool->getSize();
+    size_t max = pool->getMaxSize();
+    size_t increment = pool->getIncrement();
+
+    if (spec != NULL)
+    {
+        char * end;
+        initial = strtoul(spec, &end, 0);
+        if (*end == ',')
+        {
+            max = strtoul(end + 1, &end, 0);
+            if (*end == ',')
+            {
+                increment = strtoul(end + 1, &end, 0);
+            }
+        }
+        if ((*end != '\0') || (increment == 0) || ((max != 0) && (max < initial)))
+        {
+            printf("ERROR: --%s expects <initial>[,<max>[,<incr>]] with <incr> at least 1 and <max> 0 or at least <initial>.\n", poolOptionNames[kind]);
+            return false;
+        }
+    }
+    if (!pool->configure(initial, max, increment, (backing != NULL) ? *backing : pool->getBacking()))
+    {
+        printf("ERROR: --%s could not reserve %lu elements.\n", poolOptionNames[kind], (unsigned long)initial);
+        return false;
+    }
+    BDEBUG(BD_MAIN, "%s: %lu elements reserved, max %lu, increment %lu, %s\n", poolOptionNames[kind], (unsigned long)pool->getSize(),
+            (unsigned long)pool->getMaxSize(), (unsigned long)pool->getIncrement(), UMLRTMemoryRegion::backingName(pool->getBacking()));
+    return true;
+}
+
 /*static*/ bool UMLRTMain::optionsValid( t_usage_option_help options[], int argc, char * const * argv )
 {
     // Because the following BDEBUG macros are invoked before command-line options are processed, no output will ever
@@ -225,6 +305,16 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
    static struct option options[] = {
             { "help",               no_argument,       NULL, 'h' },
             { "address",            required_argument, NULL, 'i' },
+            { "compress",           required_argument, NULL, 'z' },
+            { "linkcredit",         required_argument, NULL, 'q' },
+            { "workers",            required_argument, NULL, 'w' },
+            { "balance",            required_argument, NULL, 'B' },
+            { "timerslack",         required_argument, NULL, 'k' },
+            { "capsulerun",         required_argument, NULL, 'R' },
+            { "messagepool",        required_argument, NULL, 'P' },
+            { "signalpool",         required_argument, NULL, 'G' },
+            { "timerpool",          required_argument, NULL, 'O' },
+            { "poolmemory",         required_argument, NULL, 'H' },
             { "controllers",        required_argument, NULL, 'c' },
             { "debug",              required_argument, NULL, 'D' },
             { "debugcolor",         required_argument, NULL, 'C' },
@@ -241,6 +331,9 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
             { "debugmodel",         no_argument,       NULL, 'M' },
             { "userargs",           no_argument,       NULL, 'u' },
             { "logmsg",             no_argument,       NULL, 'l' },
+            { "logasync",           required_argument, NULL, 'a' },
+            { "logbuffer",          required_argument, NULL, 'b' },
+            { "logmmap",            no_argument,       NULL, 'p' },
             { NULL,                 0,                 NULL, 0 },
     };
 
@@ -255,10 +348,20 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
     char * hostsfile = NULL;
     char * hostname = NULL;
     char * deploymentfile = NULL;
+    bool logasync = false;
+    bool logmmap = false;
+    UMLRTLogWriter::Policy logpolicy = UMLRTLogWriter::POLICY_DROP;
+    size_t logbuffer = USER_CONFIG_LOG_BUFFER_SIZE;
+    int workers = 0;
+    uint32_t balanceperiod = 0;
+    unsigned long timerslack = USER_CONFIG_TIMER_SLACK_USEC;
+    PoolOption pooloptions[POOL_MAXPLUS1] = { { NULL, false }, { NULL, false }, { NULL, false } };
+    UMLRTMemoryRegion::Backing poolbacking = USER_CONFIG_POOL_BACKING;
+    bool poolbackingset = false;
     int longindex = 0;
     bool optionsvalid = optionsValid(optionhelp, argc_, argv_);
 
-    while (optionsvalid && ((optchar = getopt_long( argc_, argv_, ":h:i:c:D:C:T:t:N:S:n:F:L:f:m:Msul", options, &longindex)) != -1) && !userargsfound)
+    while (optionsvalid && ((optchar = getopt_long( argc_, argv_, ":h:i:z:q:w:B:k:R:P:G:O:H:c:D:C:T:t:N:S:n:F:L:f:m:Msula:b:p", options, &longindex)) != -1) && !userargsfound)
     {
         BDEBUG(BD_MAIN, "optchar as %%c(%c) optind(%d) longindex(%d) optarg(%s)\n", optchar, optind, longindex, optarg != NULL ? optarg : "NULL");
         switch(optchar)
@@ -269,6 +372,69 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
         case 'i':
             address = optarg;
             break;
+        case 'z':
+            UMLRTCommunicator::setCompressThreshold(strtoul(optarg, NULL, 0));
+            break;
+        case 'q':
+            {
+                char * end;
+                unsigned long high = strtoul(optarg, &end, 0);
+                unsigned long low = (*end == ',') ? strtoul(end + 1, &end, 0) : high / 4;
+                if ((*end != '\0') || (low > high))
+                {
+                    printf("ERROR: --linkcredit expects <high>[,<low>] with <low> no greater than <high>.\n");
+                    usage(argv_[0]);
+                }
+                UMLRTCommunicator::setWaterMarks(high, low);
+            }
+            break;
+        case 'w':
+            workers = atoi(optarg);
+            if ((workers <= 0) || (workers > USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS))
+            {
+                printf("ERROR: --workers expects a value between 1 and %d.\n", USER_CONFIG_CONTROLLER_POOL_MAX_WORKERS);
+                usage(argv_[0]);
+            }
+            break;
+        case 'B':
+            balanceperiod = strtoul(optarg, NULL, 0);
+            if (balanceperiod == 0)
+            {
+                printf("ERROR: --balance expects a period in milliseconds.\n");
+                usage(argv_[0]);
+            }
+            break;
+        case 'k':
+            timerslack = strtoul(optarg, NULL, 0);
+            break;
+        case 'R':
+            {
+                unsigned long capsulerun = strtoul(optarg, NULL, 0);
+                if (capsulerun == 0)
+                {
+                    printf("ERROR: --capsulerun expects a count of at least 1.\n");
+                    usage(argv_[0]);
+                }
+                UMLRTController::setCapsuleRun(capsulerun);
+            }
+            break;
+        case 'P':
+        case 'G':
+        case 'O':
+            {
+                PoolOption & option = pooloptions[(optchar == 'P') ? POOL_MESSAGE : (optchar == 'G') ? POOL_SIGNAL : POOL_TIMER];
+                option.spec = optarg;
+                option.set = true;
+            }
+            break;
+        case 'H':
+            if (!UMLRTMemoryRegion::parseBacking(optarg, poolbacking))
+            {
+                printf("ERROR: --poolmemory expects 'pages', 'thp' or 'huge'.\n");
+                usage(argv_[0]);
+            }
+            poolbackingset = true;
+            break;
         case 'c':
             deploymentfile = optarg;
             break;
@@ -324,6 +490,24 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
         case 'l':
             base::debugEnableTypeSet(BD_LOGMSG, true /*will enable*/);
             break;
+        case 'a':
+            logasync = true;
+            if (!strcasecmp(optarg, "block"))
+            {
+                logpolicy = UMLRTLogWriter::POLICY_BLOCK;
+            }
+            else if (strcasecmp(optarg, "drop"))
+            {
+                printf("ERROR: --logasync expects 'drop' or 'block'.\n");
+                usage(argv_[0]);
+            }
+            break;
+        case 'b':
+            logbuffer = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            logmmap = true;
+            break;
         default:
             usage(argv_[0]);
         }
@@ -351,6 +535,39 @@ static UMLRTMain::t_usage_option_help optionhelp[] = {
         UMLRTDeploymentMap::debugOutputCaspuleToControllerMap();
         UMLRTDeploymentMap::debugOutputControllerToHostMap();
     }
+    // Pool options override the deployment file.
+    for (int i = 0; i < POOL_MAXPLUS1; ++i)
+    {
+        if ((pooloptions[i].set || poolbackingset) && !configurePool((PoolKind)i, pooloptions[i].spec, poolbackingset ? &poolbacking : NULL))
+        {
+            usage(argv_[0]);
+        }
+    }
+    if (logasync || logmmap)
+    {
+        UMLRTLogWriter::spawn(logpolicy, logbuffer, logmmap);
+    }
+    if (workers > 0)
+    {
+        // Must be started before the controllers are spawned.
+        UMLRTControllerPool::start(workers);
+    }
+    if (timerslack > 0)
+    {
+        UMLRTTimerQueue::setSlack(UMLRTTimespec(timerslack / 1000000, (timerslack % 1000000) * 1000));
+    }
+    if (balanceperiod > 0)
+    {
+        if (workers > 0)
+        {
+            // The worker pool already spreads the controllers over the workers.
+            printf("WARNING: --balance is ignored with --workers.\n");
+        }
+        else
+        {
+            UMLRTControllerBalancer::spawn(balanceperiod);
+        }
+    }
     // If user requested debug options summary...
     if (debugsummary)
     {
@@ -0,0 +1,34 @@
+// umlrtmemoryregion.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtmemoryregion.hh"
+#include <string.h>
+
+// See umlrtmemoryregion.hh for documentation. The OS-dependent part is in os/<os>/osmemoryregion.cc.
+
+static const char * backingNames[UMLRTMemoryRegion::BACKING_MAXPLUS1] = { "pages", "thp", "huge" };
+
+/*static*/ const char * UMLRTMemoryRegion::backingName ( Backing backing )
+{
+    return ((backing >= 0) && (backing < BACKING_MAXPLUS1)) ? backingNames[backing] : "(invalid)";
+}
+
+/*static*/ bool UMLRTMemoryRegion::parseBacking ( const char * name, Backing & backing )
+{
+    for (int i = 0; i < BACKING_MAXPLUS1; ++i)
+    {
+        if (strcmp(name, backingNames[i]) == 0)
+        {
+            backing = (Backing)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -17,6 +17,11 @@
 
 // See umlrtmessagequeue.hh for documentation.
 
+// The layout described in umlrtmessage.hh - whole cache lines, with the delivery fields in the first.
+OS_STATIC_ASSERT((sizeof(UMLRTMessage) % OS_CACHE_LINE_SIZE) == 0, UMLRTMessage_fills_whole_cache_lines);
+OS_STATIC_ASSERT(sizeof(UMLRTMessage) <= (2 * OS_CACHE_LINE_SIZE), UMLRTMessage_fits_two_cache_lines);
+OS_STATIC_ASSERT((OS_MEMBER_OFFSET(UMLRTMessage, signal) + sizeof(UMLRTSignal)) <= OS_CACHE_LINE_SIZE, UMLRTMessage_delivery_fields_share_first_line);
+
 bool UMLRTMessage::defer ( ) const
 {
     bool ok = false;
@@ -9,12 +9,13 @@
  *******************************************************************************/
 
 // See umlrtmessagepool.hh for documentation.
+#include <new>
 #include <stdlib.h>
 #include "basefatal.hh"
 #include "umlrtmessagepool.hh"
 #include "umlrtguard.hh"
 
-UMLRTMessagePool::UMLRTMessagePool(UMLRTMessage messages[], size_t arraySize, size_t incrementSize) : UMLRTPool(incrementSize)
+UMLRTMessagePool::UMLRTMessagePool(UMLRTMessage messages[], size_t arraySize, size_t incrementSize, size_t maxSize_) : UMLRTPool(incrementSize, maxSize_)
 {
     UMLRTGuard g(mutex);
 
@@ -26,24 +27,34 @@ UMLRTMessagePool::UMLRTMessagePool(UMLRTMessage messages[], size_t arraySize, si
             messages[i - 1].qid = qid++;
         }
         head = &messages[0];
+        size = arraySize;
     }
 }
 
-UMLRTMessagePool::UMLRTMessagePool(size_t incrementSize) : UMLRTPool(incrementSize)
+UMLRTMessagePool::UMLRTMessagePool(size_t incrementSize, size_t maxSize_) : UMLRTPool(incrementSize, maxSize_)
 {
 
 }
 
-void UMLRTMessagePool::grow()
+size_t UMLRTMessagePool::elementSize() const
 {
-    UMLRTMessage * newElements = new UMLRTMessage[increment]();
+    return sizeof(UMLRTMessage);
+}
+
+void UMLRTMessagePool::grow(void * region, size_t count)
+{
+    UMLRTMessage * newElements = (UMLRTMessage *)region;
 
-    for (size_t i = increment - 1; i > 0; --i)
+    for (size_t i = 0; i < count; ++i)
+    {
+        new (&newElements[i]) UMLRTMessage();
+    }
+    for (size_t i = count - 1; i > 0; --i)
     {
         newElements[i - 1].next = &newElements[i];
         newElements[i - 1].qid = qid++;
     }
-    newElements[increment - 1].next = head;
+    newElements[count - 1].next = head;
     head = &newElements[0];
 }
 
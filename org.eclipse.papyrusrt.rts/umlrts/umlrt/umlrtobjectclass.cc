@@ -86,8 +86,9 @@ void * UMLRTObject_copy ( const UMLRTObject_class * desc, const void * src, void
 
 void * UMLRTObject_copy_charptr ( const UMLRTObject_class * desc, const void * src, void * dst )
 {
-    *((char * *) dst) = strdup(*((const char * *) src));
-    if (*((char * *) dst) == NULL)
+    const char * str = *((const char * *) src);
+    *((char * *) dst) = (str == NULL) ? NULL : strdup(str);
+    if ((str != NULL) && (*((char * *) dst) == NULL))
     {
         FATAL("Error duplicating string '%s'", (const char * *) src);
     }
@@ -453,331 +454,220 @@ static int UMLRTObject_fprintf_ushort ( FILE *ostream, const UMLRTObject_class *
     return nchar;
 }
 
-// Assumes 'decoded' data (not 'encoded' data).
-Value * UMLRTObject_toJson ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+// Start a typed value: its "type" member and the opening of its "value" array.
+static void UMLRTObject_toJsonBegin ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
+    writer.Key("type");
+    writer.String(desc->name);
+    writer.Key("value");
+    writer.StartArray();
+}
 
+// Assumes 'decoded' data (not 'encoded' data).
+void UMLRTObject_toJson ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+{
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int ai = 0;  ai < arraySize; ++ai)
     {
         uint8_t * ai_base = (uint8_t *)data + (desc->object.sizeOf * ai);
-        Value allFields(kArrayType);
+        writer.StartArray();
         for (size_t fi = 0; fi < desc->object.numFields; ++fi)
         {
             const UMLRTObject_field * fld = &desc->object.fields[fi];
             uint8_t * fi_base = ai_base + fld->offset;
 
-            Value * fieldVal = fld->desc->toJson(document, fld->desc, fi_base, nest+1, fld->arraySize);
-            allFields.PushBack(*fieldVal, document.GetAllocator());
+            writer.StartObject();
+            fld->desc->toJson(writer, fld->desc, fi_base, nest+1, fld->arraySize);
+            writer.EndObject();
         }
-        val.PushBack(allFields, document.GetAllocator());
+        writer.EndArray();
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_bool ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_bool ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     bool b;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(b)), &b);
-        val.PushBack(Value().SetBool(b), document.GetAllocator());
+        writer.Bool(b);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_char ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_char ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
-        char c = *((char*)data + i);
-        val.PushBack(Value().SetString(&c, 1, document.GetAllocator()), document.GetAllocator());
+        writer.String((const char *)data + i, 1);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_double ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_double ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     double d;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(d)), &d);
-        val.PushBack(Value().SetDouble(d), document.GetAllocator());
+        writer.Double(d);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_float ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_float ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     float f;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(f)), &f);
-        val.PushBack(Value().SetFloat(f), document.GetAllocator());
+        writer.Double(f);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_int ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_int ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     int iv;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(iv)), &iv);
-        val.PushBack(Value().SetInt(iv), document.GetAllocator());
+        writer.Int(iv);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_long ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_long ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     long long l;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(l)), &l);
-        val.PushBack(Value().SetInt64(l), document.GetAllocator());
+        writer.Int64(l);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_longdouble ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_longdouble ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     long double ld;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ld)), &ld);
-        val.PushBack(Value().SetDouble(ld), document.GetAllocator());
+        writer.Double((double)ld);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_longlong ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_longlong ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     long long ll;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ll)), &ll);
-        val.PushBack(Value().SetInt64(ll), document.GetAllocator());
+        writer.Int64(ll);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_charptr ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_charptr ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
-    void * p;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
-        desc->copy(desc, ((uint8_t*)data + i*sizeof(p)), &p);
-        val.PushBack(Value().SetString((char*)p, document.GetAllocator()), document.GetAllocator());
+        // Read the pointer directly - desc->copy would duplicate the string.
+        const char * p = *(const char * const *)((uint8_t*)data + i*sizeof(p));
+        if (p == NULL)
+        {
+            writer.Null();
+        }
+        else
+        {
+            writer.String(p);
+        }
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_short ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_short ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     short sh;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(sh)), &sh);
-        val.PushBack(Value().SetInt((int)sh), document.GetAllocator());
+        writer.Int((int)sh);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_uchar ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_uchar ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     unsigned char uc;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(uc)), &uc);
-        val.PushBack(Value().SetUint((uint8_t)uc), document.GetAllocator());
+        writer.Uint((uint8_t)uc);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_uint ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_uint ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     unsigned int ui;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ui)), &ui);
-        val.PushBack(Value().SetUint(ui), document.GetAllocator());
+        writer.Uint(ui);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_ulong ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_ulong ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     unsigned long ul;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ul)), &ul);
-        val.PushBack(Value().SetUint64(ul), document.GetAllocator());
+        writer.Uint64(ul);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_ulonglong ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_ulonglong ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     unsigned long long ll;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ll)), &ll);
-        val.PushBack(Value().SetUint64(ll), document.GetAllocator());
+        writer.Uint64(ll);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
-static Value * UMLRTObject_toJson_ushort ( Document & document, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
+static void UMLRTObject_toJson_ushort ( UMLRTJsonWriter & writer, const UMLRTObject_class * desc, const void * data, int nest, int arraySize )
 {
-    Value type;
-    Value val(kArrayType);
-    Value * obj = new Value(kObjectType);
-
     unsigned short ush;
+    UMLRTObject_toJsonBegin(writer, desc);
     for (int i = 0; i < arraySize; ++i)
     {
         desc->copy(desc, ((uint8_t*)data + i*sizeof(ush)), &ush);
-        val.PushBack(Value().SetUint(ush), document.GetAllocator());
+        writer.Uint(ush);
     }
-
-    type.SetString(StringRef(desc->name));
-    obj->AddMember("type", type, document.GetAllocator());
-    obj->AddMember("value", val, document.GetAllocator());
-
-    return obj;
+    writer.EndArray();
 }
 
 void * UMLRTObject_fromJson ( Value & value, const UMLRTObject_class * desc, void * dst, int nest )
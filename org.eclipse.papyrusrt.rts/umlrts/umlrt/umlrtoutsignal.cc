@@ -15,9 +15,12 @@
 #include "umlrtcontroller.hh"
 #include "umlrtexecutiondirector.hh"
 #include "umlrtframeservice.hh"
+#include "umlrtinvoke.hh"
+#include "umlrtmessage.hh"
 #include "umlrtoutsignal.hh"
 #include "umlrtpriority.hh"
 #include "umlrtslot.hh"
+#include "umlrtuserconfig.hh"
 #include "basefatal.hh"
 #include "basedebugtype.hh"
 #include "basedebug.hh"
@@ -55,22 +58,74 @@ void UMLRTOutSignal::encode ( const UMLRTObject_class * desc, const void * src,
 // Synchronous send out all port instances. Returns the number of replies (0 if fail).
 int UMLRTOutSignal::invoke ( UMLRTMessage * replyMsgs )
 {
-    FATAL("invoke not implemented");
-    return 0;
+    int numReply = 0;
+
+    if (!element)
+    {
+        BDEBUG(BD_SWERR, "WARNING: attempt to invoke an invalid signal. Capsule and port information are not known.\n");
+    }
+    else
+    {
+        const UMLRTCommsPort * srcPort = element->getSrcPort();
+
+        // Replies are packed at the front of 'replyMsgs'.
+        for (size_t i = 0; (srcPort != NULL) && (i < srcPort->numFarEnd); ++i)
+        {
+            numReply += invokeAt(i, &replyMsgs[numReply]);
+        }
+    }
+    return numReply;
 }
 
 // Synchronous send out a specific port instance. Returns the number of replies (0 or 1).
 int UMLRTOutSignal::invokeAt ( int index, UMLRTMessage * replyMsg )
 {
-    FATAL("invokeAt not implemented");
-    return 0;
+    int numReply = 0;
+
+    if (!element)
+    {
+        BDEBUG(BD_SWERR, "WARNING: attempt to invoke an invalid signal. Capsule and port information are not known.\n");
+    }
+    else
+    {
+        const UMLRTCommsPort * srcPort = element->getSrcPort();
+
+        if (!srcPort)
+        {
+            FATAL("No srcPort when invoking a signal. Should be the unbound port at least.");
+        }
+        else if (srcPort->unbound)
+        {
+            srcPort->slot->controller->setError(UMLRTController::E_SEND_UNBOUND);
+        }
+        else
+        {
+            element->setPriority(PRIORITY_SYNCHRONOUS);
+
+            numReply = UMLRTInvoke::invokeAt(*this, index, replyMsg);
+        }
+    }
+    return numReply;
 }
 
 // Reply to a synchronous message. Return true if success.
 bool UMLRTOutSignal::reply ( )
 {
-    FATAL("reply not implemented");
-    return false;
+    bool ok = false;
+
+    if (!element)
+    {
+        BDEBUG(BD_SWERR, "WARNING: attempt to reply with an invalid signal. Capsule and port information are not known.\n");
+    }
+    else if (!element->getSrcPort())
+    {
+        FATAL("No srcPort when replying with a signal. Should be the unbound port at least.");
+    }
+    else
+    {
+        ok = UMLRTInvoke::reply(*this);
+    }
+    return ok;
 }
 
 bool UMLRTOutSignal::send ( UMLRTPriority priority ) const
@@ -105,9 +160,13 @@ bool UMLRTOutSignal::send ( UMLRTPriority priority ) const
                 element->setPriority(priority);
 
                 // Attempt all sends regardless of errors - one successful send will mean overall success.
-                for (size_t i = 0; (i < srcPort->numFarEnd); ++i)
+                if (srcPort->numFarEnd == 1)
+                {
+                    ok = signalDeliver(srcPort, 0);
+                }
+                else if (srcPort->numFarEnd > 1)
                 {
-                    ok |= signalDeliver(srcPort, i);
+                    ok = signalBroadcast(srcPort);
                 }
                 if (ok)
                 {
@@ -217,3 +276,140 @@ bool UMLRTOutSignal::signalDeliver ( const UMLRTCommsPort * srcPort, size_t port
 
     return ok;
 }
+
+// Messages of a broadcast bound for one controller.
+typedef struct
+{
+    UMLRTController * controller;
+    UMLRTMessage * first;
+    UMLRTMessage * last;
+    size_t count;
+
+} BroadcastBatch;
+
+static void broadcastFlush ( BroadcastBatch * batch, size_t & numBatch )
+{
+    for (size_t b = 0; b < numBatch; ++b)
+    {
+        batch[b].controller->deliverAll(batch[b].first, batch[b].last, batch[b].count);
+    }
+    numBatch = 0;
+}
+
+// Deliver the signal to all far ends of the source port.
+bool UMLRTOutSignal::signalBroadcast ( const UMLRTCommsPort * srcPort ) const
+{
+    bool ok = false;
+
+    BroadcastBatch batch[USER_CONFIG_BROADCAST_MAX_CONTROLLERS];
+    size_t numBatch = 0;
+
+    // Lock the RTS once for all far ends.
+    UMLRTFrameService::rtsLock();
+
+    if (srcPort->slot->condemned)
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_SEND_FROM_DSTR);
+    }
+    else
+    {
+        bool remote = false;
+
+        // Count the references of all local messages at once. Those not used are dropped at the end.
+        int referencesHeld = (int)srcPort->numFarEnd;
+        element->incrementRefCount(referencesHeld);
+
+        for (size_t i = 0; i < srcPort->numFarEnd; ++i)
+        {
+            const UMLRTCommsPort * destPort = srcPort->farEnds[i].port;
+
+            BDEBUG(BD_SEND, "Controller '%s' capsule '%s' attempt to broadcast signal '%s' from port '%s[%lu]' to capsule '%s' port '%s'\n",
+                    srcPort->slot->controller->getName(),
+                    srcPort->slot->capsule->name(),
+                    getName(),
+                    srcPort->getName(),
+                    i,
+                    (destPort == NULL) ? "(no dest capsule - dest port NULL)" :
+                            (destPort->slot->capsule == NULL) ? "(no destination capsule - not instantiated)" : destPort->slot->capsule->getName(),
+                    (destPort == NULL) ? "(dest port NULL)" : destPort->getName());
+
+            if (destPort == NULL)
+            {
+                srcPort->slot->controller->setError(UMLRTController::E_SEND_PRT_NOT_CON);
+            }
+            else if (destPort->slot->condemned)
+            {
+                srcPort->slot->controller->setError(UMLRTController::E_SEND_TO_DSTR);
+            }
+            else if (destPort->slot->remote)
+            {
+                // Sent below - one frame per remote host.
+                remote = true;
+            }
+            else if (destPort->slot->capsule == NULL)
+            {
+                srcPort->slot->controller->setError(UMLRTController::E_SEND_NO_CAP_INST);
+            }
+            else if (destPort->slot->controller == NULL)
+            {
+                FATAL("Destination slot %s has no controller when sending from capsule %s via port %s[%d].",
+                        destPort->slot,
+                        srcPort->slotName(),
+                        srcPort->getName(),
+                        i);
+            }
+            else
+            {
+                UMLRTController * controller = destPort->slot->controller;
+                UMLRTMessage * msg = controller->prepareDelivery(destPort, *this, i, true/*referenceHeld*/);
+
+                // Error code set by 'prepareDelivery' if no message was available.
+                if (msg != NULL)
+                {
+                    --referencesHeld;
+                    ok = true;
+
+                    size_t b = 0;
+                    while ((b < numBatch) && (batch[b].controller != controller))
+                    {
+                        ++b;
+                    }
+                    if (b < numBatch)
+                    {
+                        batch[b].last->next = msg;
+                        batch[b].last = msg;
+                        ++batch[b].count;
+                    }
+                    else
+                    {
+                        if (numBatch == USER_CONFIG_BROADCAST_MAX_CONTROLLERS)
+                        {
+                            // Too many destination controllers - queue what we have so far and start over.
+                            broadcastFlush(batch, numBatch);
+                        }
+                        b = numBatch++;
+                        batch[b].controller = controller;
+                        batch[b].first = batch[b].last = msg;
+                        batch[b].count = 1;
+                    }
+                }
+            }
+        }
+        broadcastFlush(batch, numBatch);
+
+        if (remote)
+        {
+            ok |= UMLRTExecutionDirector::sendSignalAll( *this );
+        }
+
+        if (referencesHeld > 0)
+        {
+            // The sender's own reference keeps the element allocated.
+            element->decrementRefCount(referencesHeld);
+        }
+    }
+    // Unlock the RTS
+    UMLRTFrameService::rtsUnlock();
+
+    return ok;
+}
@@ -10,6 +10,7 @@
 
 #include <stdlib.h>
 #include "basefatal.hh"
+#include "basedebugtype.hh"
 #include "basedebug.hh"
 #include "umlrtguard.hh"
 #include "umlrtpool.hh"
@@ -19,8 +20,9 @@
 // See umlrtqueue.hh for documentation.
 
 // Create an empty queue.
-UMLRTPool::UMLRTPool(size_t incrementSize) :
-        head(0), increment(incrementSize), qid(0)
+UMLRTPool::UMLRTPool(size_t incrementSize, size_t maxSize_) :
+        head(0), increment(incrementSize), maxSize(maxSize_), size(0), qid(0), backing(USER_CONFIG_POOL_BACKING),
+        inUse(0), highWater(0), exhausted(0)
 {
 }
 
@@ -34,12 +36,17 @@ const UMLRTQueueElement * UMLRTPool::get()
 {
     UMLRTGuard g(mutex);
 
-    if (head == NULL)
+    if ((head == NULL) && !reserve(increment))
     {
-        grow();
+        ++exhausted;
+        return NULL;
     }
     const UMLRTQueueElement * element = head;
     head = element->next;
+    if (++inUse > highWater)
+    {
+        highWater = inUse;
+    }
     return element;
 }
 
@@ -51,5 +58,55 @@ void UMLRTPool::put(const UMLRTQueueElement * element)
     {
         element->next = head;
         head = element;
+        if (inUse > 0)
+        {
+            --inUse;
+        }
+    }
+}
+
+bool UMLRTPool::configure(size_t initialSize, size_t maxSize_, size_t incrementSize, UMLRTMemoryRegion::Backing backing_)
+{
+    UMLRTGuard g(mutex);
+
+    maxSize = maxSize_;
+    increment = incrementSize;
+    backing = backing_;
+
+    return (size >= initialSize) || reserve(initialSize - size);
+}
+
+bool UMLRTPool::reserve(size_t count)
+{
+    // Assumes mutex is taken.
+    if ((maxSize != 0) && ((size + count) > maxSize))
+    {
+        count = (size < maxSize) ? maxSize - size : 0;
+    }
+    if (count == 0)
+    {
+        return false;
     }
+    size_t bytes = count * elementSize();
+    UMLRTMemoryRegion::Backing actual = backing;
+    void * region = UMLRTMemoryRegion::allocate(bytes, actual);
+
+    if (region == NULL)
+    {
+        BDEBUG(BD_ERROR, "could not grow pool by %lu elements\n", (unsigned long)count);
+        return false;
+    }
+    // Don't retry an unavailable backing on every growth.
+    backing = actual;
+
+    // Use the whole region, within the limit.
+    count = bytes / elementSize();
+    if ((maxSize != 0) && ((size + count) > maxSize))
+    {
+        count = maxSize - size;
+    }
+    grow(region, count);
+    size += count;
+
+    return true;
 }
@@ -16,7 +16,6 @@
 #include "umlrtcommsportrole.hh"
 #include "umlrtprioritymessagequeue.hh"
 #include "umlrtmessage.hh"
-#include "umlrttimer.hh"
 #include "osnotify.hh"
 #include <stdlib.h>
 #include <stdio.h>
@@ -43,71 +42,6 @@ UMLRTMessageQueue & UMLRTPriorityMessageQueue::getQueue ( UMLRTPriority priority
     return queue[priority];
 }
 
-// Used to transfer all messages from each priority queue to
-// their associated priority-queue
-
-void UMLRTPriorityMessageQueue::moveAll ( UMLRTPriorityMessageQueue & fromQueue )
-{
-    for (UMLRTPriority priority = PRIORITY_SYNCHRONOUS; priority < PRIORITY_MAXPLUS1; ++priority)
-    {
-        const UMLRTQueueElement * last; // These are UMLRTMessage's.
-        size_t count;
-        const UMLRTQueueElement * all = fromQueue.getQueue(priority).dequeueAll(&last, &count);
-
-        queue[priority].enqueueAll(all, last, count);
-    }
-}
-
-// Get all expired timers from the timer-queue and enqueue these to this the capsule priority message queue.
-// The 'incomingQueue' is also a priority queue, but timers are never queued to the incomingQueue instance.
-void UMLRTPriorityMessageQueue::queueTimerMessages ( UMLRTTimerQueue * timerQueue )
-{
-    UMLRTTimer * timer = timerQueue->dequeue();
-
-    while (timer != NULL)
-    {
-        if (!timer->allocated)
-        {
-            FATAL("%s:timer (%p) obtained from timer-queue is not allocated.", owner, timer);
-        }
-        UMLRTMessage * msg = umlrt::MessageGetFromPool();
-
-        if (!msg)
-        {
-            FATAL("message allocation failed during timout message creation.");
-        }
-        msg->signal = timer->signal;
-        msg->destPort = timer->destPort;
-        msg->destSlot = timer->destSlot;
-        msg->srcPortIndex = 0; // Timer ports are not replicated.
-        msg->isCommand = false;
-
-        char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-        BDEBUG(BD_TIMER, "%s: queue timer msg signal id(%d) to %s(%s) isInterval(%d) due(%s)\n",
-                owner, msg->signal.getId(), msg->destPort->slotName(), msg->sap()->getName(), timer->isInterval,
-                timer->isInterval ?  timer->due.toStringRelative(tmbuf, sizeof(tmbuf)): timer->due.toString(tmbuf, sizeof(tmbuf)));
-
-        enqueue(msg);
-
-        if (timer->isInterval)
-        {
-            // This is an interval timer. Adjust it's due-time and requeue it.
-            UMLRTTimerQueue::timeAdjustLock();
-            timer->due += timer->interval;
-            UMLRTTimerQueue::timeAdjustUnlock();
-            timerQueue->enqueue(timer);
-        }
-        else
-        {
-            // This timer can be put back on the system pool.
-            umlrt::TimerPutToPool(timer);
-        }
-
-        // See if there's another one expired.
-        timer = timerQueue->dequeue();
-    }
-}
-
 // Get the highest priority message from the collection of queues.
 
 UMLRTMessage * UMLRTPriorityMessageQueue::dequeueHighestPriority ( )
@@ -164,6 +98,28 @@ void UMLRTPriorityMessageQueue::enqueue ( UMLRTMessage * msg, bool front )
     notifyPtr->sendNotification();
 }
 
+// See umlrtprioritymessagequeue.hh for documentation.
+void UMLRTPriorityMessageQueue::enqueueAll ( UMLRTMessage * first, UMLRTMessage * last, size_t count )
+{
+    UMLRTPriority priority = first->signal.getPriority();
+
+    if ((priority < PRIORITY_SYNCHRONOUS) || (priority >= PRIORITY_MAXPLUS1))
+    {
+        FATAL("enqueueAll with bad priority (%d)", priority);
+    }
+    BDEBUG(BD_MSG, "%s: %d msgs enqueued priority(%d) signal id(%d)(%s) payloadSz(%d)\n",
+            owner,
+            count,
+            priority,
+            first->getSignalId(),
+            first->getSignalName(),
+            first->signal.getPayloadSize());
+
+    queue[priority].enqueueAll(first, last, count);
+
+    notifyPtr->sendNotification();
+}
+
 // See umlrtprioritymessagequeue.hh for documentation.
 bool UMLRTPriorityMessageQueue::isEmpty ( )
 {
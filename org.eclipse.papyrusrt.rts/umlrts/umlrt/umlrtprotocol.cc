@@ -259,6 +259,11 @@ const char * UMLRTProtocol::getRegisteredName() const
     return srcPort->registeredName;
 }
 
+UMLRTLinkPolicy UMLRTProtocol::getLinkPolicy() const
+{
+    return srcPort->linkPolicy;
+}
+
 /*static*/ bool UMLRTProtocol::isRegistered( const UMLRTCommsPort * port )
 {
     UMLRTFrameService::rtsLock();
@@ -559,6 +564,16 @@ bool UMLRTProtocol::registerSPP( const char * service )
     return ok;
 }
 
+bool UMLRTProtocol::setLinkPolicy( UMLRTLinkPolicy policy )
+{
+    if (policy >= LINK_POLICY_MAXPLUS1)
+    {
+        return false;
+    }
+    srcPort->linkPolicy = policy;
+    return true;
+}
+
 /*static*/ void UMLRTProtocol::removeSapFromQueue( const UMLRTCommsPort * sapPort )
 {
     // Assumes RTS lock obtained.
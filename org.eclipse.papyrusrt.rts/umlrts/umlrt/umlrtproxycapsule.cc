@@ -0,0 +1,46 @@
+// umlrtproxycapsule.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtproxycapsule.hh"
+#include "umlrtmessage.hh"
+#include "umlrthost.hh"
+#include "basedebug.hh"
+#include "basedebugtype.hh"
+#include "basefatal.hh"
+
+// See umlrtproxycapsule.hh for documentation.
+
+UMLRTProxyCapsule::UMLRTProxyCapsule ( const UMLRTCapsuleClass * capsuleClass_, UMLRTSlot * slot_, const UMLRTCommsPort * * borderPorts_, const UMLRTCommsPort * * internalPorts_ )
+    : UMLRTCapsule(NULL, capsuleClass_, slot_, borderPorts_, internalPorts_, true/*isStatic*/)
+{
+    BDEBUG(BD_INSTANTIATE, "slot %s is a proxy for host %s\n", slot->name, slot->host ? slot->host->name : "-none-");
+}
+
+void UMLRTProxyCapsule::initialize ( const UMLRTMessage & msg )
+{
+    // The capsule is initialized on its own host.
+}
+
+void UMLRTProxyCapsule::inject ( const UMLRTMessage & msg )
+{
+    FATAL("slot %s: message '%s' delivered to the proxy of a capsule on host %s",
+            slot->name, msg.getSignalName(), slot->host ? slot->host->name : "-none-");
+}
+
+const char * UMLRTProxyCapsule::save ( )
+{
+    FATAL("slot %s: cannot save the proxy of a capsule on host %s", slot->name, slot->host ? slot->host->name : "-none-");
+    return NULL;
+}
+
+void UMLRTProxyCapsule::load ( const char * data )
+{
+    FATAL("slot %s: cannot load the proxy of a capsule on host %s", slot->name, slot->host ? slot->host->name : "-none-");
+}
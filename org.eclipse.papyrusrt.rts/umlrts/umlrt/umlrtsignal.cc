@@ -62,6 +62,18 @@ UMLRTSignal &UMLRTSignal::operator= ( const UMLRTSignal & signal )
     return *this;
 }
 
+void UMLRTSignal::adoptReference ( const UMLRTSignal & signal )
+{
+    if (&signal != this)
+    {
+        if (element)
+        {
+            element->decrementRefCount();
+        }
+        element = signal.element;
+    }
+}
+
 void UMLRTSignal::initialize ( const char * name, Id id, const UMLRTCommsPort * srcPort, UMLRTPriority priority )
 {
     if (element)
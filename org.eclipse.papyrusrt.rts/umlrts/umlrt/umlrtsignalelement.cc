@@ -26,9 +26,13 @@ extern uint8_t * globalDst;
 
 // See umlrtsignalelement.hh for documentation.
 
-UMLRTSignalElement::UMLRTSignalElement ( ) : id(0), srcPort(0), name(0), defaultPayload(0), payload(0), priority(PRIORITY_NORMAL), appPayloadSize(0),
-            maxPayloadSize(USER_CONFIG_SIGNAL_DEFAULT_PAYLOAD_SIZE), nonDefaultPayload(false), allocated(false), refCount(0), object(NULL), desc(NULL)
+UMLRTSignalElement::UMLRTSignalElement ( ) : id(0), payload(0), appPayloadSize(0), srcPort(0), name(0), desc(NULL), priority(PRIORITY_NORMAL),
+            nonDefaultPayload(false), allocated(false), refCount(0), object(NULL), defaultPayload(0), maxPayloadSize(USER_CONFIG_SIGNAL_DEFAULT_PAYLOAD_SIZE)
 {
+    // The layout described in umlrtsignalelement.hh - checked here, where the private fields are visible.
+    OS_STATIC_ASSERT(sizeof(UMLRTSignalElement) == (2 * OS_CACHE_LINE_SIZE), UMLRTSignalElement_is_two_cache_lines);
+    OS_STATIC_ASSERT(OS_MEMBER_OFFSET(UMLRTSignalElement, refCount) == OS_CACHE_LINE_SIZE, UMLRTSignalElement_refCount_starts_second_line);
+
     // DEFAULT PAYLOAD SIZE IS A CONSTANT HERE, BUT HAS TO BE OBTAINED AT RUN-TIME.
     if (!(defaultPayload = payload = (uint8_t*)malloc(USER_CONFIG_SIGNAL_DEFAULT_PAYLOAD_SIZE)))
     {
@@ -110,16 +114,16 @@ void UMLRTSignalElement::destroy ( )
     desc = NULL;
 }
 
-void UMLRTSignalElement::decrementRefCount ( ) const
+void UMLRTSignalElement::decrementRefCount ( int count ) const
 {
-    BDEBUG(BD_SIGNALREF, "(%p) qid[%d] signal element dec ref count(%d)\n", this, qid, refCount);
+    BDEBUG(BD_SIGNALREF, "(%p) qid[%d] signal element dec ref count(%d) by %d\n", this, qid, refCount, count);
 
     UMLRTGuard g(refCountMutex);
-    if (refCount <= 0)
+    if (refCount < count)
     {
-        FATAL("(%p)qid[%d] signal element dec ref count that is already zero id(%d)", this, qid, id);
+        FATAL("(%p)qid[%d] signal element dec ref count(%d) by %d below zero id(%d)", this, qid, refCount, count, id);
     }
-    else if (!(--refCount))
+    else if (!(refCount -= count))
     {
         BDEBUG(BD_SIGNALREF, "(%p) qid[%d] signal element dec ref count == 0 dealloc\n", this, qid);
 
@@ -217,13 +221,13 @@ const UMLRTObject_class * UMLRTSignalElement::getType ( size_t index ) const
 }
 
 
-void UMLRTSignalElement::incrementRefCount ( ) const
+void UMLRTSignalElement::incrementRefCount ( int count ) const
 {
-    BDEBUG(BD_SIGNALREF, "(%p) qid[%d] signal element inc ref count(%d)\n", this, qid, refCount);
+    BDEBUG(BD_SIGNALREF, "(%p) qid[%d] signal element inc ref count(%d) by %d\n", this, qid, refCount, count);
 
     UMLRTGuard g(refCountMutex);
 
-    ++refCount;
+    refCount += count;
 }
 
 // Initialize a signal from the pool and make sure the payload is large enough.
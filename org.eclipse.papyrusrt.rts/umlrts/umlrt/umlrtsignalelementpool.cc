@@ -9,14 +9,15 @@
  *******************************************************************************/
 
 // See umlrtsignalpool.hh for documentation.
+#include <new>
 #include <stdlib.h>
 #include "basefatal.hh"
 #include "umlrtguard.hh"
 #include "umlrtsignalelementpool.hh"
 
 UMLRTSignalElementPool::UMLRTSignalElementPool(UMLRTSignalElement signalElements[],
-        size_t arraySize, size_t incrementSize) :
-        UMLRTPool(incrementSize)
+        size_t arraySize, size_t incrementSize, size_t maxSize_) :
+        UMLRTPool(incrementSize, maxSize_)
 {
     UMLRTGuard g(mutex);
 
@@ -28,24 +29,34 @@ UMLRTSignalElementPool::UMLRTSignalElementPool(UMLRTSignalElement signalElements
             signalElements[i - 1].qid = qid++;
         }
         head = &signalElements[0];
+        size = arraySize;
     }
 }
 
-UMLRTSignalElementPool::UMLRTSignalElementPool(size_t incrementSize) :
-        UMLRTPool(incrementSize)
+UMLRTSignalElementPool::UMLRTSignalElementPool(size_t incrementSize, size_t maxSize_) :
+        UMLRTPool(incrementSize, maxSize_)
 {
 
 }
 
-void UMLRTSignalElementPool::grow()
+size_t UMLRTSignalElementPool::elementSize() const
 {
-    UMLRTSignalElement * newElements = new UMLRTSignalElement[increment]();
+    return sizeof(UMLRTSignalElement);
+}
+
+void UMLRTSignalElementPool::grow(void * region, size_t count)
+{
+    UMLRTSignalElement * newElements = (UMLRTSignalElement *)region;
 
-    for (size_t i = increment - 1; i > 0; --i)
+    for (size_t i = 0; i < count; ++i)
+    {
+        new (&newElements[i]) UMLRTSignalElement();
+    }
+    for (size_t i = count - 1; i > 0; --i)
     {
         newElements[i - 1].next = &newElements[i];
     }
-    newElements[increment - 1].next = head;
+    newElements[count - 1].next = head;
     head = &newElements[0];
 }
 
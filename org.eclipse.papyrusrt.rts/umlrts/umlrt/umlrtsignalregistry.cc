@@ -2,7 +2,9 @@
 
 #include "basedebug.hh"
 #include "basefatal.hh"
+#include "umlrtjsonreader.hh"
 #include "umlrtsignalregistry.hh"
+#include <rapidjson/error/en.h>
 #include <string>
 
 UMLRTSignalRegistry::~UMLRTSignalRegistry ( ) 
@@ -173,144 +175,227 @@ UMLRTObject* UMLRTSignalRegistry::getInSignalPayloadObject ( const char* protoco
 	return NULL;
 }
 
-bool UMLRTSignalRegistry::fromJSON( const char * json, const UMLRTCommsPort * port, UMLRTSignal & signal )
+// SAX handler for a signal message: {"signal": name, "params": [typed value, ...]}.
+// The signal name must precede the parameters (toJSON always writes it first) so each
+// parameter can be decoded straight into the payload as it is parsed.
+class UMLRTSignalJsonHandler : public BaseReaderHandler<UTF8<>, UMLRTSignalJsonHandler>
 {
-	Document document;
-	document.Parse(json);
+public:
+	UMLRTSignalJsonHandler ( UMLRTSignalRegistry & registry_, const char * protocol_ )
+		: registry(registry_), protocol(protocol_), signalName(NULL), signalID(-1), payloadObj(NULL), data(NULL),
+		  state(TOP), skipDepth(0), param(0), gotParams(false) { }
 
-	if(!document.IsObject()) {
-		fprintf(stderr, "Error parsing JSON message: '%s'\n", json);
-		return false;
-	}
-
-	if(!document.HasMember("signal")) {
-		fprintf(stderr, "Error parsing JSON message: '%s'\n", json);
-		return false;
-	}
-
-	const Value& sigVal = document["signal"];
-	if(!sigVal.IsString()) {
-		fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-		return false;
+	~UMLRTSignalJsonHandler ( )
+	{
+		if(data == NULL)
+			return;
+		// The signal holds its own copies of string parameters - free the decoded ones.
+		for(size_t i=0; i<payloadObj->numFields; i++) {
+			const UMLRTObject_field * field = &payloadObj->fields[i];
+			if(field->desc == &UMLRTType_charptr)
+				for(int j=0; j<field->arraySize; j++)
+					field->desc->destroy(field->desc, data + field->offset + j * sizeof(char *));
+		}
+		free(data);
 	}
 
-	const char* signalName = sigVal.GetString();
-	const char* protocolName = port->role()->protocol;
-
-	int signalID = getInSignalID(protocolName, signalName);
-	if(signalID == -1)
-		return false;
+	bool Null ( )                  { return inParam() ? forward(reader.Null()) : scalar(); }
+	bool Bool ( bool b )           { return inParam() ? forward(reader.Bool(b)) : scalar(); }
+	bool Int ( int i )             { return inParam() ? forward(reader.Int(i)) : scalar(); }
+	bool Uint ( unsigned u )       { return inParam() ? forward(reader.Uint(u)) : scalar(); }
+	bool Int64 ( int64_t i )       { return inParam() ? forward(reader.Int64(i)) : scalar(); }
+	bool Uint64 ( uint64_t u )     { return inParam() ? forward(reader.Uint64(u)) : scalar(); }
+	bool Double ( double d )       { return inParam() ? forward(reader.Double(d)) : scalar(); }
+	bool Key ( const char * str, SizeType length, bool copy ) { return inParam() ? forward(reader.Key(str, length, copy)) : key(str); }
+	bool EndObject ( SizeType memberCount ) { return inParam() ? forward(reader.EndObject(memberCount)) : endCompound(TOP_DONE); }
+	bool EndArray ( SizeType elementCount ) { return inParam() ? forward(reader.EndArray(elementCount)) : endCompound(MEMBER); }
+
+	bool String ( const char * str, SizeType length, bool copy )
+	{
+		if(inParam())
+			return forward(reader.String(str, length, copy));
+		if(state != SIGNAL)
+			return scalar();
+
+		signalName = str;
+		if((signalID = registry.getInSignalID(protocol, signalName)) == -1)
+			return false;
 
-	UMLRTObject * payloadObj = getInSignalPayloadObject(protocolName, signalName);
-	if(payloadObj->sizeOf == 0)
-		payloadObj = NULL;
+		payloadObj = registry.getInSignalPayloadObject(protocol, signalName);
+		if(payloadObj != NULL && payloadObj->sizeOf == 0)
+			payloadObj = NULL;
+		if(payloadObj != NULL && (data = (uint8_t *)calloc(1, payloadObj->sizeOf)) == NULL)
+			FATAL("memory allocation failed for payload data");
 
-	if(payloadObj != NULL && !document.HasMember("params")) {
-		fprintf(stderr, "Mismatched signal parameters in JSON message '%s'\n", json);
-		return false;
+		state = MEMBER;
+		return true;
 	}
 
-	if(payloadObj == NULL && document.HasMember("params")) {
-		const Value& paramsArr = document["params"];
-		if(!paramsArr.IsArray()) {
-			fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-			return false;
+	bool StartObject ( )
+	{
+		if(inParam())
+			return forward(reader.StartObject());
+		if(state == TOP) {
+			state = MEMBER;
+			return true;
 		}
-
-		if(paramsArr.Size() > 0) {
-			fprintf(stderr, "Mismatched signal parameters in JSON message '%s'\n", json);
-			return false;
+		if(state == SKIP) {
+			++skipDepth;
+			return true;
 		}
+		if(state != PARAMS || payloadObj == NULL || param >= payloadObj->numFields)
+			return false; // Parameters before the signal name, or too many of them.
+
+		const UMLRTObject_field * field = &payloadObj->fields[param];
+		reader.begin(field->desc, data + field->offset, field->arraySize);
+		return forward(reader.StartObject());
 	}
 
-	if(payloadObj != NULL) {
-		const Value& paramsArr = document["params"];
-		if(!paramsArr.IsArray()) {
-			fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-			return false;
+	bool StartArray ( )
+	{
+		if(inParam())
+			return forward(reader.StartArray());
+		if(state == SKIP) {
+			++skipDepth;
+			return true;
 		}
-
-		if(payloadObj->numFields != paramsArr.Size()) {
-			fprintf(stderr, "Mismatched signal parameters in JSON message '%s'\n", json);
+		if(state != PARAMS_START)
 			return false;
-		}
-
-		uint8_t* data = (uint8_t*) malloc(sizeof(uint8_t) * payloadObj->sizeOf);
-		if(data == NULL)
-			FATAL("memory allocation failed for payload data");
-
-		for (size_t i=0; i<payloadObj->numFields; i++)
-	    {
-			const Value& paramObj = paramsArr[i];
-			if(!paramObj.IsObject()) {
-				fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-				return false;
-			}
-
-			if(!paramObj.HasMember("value")) {
+		state = PARAMS;
+		return true;
+	}
 
-				fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-				return false;
-			}
+	// True if the message named a known signal and supplied exactly its parameters.
+	bool isComplete ( ) const
+	{
+		return state == TOP_DONE
+			&& signalID != -1
+			&& (payloadObj == NULL ? param == 0 : (gotParams && param == payloadObj->numFields));
+	}
 
-			if(paramObj.HasMember("type")
-				&& !paramObj["type"].IsString()) {
+	const char * getSignalName ( ) const { return signalName; }
+	int getSignalID ( ) const { return signalID; }
+	UMLRTObject * getPayloadObject ( ) const { return payloadObj; }
+	uint8_t * getData ( ) const { return data; }
 
-				fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-				return false;
-			}
+private:
+	enum State { TOP, MEMBER, SIGNAL, PARAMS_START, PARAMS, SKIP, TOP_DONE };
 
-			if(payloadObj->fields[i].desc->fromJson((Value&)paramObj["value"],
-					payloadObj->fields[i].desc, data + payloadObj->fields[i].offset, 0) == NULL) {
-				fprintf(stderr, "Erroneous JSON message: '%s'\n", json);
-								return false;
-			}
-	    }
+	bool inParam ( ) const { return !reader.isDone(); }
 
-		signal.initialize(signalName, signalID, port, payloadObj, data);
+	bool forward ( bool ok )
+	{
+		if(ok && reader.isDone())
+			++param;
+		return ok;
+	}
 
-		free(data);
+	bool key ( const char * str )
+	{
+		if(state == SKIP)
+			return skipDepth > 0;
+		if(state != MEMBER)
+			return false;
+		if(strcmp(str, "signal") == 0 && signalName == NULL)
+			state = SIGNAL;
+		else if(strcmp(str, "params") == 0 && !gotParams) {
+			gotParams = true;
+			state = PARAMS_START;
+		}
+		else
+			state = SKIP; // Unknown members are ignored.
+		return true;
 	}
 
-	else {
+	// A scalar outside any parameter is only accepted as (part of) the value of an ignored member.
+	bool scalar ( )
+	{
+		if(state != SKIP)
+			return false;
+		if(skipDepth == 0)
+			state = MEMBER;
+		return true;
+	}
 
-		signal.initialize(signalName, signalID, port);
+	bool endCompound ( State next )
+	{
+		if(state == SKIP) {
+			if(skipDepth == 0)
+				return false;
+			if(--skipDepth == 0)
+				state = MEMBER;
+			return true;
+		}
+		if(next == MEMBER && state != PARAMS)
+			return false;
+		if(next == TOP_DONE && state != MEMBER)
+			return false;
+		state = next;
+		return true;
+	}
 
+	UMLRTSignalRegistry & registry;
+	const char * protocol;
+	const char * signalName;
+	int signalID;
+	UMLRTObject * payloadObj;
+	uint8_t * data;
+	State state;
+	int skipDepth; // Nesting within an ignored member's value.
+	size_t param;
+	bool gotParams;
+	UMLRTJsonReader reader;
+};
+
+bool UMLRTSignalRegistry::fromJSON( char * json, const UMLRTCommsPort * port, UMLRTSignal & signal )
+{
+	UMLRTSignalJsonHandler handler(*this, port->role()->protocol);
+	InsituStringStream stream(json);
+	Reader reader;
+
+	ParseResult result = reader.Parse<kParseInsituFlag>(stream, handler);
+	if(!result) {
+		fprintf(stderr, "Erroneous JSON message for protocol %s (%s at offset %u)\n",
+				port->role()->protocol, GetParseError_En(result.Code()), (unsigned)result.Offset());
+		return false;
 	}
+	if(!handler.isComplete()) {
+		fprintf(stderr, "Mismatched signal parameters in JSON message for protocol %s\n", port->role()->protocol);
+		return false;
+	}
+
+	if(handler.getPayloadObject() != NULL)
+		signal.initialize(handler.getSignalName(), handler.getSignalID(), port, handler.getPayloadObject(), handler.getData());
+	else
+		signal.initialize(handler.getSignalName(), handler.getSignalID(), port);
 
 	return true;
 }
 
 std::string UMLRTSignalRegistry::toJSON( const UMLRTSignal & signal ) {
-	Document document;
-	document.SetObject();
-	Document::AllocatorType& allocator = document.GetAllocator();
-
-	Value paramsArray(kArrayType);
-
 	const UMLRTObject * payloadObj = getOutSignalPayloadObject(
 		signal.getSrcPort()->role()->protocol, signal.getName());
 
 	if(payloadObj == NULL)
 		FATAL("cannot to encode signal with invalid payload object");
 
-	for(size_t i=0; i<payloadObj->numFields; i++) {
+	StringBuffer strbuf;
+	UMLRTJsonWriter writer(strbuf);
 
-		Value paramName;
-		paramName.SetString(payloadObj->fields[i].name, allocator);
-		Value * paramObj = payloadObj->fields[i].desc->toJson(document, payloadObj->fields[i].desc, signal.getParam(i), 0, payloadObj->fields[i].arraySize);
-		paramObj->AddMember("name", paramName, allocator);
-		paramsArray.PushBack(*paramObj, allocator);
+	writer.StartObject();
+	writer.Key("signal");
+	writer.String(signal.getName());
+	writer.Key("params");
+	writer.StartArray();
+	for(size_t i=0; i<payloadObj->numFields; i++) {
+		writer.StartObject();
+		writer.Key("name");
+		writer.String(payloadObj->fields[i].name);
+		payloadObj->fields[i].desc->toJson(writer, payloadObj->fields[i].desc, signal.getParam(i), 0, payloadObj->fields[i].arraySize);
+		writer.EndObject();
 	}
+	writer.EndArray();
+	writer.EndObject();
 
-	Value signalName;
-	signalName.SetString(signal.getName(), allocator);
-
-	document.AddMember("signal", signalName, allocator);
-	document.AddMember("params", paramsArray, allocator);
-
-	StringBuffer strbuf;
-	Writer<StringBuffer> writer(strbuf);
-	document.Accept(writer);
-	return strbuf.GetString();
+	return std::string(strbuf.GetString(), strbuf.GetSize());
 }
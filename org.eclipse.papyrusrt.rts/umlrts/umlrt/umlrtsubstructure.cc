@@ -0,0 +1,352 @@
+// umlrtsubstructure.cc
+
+/*******************************************************************************
+* Copyright (c) 2014-2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include "umlrtcapsulepart.hh"
+#include "umlrtcommsport.hh"
+#include "umlrtcommsportfarend.hh"
+#include "umlrtcommsportrole.hh"
+#include "umlrtdeferqueue.hh"
+#include "umlrtframeservice.hh"
+#include "umlrtfreeslots.hh"
+#include "umlrthashmap.hh"
+#include "umlrtprotocol.hh"
+#include "umlrtslot.hh"
+#include "umlrtsubstructure.hh"
+#include "umlrtguard.hh"
+#include "umlrtuserconfig.hh"
+#include "basefatal.hh"
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// See umlrtsubstructure.hh for documentation.
+
+// Block layout: the aligned header, then the objects (starting with the top part list, so the
+// block is found from the parts by #blockOf), then the names.
+
+void * UMLRTSubstructure::Cursor::take ( size_t size )
+{
+    size_t offset = align(objectBytes);
+    objectBytes = offset + size;
+    return (objects == NULL) ? NULL : objects + offset;
+}
+
+/*static*/ UMLRTMutex UMLRTSubstructure::mutex;
+
+char * UMLRTSubstructure::Cursor::takeName ( size_t size )
+{
+    size_t offset = nameBytes;
+    nameBytes += size;
+    return (names == NULL) ? NULL : names + offset;
+}
+
+/*static*/ UMLRTHashMap * UMLRTSubstructure::getLayoutMap ( )
+{
+    static UMLRTHashMap * layoutMap = NULL;
+
+    if (layoutMap == NULL)
+    {
+        layoutMap = new UMLRTHashMap("substructureLayout", UMLRTHashMap::compareValue, false/*objectIsString*/);
+    }
+    return layoutMap;
+}
+
+/*static*/ UMLRTSubstructure::Layout * UMLRTSubstructure::getLayout ( const UMLRTCapsuleClass * capsuleClass )
+{
+    // Assumes mutex is taken.
+    Layout * layout = (Layout *)getLayoutMap()->getObject(capsuleClass);
+
+    if (layout == NULL)
+    {
+        Cursor measure = { NULL, 0, NULL, 0, 0 };
+        place(measure, NULL, NULL, 0, capsuleClass);
+
+        layout = new Layout;
+        layout->objectBytes = align(measure.objectBytes);
+        layout->nameBytes = measure.nameBytes;
+        layout->numSlots = measure.numSlots;
+        layout->freeList = NULL;
+        layout->numFree = 0;
+        getLayoutMap()->insert(capsuleClass, layout);
+    }
+    return layout;
+}
+
+/*static*/ UMLRTCapsulePart * UMLRTSubstructure::create ( const char * containerName, const UMLRTCapsuleClass * capsuleClass )
+{
+    if (capsuleClass->numSubcapsuleRoles == 0)
+    {
+        return NULL;
+    }
+    size_t containerLength = strlen(containerName);
+    Layout * layout;
+    size_t size;
+    UMLRTSubstructure * block;
+    {
+        UMLRTGuard g(mutex);
+
+        layout = getLayout(capsuleClass);
+        size = layout->objectBytes + layout->nameBytes + layout->numSlots * containerLength;
+
+        // Containers have names of similar length, so the first recycled block usually fits.
+        UMLRTSubstructure * * link = &layout->freeList;
+        while ((*link != NULL) && ((*link)->size < size))
+        {
+            link = &(*link)->next;
+        }
+        if ((block = *link) != NULL)
+        {
+            *link = block->next;
+            --layout->numFree;
+        }
+    }
+    if (block == NULL)
+    {
+        if ((block = (UMLRTSubstructure *)malloc(align(sizeof(UMLRTSubstructure)) + size)) == NULL)
+        {
+            FATAL("could not allocate the sub-structure of slot %s (%lu bytes)", containerName, (unsigned long)size);
+        }
+        block->size = size;
+    }
+    block->layout = layout;
+    block->users = layout->numSlots + 1;
+    block->next = NULL;
+
+    char * objects = (char *)block + align(sizeof(UMLRTSubstructure));
+    Cursor cursor = { objects, 0, objects + layout->objectBytes, 0, 0 };
+
+    return place(cursor, block, containerName, containerLength, capsuleClass);
+}
+
+/*static*/ UMLRTCapsulePart * UMLRTSubstructure::place ( Cursor & cursor, UMLRTSubstructure * block, const char * containerName,
+        size_t containerLength, const UMLRTCapsuleClass * containerClass )
+{
+    if (containerClass->numSubcapsuleRoles == 0)
+    {
+        return NULL;
+    }
+    UMLRTCapsulePart * parts = (UMLRTCapsulePart *)cursor.take(containerClass->numSubcapsuleRoles * sizeof(UMLRTCapsulePart));
+
+    for (size_t i = 0; i < containerClass->numSubcapsuleRoles; ++i)
+    {
+        const UMLRTCapsuleRole * role = &containerClass->subcapsuleRoles[i];
+        const UMLRTCapsuleClass * capsuleClass = role->capsuleClass;
+        size_t roleLength = strlen(role->name);
+
+        UMLRTSlot * * slots = (UMLRTSlot * *)cursor.take(role->multiplicityUpper * sizeof(UMLRTSlot *));
+        UMLRTFreeSlots * freeSlots = NULL;
+
+        // Only optional and plugin parts are searched for a free slot.
+        if (role->optional || role->plugin)
+        {
+            void * tracker = cursor.take(sizeof(UMLRTFreeSlots));
+            void * bitmaps = cursor.take(UMLRTFreeSlots::storageSize(role->multiplicityUpper));
+            if (tracker != NULL)
+            {
+                freeSlots = new (tracker) UMLRTFreeSlots(role->multiplicityUpper, bitmaps);
+            }
+        }
+        if (parts != NULL)
+        {
+            parts[i].containerClass = containerClass;
+            parts[i].numSlot = role->multiplicityUpper;
+            parts[i].slots = slots;
+            parts[i].roleIndex = i;
+            parts[i].freeSlots = freeSlots;
+        }
+        for (size_t j = 0; j < role->multiplicityUpper; ++j)
+        {
+            // The name is <container>.<role>, with [<j>] appended for a replicated role.
+            char index[23]; // 18,446,744,073,709,551,615 is largest possible index in a 64-bit architecture.
+            size_t indexLength = 0;
+            index[0] = '\0';
+            if (role->multiplicityUpper > 1)
+            {
+                indexLength = snprintf(index, sizeof(index), "[%lu]", (unsigned long)j);
+            }
+            size_t nameLength = containerLength + 1 + roleLength + indexLength;
+            char * name = cursor.takeName(nameLength + 1);
+            if (name != NULL)
+            {
+                memcpy(name, containerName, containerLength);
+                name[containerLength] = '.';
+                memcpy(name + containerLength + 1, role->name, roleLength);
+                memcpy(name + containerLength + 1 + roleLength, index, indexLength + 1);
+            }
+            ++cursor.numSlots;
+
+            UMLRTSlot * slot = (UMLRTSlot *)cursor.take(sizeof(UMLRTSlot));
+            UMLRTCommsPort * ports = (UMLRTCommsPort *)cursor.take(capsuleClass->numPortRolesBorder * sizeof(UMLRTCommsPort));
+
+            const UMLRTCapsulePart * subcapsuleParts = place(cursor, block, name, nameLength, capsuleClass);
+
+            if (slot != NULL)
+            {
+                UMLRTSlot templateSlot = {
+                        name,
+                        j, // capsuleIndex
+                        capsuleClass,
+                        containerClass,
+                        i,
+                        NULL, // capsule,
+                        NULL, // controller
+                        false, // remote
+                        NULL, // remoteHost
+                        capsuleClass->numSubcapsuleRoles, // numParts
+                        subcapsuleParts,
+                        capsuleClass->numPortRolesBorder,
+                        ports,
+                        NULL, // slotToBorderMap
+                        0, // generated
+                        0, // condemned
+                        block, // substructure
+                        (freeSlots != NULL) ? &parts[i] : NULL, // part
+                        0, // resident
+                };
+                slots[j] = new (slot) UMLRTSlot(templateSlot);
+            }
+            for (size_t k = 0; k < capsuleClass->numPortRolesBorder; ++k)
+            {
+                size_t numFarEnd = capsuleClass->portRolesBorder[k].numFarEnd;
+                UMLRTCommsPortFarEnd * farEnds = NULL;
+                UMLRTDeferQueue * deferQueue = NULL;
+
+                if (numFarEnd > 0)
+                {
+                    farEnds = (UMLRTCommsPortFarEnd *)cursor.take(numFarEnd * sizeof(UMLRTCommsPortFarEnd));
+                    void * queue = cursor.take(sizeof(UMLRTDeferQueue));
+                    void * buckets = cursor.take(UMLRTDeferQueue::bucketStorageSize(numFarEnd));
+                    if (queue != NULL)
+                    {
+                        deferQueue = new (queue) UMLRTDeferQueue(numFarEnd, buckets);
+                    }
+                }
+                if (ports != NULL)
+                {
+                    UMLRTFrameService::definePort(&ports[k], slot, capsuleClass, k, true/*border*/, false/*importProxy*/, false/*isUnbound*/,
+                            farEnds, deferQueue);
+                }
+            }
+        }
+    }
+    return parts;
+}
+
+/*static*/ void UMLRTSubstructure::releaseParts ( const UMLRTSlot * slot )
+{
+    // An incarnated slot's parts start a block of their own - never the block the slot itself is in.
+    if ((slot->parts != NULL) && ((slot->substructure == NULL) || !slot->substructure->contains(slot->parts)))
+    {
+        release(blockOf(slot->parts));
+    }
+}
+
+bool UMLRTSubstructure::contains ( const void * address ) const
+{
+    const char * start = (const char *)this + align(sizeof(UMLRTSubstructure));
+
+    return ((const char *)address >= start) && ((const char *)address < (start + size));
+}
+
+/*static*/ void UMLRTSubstructure::releaseSlot ( UMLRTSlot * slot )
+{
+    for (size_t i = 0; i < slot->numPorts; ++i)
+    {
+        const UMLRTCommsPort * port = &slot->ports[i];
+
+        if (port->spp)
+        {
+            UMLRTProtocol::deregisterSppPort(port);
+        }
+        else if (port->sap)
+        {
+            UMLRTProtocol::deregisterSapPort(port);
+        }
+        if (port->deferQueue != NULL)
+        {
+            port->purge();
+            if (port->numFarEnd > 0)
+            {
+                port->deferQueue->~UMLRTDeferQueue(); // Placed in the block.
+            }
+            else
+            {
+                delete port->deferQueue; // Created on demand when the port was initialized.
+            }
+        }
+    }
+    release(slot->substructure);
+}
+
+/*static*/ void UMLRTSubstructure::discard ( const UMLRTCapsulePart * parts )
+{
+    if (parts != NULL)
+    {
+        discardSlots(parts);
+        release(blockOf(parts));
+    }
+}
+
+/*static*/ void UMLRTSubstructure::discardSlots ( const UMLRTCapsulePart * parts )
+{
+    // Depth first, as a destroy would.
+    for (size_t i = 0; i < parts[0].containerClass->numSubcapsuleRoles; ++i)
+    {
+        for (size_t j = 0; j < parts[i].numSlot; ++j)
+        {
+            if (parts[i].slots[j]->parts != NULL)
+            {
+                discardSlots(parts[i].slots[j]->parts);
+            }
+            releaseSlot(parts[i].slots[j]);
+        }
+    }
+}
+
+/*static*/ void UMLRTSubstructure::pin ( const UMLRTSlot * slot )
+{
+    if (slot->substructure != NULL)
+    {
+        ++slot->substructure->users;
+    }
+}
+
+/*static*/ void UMLRTSubstructure::unpin ( const UMLRTSlot * slot )
+{
+    if (slot->substructure != NULL)
+    {
+        release(slot->substructure);
+    }
+}
+
+/*static*/ void UMLRTSubstructure::release ( UMLRTSubstructure * block )
+{
+    if (block->users == 0)
+    {
+        FATAL("sub-structure released more often than it has users");
+    }
+    if (--block->users == 0)
+    {
+        UMLRTGuard g(mutex);
+        Layout * layout = block->layout;
+
+        if (layout->numFree < USER_CONFIG_SUBSTRUCTURE_FREE_LIST)
+        {
+            block->next = layout->freeList;
+            layout->freeList = block;
+            ++layout->numFree;
+        }
+        else
+        {
+            free(block);
+        }
+    }
+}
@@ -0,0 +1,139 @@
+// umlrtthreadattributes.cc
+
+/*******************************************************************************
+* Copyright (c) 2015 Zeligsoft (2009) Limited  and others.
+* All rights reserved. This program and the accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "osutil.hh"
+#include "umlrtthreadattributes.hh"
+
+// See umlrtthreadattributes.hh for documentation.
+
+UMLRTThreadAttributes::UMLRTThreadAttributes ( ) : numCpus(0), policy(POLICY_DEFAULT), priority(0), stackSize(0), numaNode(-1)
+{
+    memset(cpus, 0, sizeof(cpus));
+}
+
+void UMLRTThreadAttributes::addCpu ( int cpu )
+{
+    if (!hasCpu(cpu) && (cpu >= 0) && (cpu < MAX_CPUS))
+    {
+        cpus[cpu / 8] |= (1 << (cpu % 8));
+        ++numCpus;
+    }
+}
+
+bool UMLRTThreadAttributes::parseCpuList ( const char * list )
+{
+    const char * p = list;
+
+    while (*p != '\0')
+    {
+        char * end;
+        long first = strtol(p, &end, 10);
+        if ((end == p) || (first < 0) || (first >= MAX_CPUS))
+        {
+            return false;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            ++p;
+            last = strtol(p, &end, 10);
+            if ((end == p) || (last < first) || (last >= MAX_CPUS))
+            {
+                return false;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu)
+        {
+            addCpu((int)cpu);
+        }
+        if (*p == ',')
+        {
+            ++p;
+        }
+        else if ((*p != '\0') && (*p != '\n'))
+        {
+            return false;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+bool UMLRTThreadAttributes::parsePolicy ( const char * name )
+{
+    if (!strcasecmp(name, "fifo"))
+    {
+        policy = POLICY_FIFO;
+    }
+    else if (!strcasecmp(name, "rr"))
+    {
+        policy = POLICY_RR;
+    }
+    else if (!strcasecmp(name, "other") || !strcasecmp(name, "default"))
+    {
+        policy = POLICY_DEFAULT;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool UMLRTThreadAttributes::isDefined ( ) const
+{
+    return (numCpus > 0) || (policy != POLICY_DEFAULT) || (stackSize != 0) || (numaNode >= 0);
+}
+
+const char * UMLRTThreadAttributes::toString ( char * buffer, size_t size ) const
+{
+    static const char * policyNames[] = { "other", "fifo", "rr" };
+
+    int len = snprintf(buffer, size, "cpus(");
+    int firstInRange = -1;
+    bool first = true;
+    for (int cpu = 0; (cpu <= MAX_CPUS) && (len >= 0) && ((size_t)len < size); ++cpu)
+    {
+        if ((cpu < MAX_CPUS) && hasCpu(cpu))
+        {
+            if (firstInRange < 0)
+            {
+                firstInRange = cpu;
+            }
+        }
+        else if (firstInRange >= 0)
+        {
+            if (firstInRange == cpu - 1)
+            {
+                len += snprintf(buffer + len, size - len, "%s%d", first ? "" : ",", firstInRange);
+            }
+            else
+            {
+                len += snprintf(buffer + len, size - len, "%s%d-%d", first ? "" : ",", firstInRange, cpu - 1);
+            }
+            first = false;
+            firstInRange = -1;
+        }
+    }
+    if ((len >= 0) && ((size_t)len < size))
+    {
+        snprintf(buffer + len, size - len, "%s) policy(%s) priority(%d) stack(%lu) numa(%d)",
+                (numCpus == 0) ? "any" : "", policyNames[policy], priority, (unsigned long)stackSize, numaNode);
+    }
+    return buffer;
+}
@@ -9,13 +9,14 @@
  *******************************************************************************/
 
 // See umlrttimer.hh for documentation.
+#include <new>
 #include <stdlib.h>
 #include "basefatal.hh"
 #include "umlrttimerpool.hh"
 #include "umlrtguard.hh"
 
-UMLRTTimerPool::UMLRTTimerPool(UMLRTTimer timerElements[], size_t arraySize, size_t incrementSize) :
-        UMLRTPool(incrementSize)
+UMLRTTimerPool::UMLRTTimerPool(UMLRTTimer timerElements[], size_t arraySize, size_t incrementSize, size_t maxSize_) :
+        UMLRTPool(incrementSize, maxSize_)
 {
     UMLRTGuard g(mutex);
 
@@ -27,24 +28,34 @@ UMLRTTimerPool::UMLRTTimerPool(UMLRTTimer timerElements[], size_t arraySize, siz
             timerElements[i - 1].qid = qid++;
         }
         head = &timerElements[0];
+        size = arraySize;
     }
 }
 
-UMLRTTimerPool::UMLRTTimerPool(size_t incrementSize) :
-        UMLRTPool(incrementSize)
+UMLRTTimerPool::UMLRTTimerPool(size_t incrementSize, size_t maxSize_) :
+        UMLRTPool(incrementSize, maxSize_)
 {
 
 }
 
-void UMLRTTimerPool::grow()
+size_t UMLRTTimerPool::elementSize() const
 {
-    UMLRTTimer * newElements = new UMLRTTimer[increment]();
+    return sizeof(UMLRTTimer);
+}
+
+void UMLRTTimerPool::grow(void * region, size_t count)
+{
+    UMLRTTimer * newElements = (UMLRTTimer *)region;
 
-    for (size_t i = increment - 1; i > 0; --i)
+    for (size_t i = 0; i < count; ++i)
+    {
+        new (&newElements[i]) UMLRTTimer();
+    }
+    for (size_t i = count - 1; i > 0; --i)
     {
         newElements[i - 1].next = &newElements[i];
     }
-    newElements[increment - 1].next = head;
+    newElements[count - 1].next = head;
     head = &newElements[0];
 }
 
@@ -39,23 +39,25 @@
     }
     else
     {
-        UMLRTTimerQueue::timeAdjustLock();
         if (isRelative)
         {
+            // Relative timers run on the monotonic clock and are not affected by time adjustments.
             UMLRTTimespec now;
-            UMLRTTimespec::getclock(&now);
+            UMLRTTimespec::getmonotonic(&now);
             timer->due = now + due;
         }
         else
         {
             timer->due = due;
         }
-        UMLRTTimerQueue::timeAdjustUnlock();
+        timer->isClockTime = !isRelative;
         timer->isInterval = isInterval;
         if (isInterval)
         {
             timer->interval = due;
         }
+        timer->overrunPolicy = OVERRUN_CATCHUP;
+        timer->overruns = 0;
         timer->destPort = srcPort;
         timer->destSlot = srcPort->slot;
 
@@ -72,7 +74,7 @@
 
         BDEBUG(BD_TIMER, "allocate timer(%p) destPort(%s) isInterval(%d) priority(%d) payloadSize(%d) due(%s)\n",
                 timer, timer->destPort->getName(), timer->isInterval, timer->signal.getPriority(), timer->signal.getPayloadSize(),
-                timer->isInterval ? timer->due.toString(buf, sizeof(buf)) : timer->due.toString(buf, sizeof(buf)));
+                timer->isClockTime ? timer->due.toString(buf, sizeof(buf)) : timer->due.toStringRelative(buf, sizeof(buf)));
     }
     return UMLRTTimerId(timer);
 }
@@ -189,6 +191,38 @@ bool UMLRTTimerProtocol::OutSignals::cancelTimer( const UMLRTCommsPort * srcPort
     return srcPort->slot->controller->cancelTimer(id);
 }
 
+bool UMLRTTimerProtocol::OutSignals::setOverrunPolicy( const UMLRTCommsPort * srcPort, const UMLRTTimerId id, OverrunPolicy policy ) const
+{
+    if (!id.isValid() || !id.getTimer()->isInterval)
+    {
+        srcPort->slot->controller->setError(UMLRTController::E_TIMER_POLICY);
+        return false;
+    }
+    UMLRTTimer * timer = (UMLRTTimer *)id.getTimer();
+
+    if ((policy == OVERRUN_COALESCE) && (timer->signal.getType() != NULL))
+    {
+        // The overrun count would replace the user-defined data.
+        srcPort->slot->controller->setError(UMLRTController::E_TIMER_POLICY);
+        return false;
+    }
+    // The timer is only re-armed by the controller running this capsule - no locking is required.
+    timer->overrunPolicy = policy;
+
+    BDEBUG(BD_TIMER, "timer(%p) destPort(%s) overrun policy(%d)\n", timer, timer->destPort->getName(), policy);
+
+    return true;
+}
+
+unsigned int UMLRTTimerProtocol::OutSignals::getOverrunCount( const UMLRTCommsPort * srcPort, const UMLRTTimerId id ) const
+{
+    if (!id.isValid())
+    {
+        return 0;
+    }
+    return id.getTimer()->overruns;
+}
+
 void UMLRTTimerProtocol::OutSignals::timeAdjustStart( const UMLRTCommsPort * srcPort ) const
 {
     UMLRTTimerQueue::timeAdjustLock();
@@ -11,20 +11,24 @@
 #include "basefatal.hh"
 #include "basedebug.hh"
 #include "umlrtapi.hh"
+#include "umlrtclockcache.hh"
 #include "umlrtguard.hh"
 #include "umlrttimer.hh"
 #include "umlrttimerqueue.hh"
 #include "osnotify.hh"
 #include <stdlib.h>
 
-// Block time-sensitive operations during time adjustments.
+// Block clock-time timer operations during time adjustments.
 UMLRTMutex UMLRTTimerQueue::timeAdjustMutex;
 
+// Window within which timer expiries are batched into one wakeup.
+UMLRTTimespec UMLRTTimerQueue::slack(0, 0);
+
 // Map of all timer-queues used during time-adjustments.
 UMLRTHashMap * UMLRTTimerQueue::timerQueues;
 
 // See umlrttimerqueue.hh for documentation.
-UMLRTTimerQueue::UMLRTTimerQueue ( ) : notifyPtr(new UMLRTNotify())
+UMLRTTimerQueue::UMLRTTimerQueue ( ) : clockHead(NULL), clockTail(NULL), notifyPtr(new UMLRTNotify())
 {
     getTimerQueuesMap()->insert(this, this);
 }
@@ -44,6 +48,13 @@ UMLRTTimerQueue::~UMLRTTimerQueue ( )
     return timerQueues;
 }
 
+/*static*/ void UMLRTTimerQueue::setSlack ( const UMLRTTimespec & slack_ )
+{
+    char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
+    BDEBUG(BD_TIMER, "timer slack %s\n", slack_.toStringRelative(tmbuf, sizeof(tmbuf)));
+    slack = slack_;
+}
+
 /*static*/ void UMLRTTimerQueue::timeAdjustLock ( )
 {
     timeAdjustMutex.take();
@@ -76,134 +87,254 @@ void UMLRTTimerQueue::timeAdjustElements ( const UMLRTTimespec & delta )
 {
     UMLRTGuard g(getMutex());
 
-    UMLRTTimer * timer = (UMLRTTimer *)head;
-    while (timer != NULL)
+    // Relative and interval timers run on the monotonic clock and are unaffected by the adjustment.
+    // Clock-time timers are compared against the (now adjusted) wall-clock, so their due-times remain
+    // valid, but the controller has to re-evaluate how long to wait for the first of them.
+    if (clockHead != NULL)
     {
-        UMLRTTimespec was = timer->due;
-        timer->due -= delta;
-        char wasbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-        char nowbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-        BDEBUG(BD_TIMER, "timer adjust was %s now %s\n", was.toString(wasbuf, sizeof(wasbuf)), timer->due.toString(nowbuf, sizeof(nowbuf)));
-        timer = (UMLRTTimer *)timer->next;
+        BDEBUG(BD_TIMER, "this(%p) time adjust - clock-time timers running\n", this);
+        notifyPtr->sendNotification();
     }
 }
 
-// Remove the first timer on the queue. Returns NULL if first timer has not yet expired.
-UMLRTTimer * UMLRTTimerQueue::dequeue ( )
+/*static*/ bool UMLRTTimerQueue::insertSorted ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, const UMLRTTimer * timer )
 {
-    UMLRTGuard g(timeAdjustMutex, getMutex());
+    UMLRTTimer * next = (UMLRTTimer *)first;
+    UMLRTTimer * previous = NULL;
 
-    UMLRTTimer * first = (UMLRTTimer *)head;
+    timer->next = NULL; // Initialize as last-in-queue.
 
-    if (first)
+    // Skip ahead until we meet a timer due after this one.
+    while (next && (next->due <= timer->due))
+    {
+        previous = next;
+        next = (UMLRTTimer *)next->next;
+    }
+    if (!first)
+    {
+        // List was empty. Put it in there as only element.
+        first = last = timer;
+    }
+    else if (!next)
+    {
+        // We're appending this timer to the end of the list.
+        last->next = timer;
+        last = timer;
+    }
+    else if (!previous)
     {
-        UMLRTTimespec now;
-        UMLRTTimespec::getclock(&now);
+        // This timer is before the first element in the list - prepend it.
+        timer->next = first;
+        first = timer;
+    }
+    else
+    {
+        // This timer goes after 'previous' and before 'next'.
+        previous->next = timer;
+        timer->next = next;
+    }
+    return first == timer;
+}
+
+/*static*/ bool UMLRTTimerQueue::unlink ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, const UMLRTTimer * timer )
+{
+    const UMLRTQueueElement * next = first;
+    const UMLRTQueueElement * previous = NULL;
 
-        if (now >= first->due)
+    while (next && (next != timer))
+    {
+        previous = next;
+        next = next->next;
+    }
+    if (next)
+    {
+        if (!previous)
         {
-            // First timer is due - dequeue it and return it.
-            head = first->next;
-            if (!_count)
+            first = next->next;
+            if (first == NULL)
             {
-                FATAL("timer q(%p) dequeue found count zero first(%p) head(%p)\n", this, first, head);
+                last = NULL; // Not strictly required, but cleaner.
             }
-            --_count;
-            if (head == NULL)
+        }
+        else
+        {
+            // Unlink the timer by setting next of previous to be the timer's next.
+            previous->next = next->next;
+
+            // If the timer was last in the list, the tail has to be updated.
+            if (last == next)
             {
-                tail = NULL; // Not required, but cleaner.
+                last = previous;
             }
-            char firstbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-            char duebuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-            BDEBUG(BD_TIMER, "timer dequeue found now(%s) due(%s)\n", now.toString(firstbuf, sizeof(firstbuf)), first->due.toString(duebuf, sizeof(duebuf)));
         }
-        else
+    }
+    return next != NULL;
+}
+
+// Remove the first timer on the queue. Returns NULL if first timer has not yet expired.
+UMLRTTimer * UMLRTTimerQueue::dequeue ( )
+{
+    UMLRTClockCache now;
+
+    return dequeue(now);
+}
+
+UMLRTTimer * UMLRTTimerQueue::dequeue ( UMLRTClockCache & now )
+{
+    UMLRTTimer * first = NULL;
+    {
+        // Relative and interval timers - the time-adjustment lock is not required.
+        UMLRTGuard g(getMutex());
+
+        if (head != NULL)
         {
-            // First timer still running - leave it there.
-            first = NULL;
-            BDEBUG(BD_TIMER, "this(%p) dequeue found first timer still running.\n", this);
+            if (now.monotonic() >= ((UMLRTTimer *)head)->due)
+            {
+                // First timer is due - dequeue it and return it.
+                first = (UMLRTTimer *)head;
+                head = first->next;
+                if (head == NULL)
+                {
+                    tail = NULL; // Not required, but cleaner.
+                }
+                if (!_count)
+                {
+                    FATAL("timer q(%p) dequeue found count zero first(%p) head(%p)\n", this, first, head);
+                }
+                --_count;
+            }
         }
     }
-    else
+    // Clock-time timers are only examined when some are running. A clock-time timer that is added after
+    // this check notifies the controller if it becomes the first one due.
+    if ((first == NULL) && (clockHead != NULL))
+    {
+        UMLRTGuard g(timeAdjustMutex, getMutex());
+
+        if (clockHead != NULL)
+        {
+            if (now.clock() >= ((UMLRTTimer *)clockHead)->due)
+            {
+                first = (UMLRTTimer *)clockHead;
+                clockHead = first->next;
+                if (clockHead == NULL)
+                {
+                    clockTail = NULL; // Not required, but cleaner.
+                }
+                if (!_count)
+                {
+                    FATAL("timer q(%p) dequeue found count zero first(%p) clockHead(%p)\n", this, first, clockHead);
+                }
+                --_count;
+            }
+        }
+    }
+    if (first)
+    {
+        char duebuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
+        BDEBUG(BD_TIMER, "timer dequeue found due(%s) isClockTime(%d)\n",
+                first->isClockTime ? first->due.toString(duebuf, sizeof(duebuf)) : first->due.toStringRelative(duebuf, sizeof(duebuf)),
+                first->isClockTime);
+    }
+    else if (isEmpty())
     {
         BDEBUG(BD_TIMER, "this(%p) dequeue found no timers.\n", this);
     }
+    else
+    {
+        // First timer still running - leave it there.
+        BDEBUG(BD_TIMER, "this(%p) dequeue found first timer still running.\n", this);
+    }
     return first;
 }
 
 // Add a timer to the queue in the order of when they will expire.
 void UMLRTTimerQueue::enqueue ( const UMLRTTimer * timer )
 {
-    UMLRTGuard g(timeAdjustMutex, getMutex());
-
-    UMLRTTimer * next = (UMLRTTimer *)head;
-    UMLRTTimer * previous = NULL;
-
     char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
-    BDEBUG(BD_TIMER, "this(%p) timer-enqueue due(%s)\n", this, timer->due.toString(tmbuf,sizeof(tmbuf)));
-
-    timer->next = NULL; // Initialize as last-in-queue.
-
-    // Only need to notify the controller if the new timer ends up at the head of the queue.
-    // The wait mechanism is only interested in the time remaining for the timer at the head of the queue.
-    if (!head)
+    BDEBUG(BD_TIMER, "this(%p) timer-enqueue due(%s) isClockTime(%d)\n", this,
+            timer->isClockTime ? timer->due.toString(tmbuf, sizeof(tmbuf)) : timer->due.toStringRelative(tmbuf, sizeof(tmbuf)),
+            timer->isClockTime);
+
+    // Only need to notify the controller if the new timer ends up at the head of its list.
+    // The wait mechanism is only interested in the time remaining for the first timers due.
+    bool first;
+    if (timer->isClockTime)
     {
-        // List was empty. Put it in there as only element.
-        head = tail = timer;
-        _count = 1;
-        notifyPtr->sendNotification();
+        UMLRTGuard g(timeAdjustMutex, getMutex());
+
+        first = insertSorted(clockHead, clockTail, timer);
+        ++_count;
     }
     else
     {
-        // Skip ahead until we meet a timer due after this one.
-        while (next && (next->due <= timer->due))
-        {
-            previous = next;
-            next = (UMLRTTimer *)next->next;
-        }
-        if (!next)
-        {
-            // We're appending this timer to the end of the queue.
-            tail->next = timer;
-            tail = timer;
-            ++_count;
-        }
-        else if (!previous)
-        {
-            // This timer is before the first element in the queue - prepend it.
-            timer->next = head;
-            head = timer;
-            ++_count;
-            notifyPtr->sendNotification();
-        }
-        else
-        {
-            // This timer goes after 'previous' and before 'next'.
-            previous->next = timer;
-            timer->next = next;
-            ++_count;
-        }
+        UMLRTGuard g(getMutex());
+
+        first = insertSorted(head, tail, timer);
+        ++_count;
+    }
+    if (first)
+    {
+        notifyPtr->sendNotification();
     }
 }
 
-// Calculate how much time left before timer on the head of the queue is due.
+// Calculate how much time left before the first timer in the queue is due.
 UMLRTTimespec UMLRTTimerQueue::timeRemaining ( ) const
 {
-    UMLRTGuard g(timeAdjustMutex, getMutex());
+    UMLRTClockCache now;
+
+    return timeRemaining(now);
+}
 
+UMLRTTimespec UMLRTTimerQueue::timeRemaining ( UMLRTClockCache & now ) const
+{
     // NOTE: Intended only for the consumer of the queue elements which has confirmed
     // the queue was non-empty. An alternate implementation is required if an empty queue
     // is possible.
-    if (isEmpty())
+    UMLRTTimespec remain;
+    bool found = false;
     {
-        FATAL("timer queue was empty in timeRemaining()");
-    }
-    UMLRTTimespec now;
-    UMLRTTimespec::getclock(&now);
+        UMLRTGuard g(getMutex());
 
-    BDEBUG(BD_TIMER, "this(%p) head(%p) tail(%p)\n", this, head, tail);
+        if (head != NULL)
+        {
+            remain = ((UMLRTTimer *)head)->due - now.monotonic();
+            found = true;
 
-    UMLRTTimespec remain = ((UMLRTTimer*)head)->due - now;
+            if (!remain.isZeroOrNegative() && !slack.isZeroOrNegative())
+            {
+                // Wait for the last timer due within the slack window so they all expire in one wakeup.
+                UMLRTTimespec windowEnd = ((UMLRTTimer *)head)->due + slack;
+                const UMLRTTimer * timer = (const UMLRTTimer *)head->next;
+
+                while ((timer != NULL) && (timer->due <= windowEnd))
+                {
+                    remain = timer->due - now.monotonic();
+                    timer = (const UMLRTTimer *)timer->next;
+                }
+            }
+        }
+    }
+    if (clockHead != NULL)
+    {
+        UMLRTGuard g(timeAdjustMutex, getMutex());
+
+        if (clockHead != NULL)
+        {
+            UMLRTTimespec clockRemain = ((UMLRTTimer *)clockHead)->due - now.clock();
+            if (!found || (clockRemain < remain))
+            {
+                remain = clockRemain;
+            }
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        FATAL("timer queue was empty in timeRemaining()");
+    }
+    BDEBUG(BD_TIMER, "this(%p) head(%p) clockHead(%p)\n", this, head, clockHead);
 
     char tmbuf[UMLRTTimespec::TIMESPEC_TOSTRING_SZ];
     BDEBUG(BD_TIMER, "timeRemaining %s\n", remain.toStringRelative(tmbuf, sizeof(tmbuf)));
@@ -211,62 +342,97 @@ UMLRTTimespec UMLRTTimerQueue::timeRemaining ( ) const
     return remain;
 }
 
-// Add a timer to the queue in the order of when they will expire.
+// Cancel a timer (remove from the queue).
 bool UMLRTTimerQueue::cancel ( UMLRTTimerId id )
 {
     UMLRTGuard g(getMutex());
 
-    bool ok = false;
-    UMLRTTimer * next = (UMLRTTimer *)head;
-    UMLRTTimer * previous = NULL;
+    const UMLRTTimer * timer = id.getTimer();
 
-    while (next && (next != id.getTimer()))
+    // Only need to notify the controller if the cancelled timer was at the head of a list.
+    bool wasFirst = (timer == head) || (timer == clockHead);
+
+    if (!unlink(head, tail, timer) && !unlink(clockHead, clockTail, timer))
     {
-        previous = next;
-        next = (UMLRTTimer *)next->next;
+        return false;
     }
-    // Only need to notify the controller if the cancelled timer was at the head of the queue.
-    if (next)
+    if (!_count)
     {
-        // Found the one to delete.
-        if (!previous)
+        FATAL("timer q(%p) count(%d) cancel timer(%p)\n", this, _count, timer);
+    }
+    --_count;
+
+    if (wasFirst)
+    {
+        notifyPtr->sendNotification();
+    }
+    // Return it to the pool.
+    umlrt::TimerPutToPool((UMLRTTimer *)timer);
+
+    return true;
+}
+
+// Remove timers from both lists by visiting each and seeing if a callback function says the timer should be deleted.
+int UMLRTTimerQueue::remove ( match_compare_t compare, match_notify_t notify, void * userData, bool one )
+{
+    UMLRTGuard g(getMutex());
+
+    int count = removeFrom(head, tail, compare, notify, userData, one);
+
+    if (!one || !count)
+    {
+        count += removeFrom(clockHead, clockTail, compare, notify, userData, one);
+    }
+    return count;
+}
+
+int UMLRTTimerQueue::removeFrom ( const UMLRTQueueElement * & first, const UMLRTQueueElement * & last, match_compare_t compare, match_notify_t notify, void * userData, bool one )
+{
+    int count = 0;
+    const UMLRTQueueElement * previous = NULL;
+    const UMLRTQueueElement * candidate = first;
+
+    while (candidate != NULL)
+    {
+        // Remember the successor - 'notify' may re-use the element.
+        const UMLRTQueueElement * next = candidate->next;
+
+        if (compare(candidate, userData))
         {
-            // This timer was at the head of the queue.
-            head = (UMLRTTimer *)next->next;
-            if (!_count)
+            // Unlink candidate from the list.
+            if (previous == NULL)
             {
-                FATAL("timer q(%p) count(%d) cancel at head(%p)\n", this, _count, head);
+                first = next;
             }
-            --_count;
-            if (head == NULL)
+            else
             {
-                tail = NULL; // Not strictly required, but cleaner.
+                previous->next = next;
+            }
+            if (last == candidate)
+            {
+                last = previous;
             }
-            notifyPtr->sendNotification();
-        }
-        else
-        {
-            // Unlink the timer being deallocated by setting next of previous to be
-            // the cancelled timer's next.
-            previous->next = next->next;
             if (!_count)
             {
-                FATAL("timer q(%p) count(%d) cancel in middle timer(%p)\n", this, _count, next);
+                FATAL("timer q(%p) count already zero", this);
             }
             --_count;
 
-            // If the timer was last in the queue, the tail has to be updated.
-            if (tail == next)
+            // Notify caller that we've removed it.
+            notify(candidate, userData);
+            ++count;
+            if (one)
             {
-                tail = previous;
+                break;
             }
         }
-        // Return it to the pool.
-        umlrt::TimerPutToPool(next);
-
-        ok = true;
+        else
+        {
+            previous = candidate;
+        }
+        candidate = next;
     }
-    return ok;
+    return count;
 }
 
 int UMLRTTimerQueue::getNotifyFd ( )
@@ -23,8 +23,6 @@ UMLRTTimespec::UMLRTTimespec( long seconds, long nanoseconds ): tv_sec(seconds),
     timespecAdjust(this);
 }
 
-UMLRTTimespec::UMLRTTimespec() { UMLRTTimespec::getclock(this); }
-
 UMLRTTimespec & UMLRTTimespec::operator=( const UMLRTTimespec & tm )
 {
     tv_sec = tm.tv_sec;